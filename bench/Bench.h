@@ -0,0 +1,64 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+
+// Host microbenchmarks for the firmware's hot paths (pio run -e bench).
+//
+// Each benchmark body performs one operation; the runner repeats it until
+// the batch takes --min-time-ms and reports wall-clock ns/op plus heap
+// allocations/op and requested bytes/op (every malloc, realloc, calloc
+// and operator new, so String growth is included).
+//
+// Benchmarks that spend most of their allocations inside ArduinoJson are
+// registered with BENCHMARK_JSON: their counts follow the library build,
+// so a baseline comparison reports a change but does not fail on it.
+
+typedef void (*BenchFunction)();
+
+struct Benchmark {
+    const char* name;
+    BenchFunction run;
+    BenchFunction setup;        // once before timing, may be nullptr
+    bool libraryAllocs;         // allocation counts depend on ArduinoJson
+    Benchmark* next;
+};
+
+// Registered from static initializers, in link order
+class BenchRegistrar {
+public:
+    BenchRegistrar(const char* name, BenchFunction run, BenchFunction setup = nullptr,
+                   bool libraryAllocs = false);
+    static Benchmark* first();
+};
+
+#define BENCHMARK(name) \
+    static void bench_##name(); \
+    static BenchRegistrar benchRegistrar_##name(#name, bench_##name); \
+    static void bench_##name()
+
+#define BENCHMARK_WITH_SETUP(name, setup) \
+    static void bench_##name(); \
+    static BenchRegistrar benchRegistrar_##name(#name, bench_##name, setup); \
+    static void bench_##name()
+
+#define BENCHMARK_JSON(name, setup) \
+    static void bench_##name(); \
+    static BenchRegistrar benchRegistrar_##name(#name, bench_##name, setup, true); \
+    static void bench_##name()
+
+// Keeps the compiler from discarding a result
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Heap counters (BenchAlloc.cpp)
+struct BenchAllocCounters {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+BenchAllocCounters benchAllocCounters();
+
+#endif
@@ -0,0 +1,51 @@
+#include "Bench.h"
+#include <stdlib.h>
+
+// Counts every heap allocation in the process by interposing the C
+// allocator. operator new (MemoryMonitor.cpp) and Arduino String both end
+// up here. Only glibc exposes the __libc_* entry points; elsewhere the
+// counters stay at zero.
+
+static uint64_t allocationCount = 0;
+static uint64_t allocatedBytes = 0;
+
+BenchAllocCounters benchAllocCounters() {
+    BenchAllocCounters counters = {allocationCount, allocatedBytes};
+    return counters;
+}
+
+#ifdef __GLIBC__
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    allocationCount++;
+    allocatedBytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    // Growing a block counts as a new allocation of the full size
+    allocationCount++;
+    allocatedBytes += size;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+}
+
+#endif
@@ -0,0 +1,233 @@
+#include "Bench.h"
+#include <NativeHAL.h>
+#include <map>
+#include <string>
+#include "StorageManager.h"
+#include "DisplayManager.h"
+#include "NFCModule.h"
+#include "IRModule.h"
+#include "RFModule.h"
+
+// Benchmark runner.
+//
+//   program [--filter SUBSTR] [--min-time-ms N] [--sd DIR]
+//           [--baseline FILE [--tolerance PCT]] [--save-baseline FILE]
+//
+// With --baseline, every benchmark is compared against the recorded
+// figures and the exit status is 1 if any of them regressed: ns/op by more
+// than the tolerance (default 25%), or any increase in allocations/op or
+// bytes/op, which are deterministic. ns/op figures are only comparable on
+// the machine that recorded the baseline. Allocation changes in
+// BENCHMARK_JSON benchmarks are reported but not counted: they follow the
+// ArduinoJson build rather than the firmware.
+
+#define BENCH_DEFAULT_MIN_TIME_MS  200
+#define BENCH_DEFAULT_TOLERANCE    25.0
+#define BENCH_BATCHES              5
+#define BENCH_DEFAULT_SD_ROOT      ".bench_sd"
+
+struct BenchResult {
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+static Benchmark* benchmarks = nullptr;
+static Benchmark** benchmarksTail = &benchmarks;
+
+BenchRegistrar::BenchRegistrar(const char* name, BenchFunction run, BenchFunction setup,
+                               bool libraryAllocs) {
+    Benchmark* benchmark = new Benchmark{name, run, setup, libraryAllocs, nullptr};
+    *benchmarksTail = benchmark;
+    benchmarksTail = &benchmark->next;
+}
+
+Benchmark* BenchRegistrar::first() {
+    return benchmarks;
+}
+
+static uint64_t runBatch(Benchmark* benchmark, uint64_t iterations) {
+    uint64_t start = nativeHAL.hostNanos();
+    for (uint64_t i = 0; i < iterations; i++) {
+        benchmark->run();
+    }
+    return nativeHAL.hostNanos() - start;
+}
+
+static BenchResult measure(Benchmark* benchmark, uint64_t minTimeNs) {
+    if (benchmark->setup) benchmark->setup();
+    
+    // Warm up, then grow the batch until it takes a tenth of the budget
+    runBatch(benchmark, 10);
+    uint64_t iterations = 1;
+    uint64_t elapsed = runBatch(benchmark, iterations);
+    while (elapsed < minTimeNs / 10 && iterations < (1ULL << 30)) {
+        iterations *= 2;
+        elapsed = runBatch(benchmark, iterations);
+    }
+    if (elapsed > 0 && elapsed < minTimeNs / BENCH_BATCHES) {
+        iterations = iterations * (minTimeNs / BENCH_BATCHES) / elapsed;
+    }
+    
+    // Allocation counts are exact, so one batch is enough for them
+    BenchAllocCounters before = benchAllocCounters();
+    uint64_t best = runBatch(benchmark, iterations);
+    BenchAllocCounters after = benchAllocCounters();
+    
+    // Best of several batches filters out scheduler noise
+    for (int i = 1; i < BENCH_BATCHES; i++) {
+        uint64_t batch = runBatch(benchmark, iterations);
+        if (batch < best) best = batch;
+    }
+    
+    BenchResult result;
+    result.nsPerOp = (double)best / iterations;
+    result.allocsPerOp = (double)(after.allocations - before.allocations) / iterations;
+    result.bytesPerOp = (double)(after.bytes - before.bytes) / iterations;
+    return result;
+}
+
+static bool loadBaseline(const char* path, std::map<std::string, BenchResult>& baseline) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "bench: cannot read %s\n", path);
+        return false;
+    }
+    
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char name[128];
+        BenchResult result;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%127s %lf %lf %lf", name, &result.nsPerOp,
+                   &result.allocsPerOp, &result.bytesPerOp) == 4) {
+            baseline[name] = result;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+#define BASELINE_COLUMNS "# name ns_per_op allocs_per_op bytes_per_op\n"
+
+// The comment block at the top of an existing baseline survives a refresh
+static std::string readBaselineHeader(const char* path) {
+    std::string header;
+    FILE* file = fopen(path, "r");
+    if (!file) return header;
+    
+    char line[256];
+    while (fgets(line, sizeof(line), file) && line[0] == '#') {
+        if (strcmp(line, BASELINE_COLUMNS) != 0) header += line;
+    }
+    fclose(file);
+    return header;
+}
+
+static bool saveBaseline(const char* path, const std::map<std::string, BenchResult>& results) {
+    std::string header = readBaselineHeader(path);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return false;
+    }
+    
+    fputs(header.c_str(), file);
+    fputs(BASELINE_COLUMNS, file);
+    for (const auto& entry : results) {
+        fprintf(file, "%s %.1f %.2f %.1f\n", entry.first.c_str(), entry.second.nsPerOp,
+                entry.second.allocsPerOp, entry.second.bytesPerOp);
+    }
+    fclose(file);
+    return true;
+}
+
+// Module state every benchmark relies on
+static void initFirmware() {
+    storageManager.init();
+    displayManager.init();
+    nfcModule.init();
+    irModule.init();
+    rfModule.init();
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* baselinePath = nullptr;
+    const char* savePath = nullptr;
+    uint64_t minTimeMs = BENCH_DEFAULT_MIN_TIME_MS;
+    double tolerance = BENCH_DEFAULT_TOLERANCE;
+    
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && hasValue) {
+            minTimeMs = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--save-baseline") == 0 && hasValue) {
+            savePath = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            tolerance = atof(argv[++i]);
+        }
+    }
+    
+    std::map<std::string, BenchResult> baseline;
+    if (baselinePath && !loadBaseline(baselinePath, baseline)) {
+        return 1;
+    }
+    
+    nativeHAL.setSDRoot(BENCH_DEFAULT_SD_ROOT);
+    nativeHAL.setSerialEcho(false);
+    nativeHAL.begin(argc, argv);
+    initFirmware();
+    
+    printf("%-28s %12s %11s %11s  %s\n", "benchmark", "ns/op", "allocs/op", "bytes/op",
+           baselinePath ? "vs baseline" : "");
+    
+    std::map<std::string, BenchResult> results;
+    int regressions = 0;
+    for (Benchmark* benchmark = BenchRegistrar::first(); benchmark; benchmark = benchmark->next) {
+        if (filter && !strstr(benchmark->name, filter)) continue;
+        
+        BenchResult result = measure(benchmark, minTimeMs * 1000000ULL);
+        results[benchmark->name] = result;
+        printf("%-28s %12.1f %11.2f %11.1f", benchmark->name, result.nsPerOp,
+               result.allocsPerOp, result.bytesPerOp);
+        
+        if (baselinePath) {
+            auto entry = baseline.find(benchmark->name);
+            if (entry == baseline.end()) {
+                printf("  (no baseline)");
+            } else {
+                const BenchResult& base = entry->second;
+                double change = base.nsPerOp > 0 ? (result.nsPerOp / base.nsPerOp - 1.0) * 100.0 : 0.0;
+                bool slower = change > tolerance;
+                bool moreAllocs = result.allocsPerOp > base.allocsPerOp + 0.005;
+                bool moreBytes = result.bytesPerOp > base.bytesPerOp + 0.5;
+                printf("  %+6.1f%%", change);
+                if (benchmark->libraryAllocs && (moreAllocs || moreBytes)) {
+                    printf("  (ArduinoJson allocs changed)");
+                    moreAllocs = moreBytes = false;
+                }
+                if (slower || moreAllocs || moreBytes) {
+                    printf("  REGRESSION%s%s%s", slower ? " time" : "",
+                           moreAllocs ? " allocs" : "", moreBytes ? " bytes" : "");
+                    regressions++;
+                }
+            }
+        }
+        printf("\n");
+    }
+    
+    if (savePath && !saveBaseline(savePath, results)) {
+        return 1;
+    }
+    
+    if (baselinePath) {
+        printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+    }
+    nativeHAL.end();
+    return regressions ? 1 : 0;
+}
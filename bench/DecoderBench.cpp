@@ -0,0 +1,173 @@
+#include "Bench.h"
+#include "ModuleBench.h"
+
+// IR and RF decoders on fixed captures
+
+static uint16_t necFrame[68];
+static uint16_t necStretchedFrame[68];
+static uint16_t sonyFrame[26];
+static uint16_t rc5Frame[28];
+static uint16_t rawFrame[24];
+static uint32_t askBurst[64];
+static uint32_t manchesterBurst[64];
+static uint32_t carrierTicks[IR_CARRIER_MAX_EDGES];
+static uint8_t carrierLevels[IR_CARRIER_MAX_EDGES];
+
+static IRDecoder irDecoder;
+static IRDecodeResult irResult;
+static uint16_t rc5Length;
+
+static IRSignal irSignal;
+static RFSignal rfSignal;
+static IRCarrierEstimate carrierEstimate;
+
+static void buildNECFrame() {
+    // Address 0x00ff, command 0x0045, as IRModule::transmitNEC sends it
+    uint32_t bits = 0x00ff | (0x0045UL << 16);
+    necFrame[0] = 9000;
+    necFrame[1] = 4500;
+    for (int i = 0; i < 32; i++) {
+        necFrame[2 + i * 2] = 560;
+        necFrame[3 + i * 2] = (bits >> i) & 1 ? 1690 : 560;
+    }
+    necFrame[66] = 560;
+    necFrame[67] = 40000;   // gap before the next frame
+}
+
+static void buildStretchedNECFrame() {
+    // The same frame through a slow receiver from a remote whose clock runs
+    // 5 % long: marks 150 us longer, spaces as much shorter. Only decodes
+    // with the timing taken from the leader.
+    for (int i = 0; i < 67; i++) {
+        uint32_t scaled = necFrame[i] * 105UL / 100;
+        necStretchedFrame[i] = i % 2 == 0 ? scaled + 150 : scaled - 150;
+    }
+    necStretchedFrame[67] = necFrame[67];
+}
+
+static void buildSonyFrame() {
+    // Sony12, device 1, command 0x15 (volume up)
+    uint32_t bits = 0x15 | (1UL << 7);
+    sonyFrame[0] = 2400;
+    sonyFrame[1] = 600;
+    for (int i = 0; i < 12; i++) {
+        sonyFrame[2 + i * 2] = (bits >> i) & 1 ? 1200 : 600;
+        sonyFrame[3 + i * 2] = 600;
+    }
+    sonyFrame[25] = 25000;
+}
+
+static void buildRC5Frame() {
+    // Start bits 11, toggle 0, address 0, command 0x0c, MSB first; a one is
+    // space then mark, and the leading space is lost in the idle line
+    uint16_t bits = 0x3000 | 0x0c;
+    uint8_t halves[28];
+    for (int i = 0; i < 14; i++) {
+        bool one = (bits >> (13 - i)) & 1;
+        halves[i * 2] = one ? 0 : 1;
+        halves[i * 2 + 1] = one ? 1 : 0;
+    }
+    
+    // Merge runs of equal half-bits into durations, starting with the first
+    // mark; durations at even indexes are marks
+    rc5Length = 0;
+    for (int i = 1; i < 28; i++) {
+        if (rc5Length > 0 && (rc5Length - 1) % 2 == 1 - halves[i]) {
+            rc5Frame[rc5Length - 1] += 889;
+        } else {
+            rc5Frame[rc5Length++] = 889;
+        }
+    }
+    if (rc5Length % 2 == 1) {
+        rc5Frame[rc5Length++] = 0;
+    }
+    rc5Frame[rc5Length - 1] += 25000;
+}
+
+static void setupDecoder() {
+    buildNECFrame();
+    buildStretchedNECFrame();
+    buildSonyFrame();
+    buildRC5Frame();
+}
+
+static void setupNEC() {
+    buildNECFrame();
+    ModuleBench::loadIRCapture(necFrame, 68);
+}
+
+static void setupIRRaw() {
+    // Matches no protocol, so the whole chain runs and falls back to raw
+    for (int i = 0; i < 24; i++) {
+        rawFrame[i] = i % 3 ? 600 : 1200;
+    }
+    ModuleBench::loadIRCapture(rawFrame, 24);
+}
+
+static void setupCarrier() {
+    // 38 kHz at 33 % duty on the 80 MHz capture clock, split into 560 us
+    // bursts as in an NEC frame
+    uint32_t period = 80000000UL / 38000;
+    uint32_t tick = 0;
+    for (int i = 0; i < IR_CARRIER_MAX_EDGES; i += 2) {
+        if (i > 0 && i % 42 == 0) tick += 560 * 80;
+        carrierTicks[i] = tick;
+        carrierLevels[i] = HIGH;
+        carrierTicks[i + 1] = tick + period / 3;
+        carrierLevels[i + 1] = LOW;
+        tick += period + (i % 6) - 2;
+    }
+}
+
+static void setupASK() {
+    for (int i = 0; i < 64; i++) {
+        askBurst[i] = i % 4 == 0 ? 1200 : 300;
+    }
+    ModuleBench::loadRFCapture(askBurst, 64);
+}
+
+static void setupManchester() {
+    for (int i = 0; i < 64; i += 2) {
+        bool one = (i / 2) % 3 == 0;
+        manchesterBurst[i] = one ? 800 : 400;
+        manchesterBurst[i + 1] = one ? 400 : 800;
+    }
+    ModuleBench::loadRFCapture(manchesterBurst, 64);
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_nec, setupDecoder) {
+    benchKeep(irDecoder.decode(necFrame, 68, &irResult));
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_nec_stretched, setupDecoder) {
+    benchKeep(irDecoder.decode(necStretchedFrame, 68, &irResult));
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_sony, setupDecoder) {
+    benchKeep(irDecoder.decode(sonyFrame, 26, &irResult));
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_rc5, setupDecoder) {
+    benchKeep(irDecoder.decode(rc5Frame, rc5Length, &irResult));
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_signal_nec, setupNEC) {
+    benchKeep(irModule.decodeSignal(&irSignal));
+}
+
+BENCHMARK_WITH_SETUP(ir_decode_signal_raw, setupIRRaw) {
+    benchKeep(irModule.decodeSignal(&irSignal));
+}
+
+BENCHMARK_WITH_SETUP(ir_carrier_estimate, setupCarrier) {
+    benchKeep(IRCarrierMeter::estimate(carrierTicks, carrierLevels, IR_CARRIER_MAX_EDGES, 80000000UL,
+                                       &carrierEstimate));
+}
+
+BENCHMARK_WITH_SETUP(rf_decode_ask, setupASK) {
+    benchKeep(ModuleBench::decodeASK(&rfSignal));
+}
+
+BENCHMARK_WITH_SETUP(rf_decode_manchester, setupManchester) {
+    benchKeep(ModuleBench::decodeManchester(&rfSignal));
+}
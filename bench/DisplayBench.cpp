@@ -0,0 +1,22 @@
+#include "Bench.h"
+#include "DisplayManager.h"
+#include "menu.h"
+
+// Frame buffer rendering (no flush)
+
+static const char* menuItems[MENU_COUNT];
+
+static void setupMenu() {
+    for (int i = 0; i < MENU_COUNT; i++) {
+        menuItems[i] = mainMenu[i].name;
+    }
+}
+
+BENCHMARK_WITH_SETUP(display_draw_menu, setupMenu) {
+    displayManager.clear();
+    displayManager.drawMenu(menuItems, MENU_COUNT, 3);
+}
+
+BENCHMARK(display_draw_status_bar) {
+    displayManager.drawStatusBar();
+}
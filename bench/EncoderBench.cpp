@@ -0,0 +1,33 @@
+#include "Bench.h"
+#include "IRWaveform.h"
+#include "IRTransmitter.h"
+
+// IR waveform compiler: protocol encoding and RMT item packing
+
+static IRWaveform waveform;
+static uint32_t rmtItems[IR_TX_MAX_ITEMS];
+static uint16_t rawFrame[200];
+
+static void setupRaw() {
+    for (int i = 0; i < 200; i++) {
+        rawFrame[i] = i % 3 ? 600 : 1200;
+    }
+}
+
+BENCHMARK(ir_encode_nec) {
+    benchKeep(waveform.encodeNEC(0x00ff, 0x0045));
+}
+
+BENCHMARK(ir_encode_rc6) {
+    const IRProtocolTiming* timing = irFindTiming(IR_RC6);
+    benchKeep(waveform.encode(*timing, irComposeData(*timing, 0x1A, 0xFE, true)));
+}
+
+BENCHMARK_WITH_SETUP(ir_encode_raw, setupRaw) {
+    benchKeep(waveform.encodeRaw(rawFrame, 200, 38000));
+}
+
+BENCHMARK(ir_pack_rmt_nec) {
+    waveform.encodeNEC(0x00ff, 0x0045);
+    benchKeep(waveform.toRMTItems(rmtItems, IR_TX_MAX_ITEMS));
+}
@@ -0,0 +1,48 @@
+#include "Bench.h"
+#include "IRFingerprint.h"
+
+// Raw capture fingerprints: computing one and searching a full index
+
+static uint16_t capture[300];
+static IRFingerprint captureFingerprint;
+static IRFingerprintIndex benchIndex;
+static uint32_t seed;
+
+static uint16_t jittered(uint16_t nominal) {
+    seed = seed * 1103515245 + 12345;
+    return nominal + (int)((seed >> 16) % 61) - 30;
+}
+
+// NEC-like frame of an unknown protocol: one pattern per button
+static void buildCapture(uint16_t* durations, uint16_t count, uint32_t button) {
+    durations[0] = jittered(9000);
+    durations[1] = jittered(4500);
+    for (uint16_t i = 2; i < count - 1; i++) {
+        bool one = (button >> (i / 2 % 32)) & 1;
+        durations[i] = jittered(i % 2 == 0 ? 560 : (one ? 1690 : 560));
+    }
+    durations[count - 1] = 40000;
+}
+
+static void setupIndex() {
+    // Without the SD file: entries go straight into RAM
+    seed = 1;
+    for (int i = 0; i < IR_FINGERPRINT_MAX_ENTRIES; i++) {
+        IRFingerprint fingerprint;
+        buildCapture(capture, 300, 0x9E3779B9u * (uint32_t)(i + 1));
+        IRFingerprintIndex::compute(capture, 300, &fingerprint);
+        benchIndex.add(fingerprint, "button_" + String(i));
+    }
+    buildCapture(capture, 300, 0x9E3779B9u * (uint32_t)IR_FINGERPRINT_MAX_ENTRIES);
+    IRFingerprintIndex::compute(capture, 300, &captureFingerprint);
+}
+
+BENCHMARK_WITH_SETUP(ir_fingerprint_compute, setupIndex) {
+    IRFingerprint fingerprint;
+    IRFingerprintIndex::compute(capture, 300, &fingerprint);
+    benchKeep(fingerprint.shape[0]);
+}
+
+BENCHMARK_WITH_SETUP(ir_fingerprint_find, setupIndex) {
+    benchKeep(benchIndex.find(captureFingerprint));
+}
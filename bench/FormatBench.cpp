@@ -0,0 +1,40 @@
+#include "Bench.h"
+#include "IRFormat.h"
+
+// Binary .ir files: encoding and decoding a full-length raw capture
+
+static uint16_t rawFrame[300];
+static uint8_t fileBuffer[IR_FORMAT_BUFFER_SIZE];
+static size_t fileSize;
+static IRSignal rawSignal;
+static IRSignal loadedSignal;
+
+static void setupRaw() {
+    // NEC-like marks and spaces with +-30 us of receiver jitter
+    uint32_t seed = 12345;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        int jitter = (int)((seed >> 16) % 61) - 30;
+        int nominal = i % 2 == 0 ? 560 : ((seed >> 8) & 1 ? 1690 : 560);
+        rawFrame[i] = nominal + jitter;
+    }
+    rawSignal.protocol = IR_RAW;
+    rawSignal.setName("RAW_1234");
+    rawSignal.frequency = 38000;
+    rawSignal.setRaw(rawFrame, 300);
+
+    IRFormatWriter writer(fileBuffer, sizeof(fileBuffer));
+    writer.add(&rawSignal);
+    fileSize = writer.finish();
+}
+
+BENCHMARK_WITH_SETUP(ir_format_write_raw, setupRaw) {
+    IRFormatWriter writer(fileBuffer, sizeof(fileBuffer));
+    writer.add(&rawSignal);
+    benchKeep(writer.finish());
+}
+
+BENCHMARK_WITH_SETUP(ir_format_read_raw, setupRaw) {
+    IRFormatReader reader(fileBuffer, fileSize);
+    benchKeep(reader.next(&loadedSignal));
+}
@@ -0,0 +1,25 @@
+#ifndef MODULEBENCH_H
+#define MODULEBENCH_H
+
+#include "IRModule.h"
+#include "RFModule.h"
+
+// Access to module internals for the benchmarks (a friend of IRModule and
+// RFModule): load a capture buffer and call single decoders
+class ModuleBench {
+public:
+    static void loadIRCapture(const uint16_t* durations, uint16_t count) {
+        memcpy(irModule.rawBuffer, durations, count * sizeof(uint16_t));
+        irModule.rawIndex = count;
+    }
+    
+    static void loadRFCapture(const uint32_t* durations, size_t count) {
+        memcpy(rfModule.rawBuffer, durations, count * sizeof(uint32_t));
+        rfModule.rawIndex = count;
+    }
+    
+    static bool decodeASK(RFSignal* signal) { return rfModule.decodeASK(signal); }
+    static bool decodeManchester(RFSignal* signal) { return rfModule.decodeManchester(signal); }
+};
+
+#endif
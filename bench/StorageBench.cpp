@@ -0,0 +1,98 @@
+#include "Bench.h"
+#include "StorageManager.h"
+#include "NFCModule.h"
+#include "IRLibrary.h"
+
+// SD card paths: JSON files, NFC hex dumps, directory scans and IR remote
+// libraries. The SD card is a host directory (--sd, default .bench_sd).
+
+#define BENCH_SCAN_DIR   "/bench_scan"
+#define BENCH_SCAN_FILES 32
+
+#define BENCH_REMOTE_BUTTONS 32   // as many buttons as the scan has files
+
+static NFCCard card;
+static IRSignal remoteButtons[BENCH_REMOTE_BUTTONS];
+static IRSignal loadedButton;
+static IRLibrary remoteLibrary;
+static JsonDocument document;
+static String cardPath;
+
+static void setupCard() {
+    card.uid = "04A1B2C3D4E5F6";
+    card.type = NFC_MIFARE_CLASSIC;
+    card.name = "Bench card";
+    card.timestamp = 123456;
+    card.dataSize = 1024;
+    for (size_t i = 0; i < card.dataSize; i++) {
+        card.data[i] = (uint8_t)(i * 37);
+    }
+    nfcModule.saveCard(&card);
+    cardPath = NFC_DIR + String("/") + card.uid + NFC_EXT;
+}
+
+static void setupDocument() {
+    document.clear();
+    document["name"] = "NEC_0x45";
+    document["protocol"] = 1;
+    document["address"] = 0x00ff;
+    document["command"] = 0x45;
+    document["frequency"] = 38000;
+    document["timestamp"] = 123456;
+    storageManager.writeJsonFile("/bench/document.json", document);
+}
+
+static void setupScan() {
+    storageManager.createDirectory(BENCH_SCAN_DIR);
+    for (int i = 0; i < BENCH_SCAN_FILES; i++) {
+        storageManager.writeFile(BENCH_SCAN_DIR "/signal_" + String(i) + IR_EXT, "{}");
+    }
+}
+
+static void setupRemote() {
+    for (int i = 0; i < BENCH_REMOTE_BUTTONS; i++) {
+        remoteButtons[i].protocol = IR_NEC;
+        remoteButtons[i].setName("button_" + String(i));
+        remoteButtons[i].address = 0x00ff;
+        remoteButtons[i].command = i;
+        remoteButtons[i].frequency = 38000;
+    }
+    String path = IRLibrary::remotePath("bench_tv");
+    IRLibrary::write(path, remoteButtons, BENCH_REMOTE_BUTTONS);
+    remoteLibrary.open(path);
+}
+
+BENCHMARK_JSON(nfc_save_card, setupCard) {
+    benchKeep(nfcModule.saveCard(&card));
+}
+
+BENCHMARK_JSON(nfc_load_card, setupCard) {
+    benchKeep(nfcModule.loadCard(cardPath, &card));
+}
+
+BENCHMARK_JSON(storage_write_json, setupDocument) {
+    benchKeep(storageManager.writeJsonFile("/bench/document.json", document));
+}
+
+BENCHMARK_JSON(storage_read_json, setupDocument) {
+    JsonDocument loaded;
+    benchKeep(storageManager.readJsonFile("/bench/document.json", loaded));
+}
+
+BENCHMARK_WITH_SETUP(storage_get_file_name, setupScan) {
+    // Last entry: a full directory walk
+    benchKeep(storageManager.getFileName(BENCH_SCAN_DIR, BENCH_SCAN_FILES - 1));
+}
+
+BENCHMARK_WITH_SETUP(storage_get_file_count, setupScan) {
+    benchKeep(storageManager.getFileCount(BENCH_SCAN_DIR));
+}
+
+BENCHMARK_WITH_SETUP(ir_library_find_button, setupRemote) {
+    // Last button: the whole index
+    benchKeep(remoteLibrary.findButton("button_" + String(BENCH_REMOTE_BUTTONS - 1)));
+}
+
+BENCHMARK_WITH_SETUP(ir_library_load_button, setupRemote) {
+    benchKeep(remoteLibrary.loadButton(BENCH_REMOTE_BUTTONS - 1, &loadedButton));
+}
@@ -17,6 +17,9 @@
 #define MENU_AREA_Y (STATUS_BAR_HEIGHT + 2)
 #define MENU_AREA_HEIGHT (SCREEN_HEIGHT - STATUS_BAR_HEIGHT - 2)
 
+// Boot animation: growing logo, full logo, then the name
+#define BOOT_ANIMATION_FRAMES 7
+
 class DisplayManager {
 public:
     DisplayManager();
@@ -29,15 +32,21 @@ public:
     void drawWiFiStatus(bool connected);
     void drawSDStatus(bool inserted);
     
+    // Panel power; display() is skipped while the panel is off
+    void setPower(bool on);
+    bool isPoweredOn() { return poweredOn; }
+    
     // Menu display functions
     void drawMenu(const char* items[], int count, int selected);
     void drawSubmenu(const char* title, const char* items[], int count, int selected);
     void drawModuleScreen(const char* title, const char* content);
     void drawProgressBar(int percentage);
+    void drawHistogram(int x, int y, int width, int height,
+                       const uint16_t* up, const uint16_t* down, int bins);
     void drawScrollText(const char* text, int x, int y, int maxWidth);
     
-    // Boot animation
-    void showBootAnimation();
+    // Boot animation; false once frame is past the last one
+    bool drawBootFrame(int frame);
     void drawLogo();
     
     // Utility functions
@@ -47,11 +56,12 @@ public:
     void drawScrollbar(int totalItems, int visibleItems, int scrollPosition);
     
     // Get display instance
-    Adafruit_SSD1306* getDisplay() { return &display; }
+    Adafruit_SSD1306* getDisplay() { return &oled; }
 
 private:
-    Adafruit_SSD1306 display;
+    Adafruit_SSD1306 oled;
     bool displayInitialized;
+    bool poweredOn;
     unsigned long lastUpdate;
     
     void drawBatteryIcon(int x, int y, int percentage);
@@ -0,0 +1,75 @@
+#ifndef EDGERING_H
+#define EDGERING_H
+
+#include <Arduino.h>
+
+// Lock-free single-producer / single-consumer ring of pin edges: a 32-bit
+// micros() timestamp and the level the pin changed to. The producer is a
+// pin interrupt, the consumer the module's update() on the capture core;
+// each side only writes its own index, so neither ever blocks or masks
+// interrupts.
+//
+// Timestamps are absolute, so the consumer can measure any interval
+// (including gaps longer than 16 bits) and split frames after the fact,
+// however late it drains the ring. When the ring is full the new edge is
+// dropped and counted.
+//
+// Size must be a power of two, at most 32768.
+
+struct Edge {
+    uint32_t timestamp;   // micros() at the edge
+    uint8_t level;        // pin level after the edge
+};
+
+template <uint16_t Size>
+class EdgeRing {
+    static_assert(Size >= 2 && Size <= 32768 && (Size & (Size - 1)) == 0, "EdgeRing size must be a power of two");
+
+public:
+    EdgeRing() : head(0), tail(0), overflows(0) {}
+
+    // Producer (interrupt)
+    bool IRAM_ATTR push(uint32_t timestamp, uint8_t level) {
+        uint16_t h = head;
+        if ((uint16_t)(h - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) >= Size) {
+            overflows++;
+            return false;
+        }
+        timestamps[h & (Size - 1)] = timestamp;
+        levels[h & (Size - 1)] = level;
+        __atomic_store_n(&head, (uint16_t)(h + 1), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumer
+    bool pop(Edge* edge) {
+        uint16_t t = tail;
+        if (t == __atomic_load_n(&head, __ATOMIC_ACQUIRE)) return false;
+        edge->timestamp = timestamps[t & (Size - 1)];
+        edge->level = levels[t & (Size - 1)];
+        __atomic_store_n(&tail, (uint16_t)(t + 1), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumer: drops everything queued so far
+    void clear() {
+        __atomic_store_n(&tail, __atomic_load_n(&head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    }
+
+    uint16_t available() {
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE) - tail;
+    }
+    bool isEmpty() { return available() == 0; }
+    uint16_t capacity() { return Size; }
+    uint32_t getOverflows() { return overflows; }
+
+private:
+    // Free-running indexes; only their difference is ever used
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint32_t overflows;
+    uint32_t timestamps[Size];
+    uint8_t levels[Size];
+};
+
+#endif
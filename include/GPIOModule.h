@@ -3,12 +3,16 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "Module.h"
 
 // GPIO pin definitions (configurable pins)
 #define GPIO_START_PIN 14
 #define GPIO_END_PIN   39
 #define MAX_GPIO_PINS  (GPIO_END_PIN - GPIO_START_PIN + 1)
 
+// Analog refresh / change detection poll
+#define GPIO_POLL_INTERVAL_MS 10
+
 // GPIO modes
 enum GPIOMode {
     GPIO_MODE_INPUT = 0,
@@ -41,11 +45,11 @@ struct GPIOScenario {
     unsigned long timestamp;
 };
 
-class GPIOModule {
+class GPIOModule : public Module {
 public:
     GPIOModule();
-    bool init();
-    void update();
+    bool init() override;
+    void update() override;
     
     // Pin configuration
     bool configurePin(uint8_t pin, GPIOMode mode, const String& name = "");
@@ -0,0 +1,73 @@
+#ifndef IRANALYZER_H
+#define IRANALYZER_H
+
+#include <Arduino.h>
+#include "IRDecoder.h"
+
+// Live statistics for the IR analyzer screen, built on the capture core
+// from the durations as they are drained from the edge ring and read by
+// the UI core while the screen is up.
+//
+// The histogram has IR_ANALYZER_BINS columns per level, four per octave
+// from IR_ANALYZER_MIN_US, so 128 us to 32 ms fits the screen width with
+// every common timing in a column of its own. Counts are halved when a
+// frame starts: the bars follow the remote being pointed, and an old
+// outlier fades within a few frames.
+//
+// Decoded frames report the protocol row and its bit count. Frames no
+// protocol claims get a guess at their encoding from which level carries
+// the data: varying spaces mean pulse distance, varying marks pulse width,
+// both (at one and two half-bits) biphase.
+//
+// The writer (capture core) publishes through a sequence counter: odd
+// while it writes, so read() retries instead of copying a torn state.
+
+#define IR_ANALYZER_BINS        32
+#define IR_ANALYZER_MIN_US      128
+#define IR_ANALYZER_REFRESH_MS  100    // screen redraws at most this often
+
+struct IRAnalysis {
+    uint16_t marks[IR_ANALYZER_BINS];
+    uint16_t spaces[IR_ANALYZER_BINS];
+    uint32_t frames;            // since the analyzer started
+    uint32_t carrierHz;         // 0 without the carrier sensor
+    uint8_t dutyPercent;
+    const char* protocol;       // of the last frame: a row name or an encoding guess
+    uint8_t bits;               // data bits of the last frame, 0 when unknown
+    bool repeat;                // the last frame was a repeat code
+    uint16_t durations;         // marks and spaces in the last frame
+};
+
+class IRAnalyzer {
+public:
+    IRAnalyzer();
+
+    // Starts over; not while the capture core is feeding it
+    void reset();
+
+    // Capture core, in frame order
+    void beginFrame();
+    void addDuration(uint32_t us, bool mark);
+    void frameDecoded(const IRDecodeResult& result, uint16_t durations);
+    void frameRaw(const uint16_t* durations, uint16_t count);
+    void setCarrier(uint32_t hz, uint8_t dutyPercent);
+
+    // Any core: a consistent copy, and a counter that moves with every change
+    void read(IRAnalysis* out);
+    uint32_t getSequence() { return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE); }
+
+    static uint8_t binOf(uint32_t us);
+
+    // Encoding of an undecoded frame (the last duration is the gap) and
+    // its data bits, 0 when they cannot be told
+    static const char* guessEncoding(const uint16_t* durations, uint16_t count, uint8_t* bits);
+
+private:
+    IRAnalysis state;
+    uint32_t sequence;
+
+    void beginWrite();
+    void endWrite();
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef IRCARRIER_H
+#define IRCARRIER_H
+
+#include <Arduino.h>
+
+#ifndef NATIVE_HAL
+#include <driver/mcpwm.h>
+#endif
+
+// Carrier measurement. The receiver on IR_RECEIVER_PIN demodulates, so
+// the carrier never reaches it; a second, non-demodulating sensor (a
+// photodiode and comparator, or a TSMP58000-class receiver) on
+// IR_CARRIER_PIN shows the raw pulses. The MCPWM capture unit timestamps
+// both of its edges with the 80 MHz APB clock, and the first
+// IR_CARRIER_MAX_EDGES edges after arm() are kept: about 3.4 ms of a
+// 38 kHz carrier, well inside the first mark of any protocol.
+//
+// Statistics: the periods between consecutive active edges are taken,
+// the ones outside IR_CARRIER_MIN_HZ..IR_CARRIER_MAX_HZ (spaces between
+// marks, glitches) dropped, and the rest reduced to their median. The
+// frequency is the mean of the periods within 1/8 of that median, the
+// duty cycle their mean active time over their mean length.
+//
+// The sensor is optional and only used when the irCarrierSensor setting
+// says it is fitted; otherwise begin() is never called, measure() fails
+// and signals keep the protocol's nominal carrier. The pin is pulled to
+// the inactive level so an unpowered sensor reads as no carrier, and an
+// estimate outside IR_CARRIER_MIN_HZ..IR_CARRIER_MAX_HZ or
+// IR_CARRIER_MIN_DUTY..IR_CARRIER_MAX_DUTY is rejected as noise. The
+// native build timestamps the edges with micros() from a pin interrupt.
+
+#define IR_CARRIER_PIN           2
+#define IR_CARRIER_ACTIVE_LEVEL  HIGH   // sensor output while the LED is lit
+#define IR_CARRIER_MAX_EDGES     256
+#define IR_CARRIER_MIN_PERIODS   16     // fewer and there is no estimate
+#define IR_CARRIER_MIN_HZ        20000
+#define IR_CARRIER_MAX_HZ        60000  // IRSignal::frequency is 16 bits
+#define IR_CARRIER_MIN_DUTY      10     // percent
+#define IR_CARRIER_MAX_DUTY      75
+
+#ifdef NATIVE_HAL
+#define IR_CARRIER_TICK_HZ       1000000UL
+#else
+#define IR_CARRIER_TICK_HZ       80000000UL
+#endif
+
+struct IRCarrierEstimate {
+    uint32_t frequency;     // Hz
+    uint8_t dutyPercent;
+    uint16_t periods;       // carrier periods the estimate rests on
+};
+
+class IRCarrierMeter {
+public:
+    IRCarrierMeter();
+    bool begin(uint8_t pin);
+
+    // Capture on while receiving; arm() starts keeping edges for a frame
+    void start();
+    void stop();
+    void arm();
+
+    // From the edges kept since arm(); false when there were too few
+    bool measure(IRCarrierEstimate* estimate);
+
+    // The statistics alone: edge timestamps in ticks of tickHz and the
+    // level after each edge
+    static bool estimate(const uint32_t* ticks, const uint8_t* levels, uint16_t count,
+                         uint32_t tickHz, IRCarrierEstimate* estimate);
+
+private:
+    uint8_t carrierPin;
+    bool started;
+    bool capturing;
+
+    // Filled by the capture interrupt up to IR_CARRIER_MAX_EDGES
+    uint32_t ticks[IR_CARRIER_MAX_EDGES];
+    uint8_t levels[IR_CARRIER_MAX_EDGES];
+    volatile uint16_t count;
+    volatile bool armed;
+
+    void IRAM_ATTR record(uint32_t tick, uint8_t level);
+
+#ifdef NATIVE_HAL
+    static void pinChanged();
+#else
+    static bool IRAM_ATTR captured(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel,
+                                   const cap_event_data_t* event, void* arg);
+#endif
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef IRDECODER_H
+#define IRDECODER_H
+
+#include <stdint.h>
+#include "IRProtocols.h"
+
+// Table-driven IR decoder. Every row of irProtocols gets a small state
+// machine, and each duration advances all rows that still fit in a
+// single pass. A row drops out at its first duration outside the
+// tolerance window. Most rows are gone after the header mark, so the
+// cost per duration stays flat as rows are added.
+//
+// Durations alternate mark, space, mark... starting with a mark. A row
+// is complete once its last bit (or stop mark) is in. It is reported as
+// soon as no other row can still extend the frame; a row that is still
+// complete when the line goes quiet also wins. When two rows finish
+// together, the one earlier in the table wins.
+//
+// Adaptive timing: receivers stretch marks and shorten spaces by the same
+// amount, and a remote's clock can run a few percent off. Both show in the
+// leader, so once a row has matched its header mark and space, the rest of
+// the frame is measured against it: the leader's length relative to the
+// nominal one gives the row its clock scale, and how much longer its mark
+// is than that share gives the stretch (at most the row's tolerance of its
+// shortest mark). Later durations are corrected for both before the
+// tolerance window is applied, so the window sits on this remote's timing
+// instead of the nominal one. Rows without a header are unaffected.
+//
+// No hardware access: the same code decodes live captures, saved raw
+// signals and the benchmark frames.
+
+#define IR_MAX_CANDIDATES 32   // one bit per table row in the candidate masks
+#define IR_SCALE_SHIFT    12   // fixed point of the leader clock scale
+
+struct IRDecodeResult {
+    const IRProtocolTiming* timing;  // matched row
+    IRProtocol protocol;
+    uint32_t data;                   // all bits, first on the air in bit 0 (MSB for IR_MSB_FIRST rows)
+    uint8_t bits;
+    uint32_t address;
+    uint32_t command;
+    bool repeat;                     // a repeat code rather than a frame
+};
+
+class IRDecoder {
+public:
+    IRDecoder();
+
+    // Streaming: forget any partial frame
+    void reset();
+
+    // Streaming: one duration; true when a frame has been recognised
+    // (getResult()). The decoder is then ready for the next frame.
+    bool feed(uint32_t duration, bool mark);
+
+    // Streaming: the line has been quiet for quietUs so far (the space in
+    // progress); true when that already rules out every row but a complete
+    // one, so the frame can be reported before its trailing gap ends
+    bool settle(uint32_t quietUs);
+
+    // Streaming: how long after the last edge settle() can succeed; 0 while
+    // no row is complete
+    uint32_t getSettleTime();
+
+    // Streaming: the line has gone quiet; true when a complete row wins
+    bool finish();
+
+    const IRDecodeResult& getResult() { return result; }
+
+    // One pass over a captured frame (marks at even indexes)
+    bool decode(const uint16_t* durations, uint16_t count, IRDecodeResult* out);
+
+    // Correct durations from the leader (on by default)
+    void setAdaptive(bool enabled) { adaptive = enabled; }
+    bool isAdaptive() { return adaptive; }
+
+private:
+    enum Phase {
+        PHASE_HEADER_MARK = 0,
+        PHASE_HEADER_SPACE,
+        PHASE_BIT_MARK,
+        PHASE_BIT_SPACE,
+        PHASE_STOP_MARK,
+        PHASE_REPEAT_STOP,
+        PHASE_DONE
+    };
+
+    struct Candidate {
+        uint8_t phase;
+        uint8_t bitCount;
+        uint8_t halves;      // biphase: half-bits held for the current bit (0 or 1)
+        uint8_t firstHalf;   // biphase: level of the held half-bit
+        bool repeat;
+        uint32_t data;
+        uint16_t scale;      // nominal per measured time; 0 before the leader
+        int16_t stretch;     // after scaling, marks are this much longer and spaces shorter
+    };
+
+    Candidate candidates[IR_PROTOCOL_TABLE_SIZE];
+    uint32_t aliveMask;
+    uint32_t doneMask;
+    bool started;            // a mark has been seen since reset()
+    uint32_t leaderMark;     // the first mark, a header for the rows that have one
+    bool adaptive;
+    IRDecodeResult result;
+
+    bool step(const IRProtocolTiming& timing, Candidate& c, uint32_t duration, bool mark);
+    bool stepBiphase(const IRProtocolTiming& timing, Candidate& c, uint32_t duration, bool mark);
+    bool addBit(const IRProtocolTiming& timing, Candidate& c, uint8_t bit);
+    bool complete(const IRProtocolTiming& timing, Candidate& c);
+    bool emit(int index);
+    void learnLeader(const IRProtocolTiming& timing, Candidate& c, uint32_t space, uint32_t nominalSpace);
+    static uint32_t correct(const Candidate& c, uint32_t duration, bool mark);
+
+    static bool matches(uint32_t measured, uint32_t expected, uint8_t tolerance);
+    static uint32_t longestSpace(const IRProtocolTiming& timing);
+    static bool isGap(const IRProtocolTiming& timing, uint32_t space);
+};
+
+#endif
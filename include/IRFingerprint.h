@@ -0,0 +1,87 @@
+#ifndef IRFINGERPRINT_H
+#define IRFINGERPRINT_H
+
+#include <Arduino.h>
+
+// Fingerprints of raw IR captures, to recognise a signal no protocol
+// decodes ("Living room TV power") without loading every saved file.
+//
+// A fingerprint is the number of durations, a histogram of mark and space
+// lengths (coarse bins, each half scaled to sum to about 255) and a shape:
+// one bit per duration, set when it is long for its level (half again
+// the usual short mark, or space, of the capture). The histogram
+// tells remotes and protocols apart; the shape, which is what a pulse
+// distance or biphase code actually carries, tells buttons of one remote
+// apart. Receiver jitter moves a few bins and rarely a shape bit.
+//
+// The index lives in RAM (searched in a few microseconds) and is
+// mirrored in IR_FINGERPRINT_FILE: fixed-size entries appended as signals
+// are saved and read back at boot. Deleting a signal, or booting without
+// a usable file, rebuilds it from the saved signals (IRModule), so entries
+// never outlive their files and older saves are picked up.
+
+#define IR_FINGERPRINT_BINS          12   // per level; bin edges in IRFingerprint.cpp
+#define IR_FINGERPRINT_LABEL_SIZE    24   // NUL included
+#define IR_FINGERPRINT_MAX_ENTRIES   256
+#define IR_FINGERPRINT_SHAPE_BITS    128  // durations covered by the shape
+#define IR_FINGERPRINT_MAX_HAMMING   1    // shape bits that may differ in a match
+#define IR_FINGERPRINT_MAX_DISTANCE  96   // histogram L1 distance allowed in a match (of 1020)
+#define IR_FINGERPRINT_FILE          SETTINGS_DIR "/ir_fingerprints.idx"   // kept out of IR_DIR's signal listing
+#define IR_FINGERPRINT_VERSION       1
+
+struct IRFingerprint {
+    uint16_t length;                                    // durations, the trailing gap excluded
+    uint8_t histogram[IR_FINGERPRINT_BINS * 2];         // marks, then spaces
+    uint8_t shape[IR_FINGERPRINT_SHAPE_BITS / 8];       // bit i: duration i is long
+};
+
+class IRFingerprintIndex {
+public:
+    IRFingerprintIndex();
+
+    // durations alternate mark/space starting with a mark; the last one is
+    // taken to be the gap after the frame and ignored
+    static void compute(const uint16_t* durations, uint16_t count, IRFingerprint* fingerprint);
+    static uint16_t distance(const IRFingerprint& a, const IRFingerprint& b);
+
+    // Boot: reads the index file (capture core, before capture starts).
+    // False when there is none or it can't be used: rebuild it.
+    bool load();
+
+    // Saving a signal (UI task): adds to RAM and, if persist, appends to
+    // the file. A label already present with an identical fingerprint is
+    // not added twice.
+    bool add(const IRFingerprint& fingerprint, const String& label, bool persist = true);
+
+    // Rebuilding (UI task): clear(), add() every saved signal without
+    // persisting, then save() rewrites the file
+    void clear();
+    bool save();
+
+    // Best entry within the match limits, or -1; its label is copied into
+    // label (IR_FINGERPRINT_LABEL_SIZE bytes) when given. Safe against a
+    // concurrent add(), as entries are published before the count; a
+    // search overlapping a clear() finds nothing.
+    int find(const IRFingerprint& fingerprint, char* label = nullptr);
+    const char* getLabel(int index);
+    int getCount() { return __atomic_load_n(&count, __ATOMIC_ACQUIRE); }
+
+private:
+    struct Entry {
+        IRFingerprint fingerprint;
+        char label[IR_FINGERPRINT_LABEL_SIZE];
+    };
+
+    Entry entries[IR_FINGERPRINT_MAX_ENTRIES];
+    uint16_t count;
+    uint32_t generation;     // bumped by clear(), before entries are reused
+
+    static void writeHeader(uint8_t* header);
+
+    static void serialize(const Entry& entry, uint8_t* out);
+    static void deserialize(const uint8_t* in, Entry* entry);
+};
+
+extern IRFingerprintIndex irFingerprints;
+
+#endif
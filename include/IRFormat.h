@@ -0,0 +1,94 @@
+#ifndef IRFORMAT_H
+#define IRFORMAT_H
+
+#include <Arduino.h>
+#include "IRModule.h"
+
+// Binary .ir files: a header and one or more signal records, all in a
+// single buffer so a file is read or written in one go and loading needs
+// no parsing beyond varints.
+//
+//   header   'I' 'R' 'b' version  quantum(us)  reserved  count(u16 LE)
+//   record   protocol  flags  name length+bytes  address  command
+//            frequency  [duty]  [bits]  timestamp  [raw length  raw durations]
+//
+// Numbers are unsigned LEB128 varints. Raw durations are counted in
+// quantum steps and stored as zigzag deltas from the previous duration of
+// the same level (mark or space). A duration within IR_FORMAT_SNAP_PERCENT
+// of that previous one is stored as equal, so the repeated marks and
+// spaces of a capture mostly cost one byte. Both losses stay far inside
+// the decoder's tolerance.
+//
+// Address and command are the decoder's fields for the protocol: NEC
+// holds 8-bit ones, NECext a 16-bit address and 8-bit command, NECraw the
+// two 16-bit halves as sent.
+//
+// Version 1. Readers reject other versions; new fields go behind a new
+// version number or a flags bit.
+
+#define IR_FORMAT_VERSION        1
+#define IR_FORMAT_HEADER_SIZE    8
+#define IR_FORMAT_QUANTUM_US     8
+#define IR_FORMAT_SNAP_PERCENT   5
+#define IR_FORMAT_MAX_NAME       63
+#define IR_FORMAT_FLAG_RAW       0x01
+#define IR_FORMAT_FLAG_DUTY      0x02   // a measured carrier duty byte follows the frequency
+#define IR_FORMAT_FLAG_BITS      0x04   // a frame length byte follows (Sony 15/20)
+
+// Fits one 300-duration raw capture; bundles of decoded signals run to
+// about 20 bytes a signal
+#define IR_FORMAT_BUFFER_SIZE    1024
+
+class IRFormatWriter {
+public:
+    IRFormatWriter(uint8_t* buffer, size_t capacity, uint8_t quantumUs = IR_FORMAT_QUANTUM_US);
+
+    // False (and the writer unusable) once the buffer is full
+    bool add(const IRSignal* signal);
+
+    // Patches the signal count into the header; the encoded size, 0 if
+    // anything did not fit
+    size_t finish();
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+    uint8_t quantumUs;
+    uint16_t count;
+    bool overflow;
+
+    void putByte(uint8_t value);
+    void putVarint(uint32_t value);
+};
+
+class IRFormatReader {
+public:
+    IRFormatReader(const uint8_t* buffer, size_t size);
+
+    // Header present, version known
+    bool isValid() { return valid; }
+    uint16_t getCount() { return count; }
+
+    // The next signal, raw durations into the signal's own storage. False
+    // at the end, on a damaged record or when the pool has no room for a
+    // long capture.
+    bool next(IRSignal* signal);
+
+    // Starts with the binary magic (anything else may be a JSON file)
+    static bool isBinary(const uint8_t* buffer, size_t size);
+
+private:
+    const uint8_t* buffer;
+    size_t size;
+    size_t position;
+    uint8_t quantumUs;
+    uint16_t count;
+    uint16_t remaining;
+    bool valid;
+
+    bool getByte(uint8_t* value);
+    bool getVarint(uint32_t* value);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef IRGLITCHFILTER_H
+#define IRGLITCHFILTER_H
+
+#include <Arduino.h>
+#include "EdgeRing.h"
+
+// Spike filter between the edge ring and the frame builder. Fluorescent
+// lighting and cheap receivers add pulses far shorter than any protocol
+// uses: a blip of mark inside a space, or a dropout inside a mark. Either
+// is two edges closer together than the minimum pulse, so both are dropped
+// and the durations on either side merge back into one. The same holds for
+// a lone spike on the idle line, which then never opens a frame.
+//
+// Each edge is held until the next one is known to be at least the
+// minimum pulse away: either it arrives, or the line stays quiet that
+// long (release()). The frame builder therefore runs at most one minimum
+// pulse behind the pin. A minimum pulse of 0 passes every edge through.
+
+#define IR_GLITCH_MIN_PULSE_US  120   // default; the shortest protocol pulse (RC6 half-bit) is 444 us
+#define IR_GLITCH_MAX_PULSE_US  400
+
+class IRGlitchFilter {
+public:
+    IRGlitchFilter();
+
+    void setMinPulse(uint16_t us);
+    uint16_t getMinPulse() { return minPulseUs; }
+
+    // Forget a held edge (receiver restarted)
+    void reset();
+
+    // An edge from the ring; true when an earlier edge has become final
+    // and is in *out
+    bool push(const Edge& edge, Edge* out);
+
+    // No edge has followed the held one up to nowUs; true when it has now
+    // stood for the minimum pulse and is in *out
+    bool release(uint32_t nowUs, Edge* out);
+
+    bool isHolding() { return holding; }
+    uint32_t getReleaseTime() { return held.timestamp + minPulseUs; }
+    uint32_t getGlitches() { return glitches; }
+
+private:
+    Edge held;
+    bool holding;
+    uint16_t minPulseUs;
+    uint32_t glitches;       // spikes dropped since boot
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef IRLIBRARY_H
+#define IRLIBRARY_H
+
+#include <Arduino.h>
+#include "IRModule.h"
+#include "IRFormat.h"
+
+// Remote library: every button of one remote in a single file under
+// IR_REMOTE_DIR, with a fixed-size index up front so a button list or a
+// single button costs one small seek-and-read instead of a directory scan
+// and a parse of the whole remote.
+//
+//   header  'I' 'R' 'l' version  count(u16 LE)  reserved(2)
+//   index   count entries of IR_LIBRARY_ENTRY_SIZE bytes:
+//           name (NUL padded)  offset(u32 LE)  length(u16 LE)  protocol  reserved
+//   data    one single-signal IRFormat blob per button, at its offset
+//
+// Files are written whole; adding a button rewrites the remote.
+
+#define IR_LIBRARY_VERSION      1
+#define IR_LIBRARY_HEADER_SIZE  8
+#define IR_LIBRARY_NAME_SIZE    24   // button name, NUL included
+#define IR_LIBRARY_ENTRY_SIZE   32
+#define IR_LIBRARY_MAX_BUTTONS  256
+#define IR_LIBRARY_INDEX_CHUNK  8    // entries per SD read while searching
+
+class IRLibrary {
+public:
+    IRLibrary();
+
+    // Reads the header only
+    bool open(const String& path);
+    void close();
+    bool isOpen() { return opened; }
+    const String& getPath() { return path; }
+
+    int getButtonCount() { return count; }
+    bool getButtonName(int index, String& name);
+    IRProtocol getButtonProtocol(int index);
+
+    // Index scan by name; -1 when missing
+    int findButton(const String& name);
+
+    // Seeks straight to the button's signal, as IRFormatReader::next
+    bool loadButton(int index, IRSignal* signal);
+
+    // Writes a remote; each button is saved under its signal name
+    static bool write(const String& path, const IRSignal* buttons, int count);
+
+    // IR_REMOTE_DIR/<remote>.irl
+    static String remotePath(const String& remote);
+
+private:
+    String path;
+    uint16_t count;
+    bool opened;
+
+    bool readEntry(int index, uint8_t* entry);
+    static size_t encodeButton(const IRSignal* button, uint8_t* buffer, size_t capacity);
+};
+
+#endif
@@ -3,104 +3,252 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "Module.h"
+#include "IRTransmitter.h"
+#include "EdgeRing.h"
+#include "IRProtocols.h"
+#include "IRDecoder.h"
+#include "IRCarrier.h"
+#include "IRGlitchFilter.h"
+#include "IRSignal.h"
+#include "IRAnalyzer.h"
+#include "Scheduler.h"
 
 // IR pin definitions
 #define IR_RECEIVER_PIN 7
 #define IR_LED_PIN      8
 
-// IR protocols
-enum IRProtocol {
-    IR_UNKNOWN = 0,
-    IR_NEC,
-    IR_SONY,
-    IR_RC5,
-    IR_RC6,
-    IR_SAMSUNG,
-    IR_LG,
-    IR_RAW
-};
+// Capture: the pin interrupt queues every edge in a ring and update()
+// drops spikes (IRGlitchFilter.h) and splits the edges into frames
+// wherever the line stays idle for the frame gap. Reception is continuous,
+// so back-to-back presses are all kept.
+// Each edge is also fed to the decoder as it is drained, so a frame is
+// reported as soon as its last bit is in; only frames no protocol claims
+// wait for the gap and are kept raw.
+#define IR_EDGE_RING_SIZE     512       // edges; about seven NEC frames
+#define IR_FRAME_GAP_US       15000UL   // default; longer than any space inside a frame
+#define IR_MAX_FRAME_GAP_US   65000UL   // durations are stored in 16 bits
+#define IR_DRAIN_INTERVAL_US  100000UL  // idle receiver: drain the ring at least this often
+
+// History: a repeat code, or a frame identical to the newest entry, that
+// arrives within this long of that entry's last frame is counted in it
+// instead of taking a slot (a held button)
+#define IR_COALESCE_WINDOW_US 250000UL  // NEC repeats come every 108 ms, Sony every 45 ms
+#define IR_RAW_MATCH_PERCENT  25        // raw frames are identical when every duration is this close
+
+// Batch transmit (universal remote): every button of a remote library is
+// sent back to back, each frame started from the TX-end interrupt of the
+// one before plus a gap, so the UI keeps running between frames
+#define IR_BATCH_GAP_US       150000UL  // default; lets the target tell one code from the next
+#define IR_UNIVERSAL_REMOTE   "universal"  // library behind the menu's Universal Remote
 
-// IR signal structure
-struct IRSignal {
-    IRProtocol protocol;
-    String name;
-    uint32_t command;
-    uint32_t address;
-    uint16_t* rawData;
-    uint16_t rawLength;
-    uint16_t frequency;
-    unsigned long timestamp;
+// Frames folded into one history entry
+struct IRHistoryStats {
+    uint16_t frames;            // full frames, the first included
+    uint16_t repeats;           // repeat codes
+    unsigned long lastSeen;     // millis() of the latest frame or repeat
+    uint32_t lastSeenUs;        // micros() of the same, for the intervals
+    uint32_t minIntervalUs;     // between consecutive frames/repeats
+    uint32_t maxIntervalUs;
+    uint64_t totalIntervalUs;   // mean = total / (frames + repeats - 1)
 };
 
-class IRModule {
+class IRModule : public Module {
 public:
     IRModule();
-    bool init();
-    void update();
+    bool init() override;
+    void update() override;
+    void onEvent(const ModuleEvent& event) override;
+    int getProgress(int actionId) override;
     
     // Receiving functions
     bool receiveSignal();
+    void stopReceiving();
     bool decodeSignal(IRSignal* signal);
     String getProtocolString(IRProtocol protocol);
     
-    // Transmitting functions
-    bool transmitSignal(const IRSignal* signal);
-    bool transmitNEC(uint32_t address, uint32_t command);
-    bool transmitSony(uint32_t data, int nbits);
-    bool transmitRaw(uint16_t* data, uint16_t length, uint16_t frequency);
+    // Transmitting functions: the frame goes to the RMT and these return at
+    // once (false while a frame is still on the air); done runs when it has
+    // been sent, in interrupt context on the device. transmitSignal() uses
+    // the signal's own carrier and duty cycle when it has them.
+    bool transmitSignal(const IRSignal* signal, IRTransmitCallback done = nullptr, void* arg = nullptr);
+    bool transmitNEC(uint32_t address, uint32_t command,
+                     IRTransmitCallback done = nullptr, void* arg = nullptr);
+    bool transmitSony(uint32_t data, int nbits,
+                      IRTransmitCallback done = nullptr, void* arg = nullptr);
+    bool transmitRaw(const uint16_t* data, uint16_t length, uint16_t frequency,
+                     IRTransmitCallback done = nullptr, void* arg = nullptr);
+    
+    // Batch transmit (UI task): queues every button of a remote library.
+    // The job set with setBatchNotify runs updateBatch(), which loads and
+    // sends one button per frame; a button that cannot be sent is skipped.
+    bool startBatch(const String& remote, uint32_t gapUs = IR_BATCH_GAP_US);
+    void cancelBatch();
+    void updateBatch();
+    bool isBatchRunning() { return batchRunning; }
+    int getBatchSent() { return batchNext; }
+    int getBatchTotal() { return batchTotal; }
+    int getBatchFailed() { return batchFailed; }
+    unsigned long getBatchDeadline();
+    void setBatchNotify(Scheduler* scheduler, int job);
     
-    // Data management
+    // Analyzer screen: while it is up every frame received also feeds the
+    // analysis (IRAnalyzer.h); the job set with setAnalyzerNotify is
+    // started with it to redraw the screen
+    bool isAnalyzing() { return analyzing; }
+    void readAnalysis(IRAnalysis* out) { analyzer.read(out); }
+    uint32_t getAnalysisSequence() { return analyzer.getSequence(); }
+    void setAnalyzerNotify(Scheduler* scheduler, int job);
+    
+    // Data management: binary .ir files (IRFormat.h), one signal or a
+    // bundle; loading also takes the older JSON files. Saved raw signals
+    // are fingerprinted (IRFingerprint.h) so later captures of the same
+    // button are named after them.
     bool saveSignal(const IRSignal* signal);
     bool loadSignal(const String& filename, IRSignal* signal);
+    bool saveSignals(const String& filename, const IRSignal* signals, int count);
+    int loadSignals(const String& filename, IRSignal* signals, int maxCount);
+    
+    // JSON import/export
+    bool exportSignalJson(const IRSignal* signal, const String& filename);
+    bool importSignalJson(const String& filename, IRSignal* signal);
+    
+    // Remote libraries (IRLibrary.h): all buttons of one remote in a file
+    bool saveRemote(const String& remote, const IRSignal* buttons, int count);
+    int getRemoteCount();
+    String getRemoteFilename(int index);
     void deleteSignal(const String& filename);
     int getSignalCount();
     String getSignalFilename(int index);
     
+    // Re-fingerprints every saved signal and rewrites the index file: after
+    // a delete, or at boot when there is no usable index (UI task, or the
+    // boot load before capture starts)
+    void rebuildFingerprints();
+    
     // History management
     void addToHistory(const IRSignal* signal);
     void clearHistory();
     int getHistoryCount();
     IRSignal getHistoryItem(int index);
+    IRHistoryStats getHistoryStats(int index);
+    // Capture core only: the UI sends CAPTURE_CMD_IR_DUMP_HISTORY
+    void dumpHistory(Print& out);
     
     // Status
     bool isReceiving();
     bool isTransmitting();
+    bool hasReceivedSignal() { return signalReceived; }
+    uint32_t getFrameCount() { return frameCount; }
+    uint32_t getDroppedEdges() { return edgeRing.getOverflows(); }
+    unsigned long getNextDeadline();
+    
+    // Job to notify from the pin interrupt so edges are decoded as they land
+    void setEdgeNotify(Scheduler* scheduler, int job);
+    
+    // Idle time that ends a frame
+    void setFrameGap(uint32_t gapUs);
+    uint32_t getFrameGap() { return frameGapUs; }
+    
+    // Noise handling before decoding: pulses shorter than minPulseUs are
+    // dropped (0 turns the filter off), and with adaptive timing each
+    // protocol's windows follow the frame's own leader (IRDecoder.h).
+    // Capture core only: the UI sends CAPTURE_CMD_IR_GLITCH_FILTER/ADAPTIVE.
+    void setGlitchFilter(uint16_t minPulseUs) { glitchFilter.setMinPulse(minPulseUs); }
+    uint16_t getGlitchFilter() { return glitchFilter.getMinPulse(); }
+    uint32_t getGlitches() { return glitchFilter.getGlitches(); }
+    void setAdaptiveTiming(bool enabled) { decoder.setAdaptive(enabled); }
+    bool getAdaptiveTiming() { return decoder.isAdaptive(); }
+    
+    // A raw sensor is fitted on IR_CARRIER_PIN (settings); read by init()
+    void setCarrierSensor(bool fitted) { carrierSensor = fitted; }
     bool isInitialized() { return irInitialized; }
 
 private:
+    // Host microbenchmarks (bench/) drive the decoders directly
+    friend class ModuleBench;
+    
     bool irInitialized;
     IRSignal currentSignal;
     bool signalReceived;
     bool isReceivingSignal;
-    bool isTransmittingSignal;
     unsigned long lastReceiveTime;
     
-    // Raw data buffer
-    static const int MAX_RAW_LENGTH = 300;
+    // Frame being compiled for the transmitter, and the toggle bit of
+    // the last RC5/RC6 press sent
+    IRWaveform txWaveform;
+    bool txToggle;
+    
+    // Batch transmit; batchSentUs and batchInFlight are set from the
+    // TX-end interrupt
+    bool batchRunning;
+    uint16_t batchNext;          // buttons taken from the library so far
+    uint16_t batchTotal;
+    uint16_t batchFailed;
+    uint32_t batchGapUs;
+    volatile uint32_t batchSentUs;
+    volatile bool batchInFlight;
+    Scheduler* batchScheduler;
+    int batchJob;
+    
+    // Analyzer screen; analyzing is set from the UI task
+    IRAnalyzer analyzer;
+    volatile bool analyzing;
+    Scheduler* analyzerScheduler;
+    int analyzerJob;
+    
+    // Edges from the pin interrupt
+    EdgeRing<IR_EDGE_RING_SIZE> edgeRing;
+    IRGlitchFilter glitchFilter;
+    volatile uint8_t lastLevel;
+    Scheduler* edgeScheduler;
+    int edgeJob;
+    
+    // Frame being assembled: mark/space durations, first entry a mark, the
+    // last one the gap that ended the frame
+    static const int MAX_RAW_LENGTH = IR_SIGNAL_MAX_RAW;
     uint16_t rawBuffer[MAX_RAW_LENGTH];
-    volatile uint16_t rawIndex;
-    volatile unsigned long lastEdgeTime;
+    uint16_t rawIndex;
+    bool frameOpen;
+    bool frameDecoded;       // the decoder has reported something in this frame
+    uint32_t lastEdgeTime;
+    uint8_t lastEdgeLevel;
+    uint32_t frameGapUs;
+    uint32_t frameCount;
+    uint64_t decodeNanos;    // host decode time of the current frame (native stats)
     
     // History storage
     static const int MAX_HISTORY = 50;
     IRSignal history[MAX_HISTORY];
+    IRHistoryStats historyStats[MAX_HISTORY];
     int historyCount;
     int historyIndex;
     
-    // Protocol decoders
-    bool decodeNEC(IRSignal* signal);
-    bool decodeSony(IRSignal* signal);
-    bool decodeRC5(IRSignal* signal);
-    bool decodeRC6(IRSignal* signal);
-    bool decodeSamsung(IRSignal* signal);
-    bool decodeLG(IRSignal* signal);
+    // Protocol decoder (all rows of irProtocols in one pass)
+    IRDecoder decoder;
+    
+    // Carrier of the current frame, from the raw sensor when fitted
+    bool carrierSensor;
+    IRCarrierMeter carrierMeter;
     
     // Helper functions
     void startReceiving();
-    void stopReceiving();
-    void captureRawData();
-    String generateSignalName(IRProtocol protocol, uint32_t command);
+    void captureEdge();
+    void addEdge(const Edge& edge);
+    void finishFrame(uint32_t gapUs);
+    bool feedDecoder(uint32_t duration, bool mark);
+    void deliverFrame(const IRDecodeResult& result);
+    void fillSignal(const IRDecodeResult& result, IRSignal* signal);
+    void storeRaw(IRSignal* signal);
+    void applyCarrier(IRSignal* signal);
+    void indexSignal(const IRSignal* signal, const String& label, bool persist = true);
+    bool coalesce(IRProtocol protocol, uint32_t address, uint32_t command, bool repeat);
+    bool matchesRaw(const IRSignal& signal);
+    int historySlot(int index);
+    static const char* protocolName(IRProtocol protocol);
+    void generateSignalName(IRProtocol protocol, uint32_t command, IRSignal* signal);
     static void IRAM_ATTR irInterruptHandler();
+    static void IRAM_ATTR batchFrameSent(void* arg);
 };
 
 extern IRModule irModule;
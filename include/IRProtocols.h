@@ -0,0 +1,98 @@
+#ifndef IRPROTOCOLS_H
+#define IRPROTOCOLS_H
+
+#include <stdint.h>
+
+// IR protocols. The values are stored in saved signals, so new protocols
+// are only ever appended.
+enum IRProtocol {
+    IR_UNKNOWN = 0,
+    IR_NEC,
+    IR_SONY,
+    IR_RC5,
+    IR_RC6,
+    IR_SAMSUNG,
+    IR_LG,
+    IR_RAW,
+    IR_NEC_EXT,         // NEC with a 16-bit address and a checked 8-bit command
+    IR_NEC_RAW          // NEC timing, 16-bit address and command as sent: no complement holds
+};
+
+// How data bits are told apart
+enum IREncoding {
+    IR_PULSE_DISTANCE = 0,  // fixed mark, the space length carries the bit (NEC)
+    IR_PULSE_WIDTH,         // fixed space, the mark length carries the bit (Sony)
+    IR_BIPHASE              // two half-bits of opposite level per bit (RC5, RC6)
+};
+
+// Flags
+#define IR_MSB_FIRST          0x01  // first bit on the air is the data MSB
+#define IR_ONE_SPACE_FIRST    0x02  // biphase: a one is space then mark (RC5)
+#define IR_LEADING_HALF_IDLE  0x04  // biphase: the first half-bit is a space lost in the idle line
+#define IR_COMMAND_INVERTED   0x08  // the command is followed by its complement (NEC, NEC extended)
+#define IR_NIBBLE_CHECKSUM    0x10  // the bits below the command are the sum of its nibbles (LG)
+#define IR_FIELD_BIT          0x20  // the bit after the start bit is the inverted 7th command bit (RC5)
+#define IR_TIMING_VARIANT     0x40  // same timing as the decoded row above, not decoded on its own: a
+                                    // frame of that row is reported as its first variant whose checks pass
+#define IR_ADDRESS_INVERTED   0x80  // the address is followed by its complement (NEC)
+
+#define IR_NO_DOUBLE_BIT      0xFF
+#define IR_NO_TOGGLE          0xFF
+
+// Timing description of one protocol variant, in microseconds. A zero
+// header or stop field means the protocol has none. For biphase
+// protocols oneMark is the half-bit time and the other bit fields are
+// unused.
+struct IRProtocolTiming {
+    IRProtocol protocol;
+    const char* name;
+    IREncoding encoding;
+    uint32_t carrierHz;
+    uint16_t headerMark;
+    uint16_t headerSpace;
+    uint16_t oneMark;
+    uint16_t oneSpace;
+    uint16_t zeroMark;
+    uint16_t zeroSpace;
+    uint16_t stopMark;
+    uint16_t repeatSpace;    // header mark, this space and the stop mark form a repeat code
+    uint32_t gap;            // minimum silence after a frame
+    uint8_t bits;
+    uint8_t doubleBit;       // biphase bit sent at twice the half-bit time (RC6 toggle)
+    uint8_t flags;
+    uint8_t tolerance;       // percent
+    uint8_t addressShift;
+    uint8_t addressBits;
+    uint8_t commandShift;
+    uint8_t commandBits;
+    uint32_t checkMask;      // fixed data bits (start and mode bits) ...
+    uint32_t checkValue;     // ... and their values
+    uint8_t toggleBit;       // data bit that flips on every new press (RC5, RC6)
+};
+
+// All protocol variants, in priority order: when a capture fits more than
+// one, the first wins. Adding a protocol is adding a row (IRProtocols.cpp).
+#define IR_PROTOCOL_TABLE_SIZE 10
+extern const IRProtocolTiming irProtocols[IR_PROTOCOL_TABLE_SIZE];
+
+// Bit i set when row i is stepped through a frame (not a timing variant)
+extern const uint32_t irDecodedRows;
+
+// The row that sends a protocol: the first one, or the one with that many
+// bits (Sony 12/15/20); nullptr for raw and unknown protocols
+const IRProtocolTiming* irFindTiming(IRProtocol protocol, uint8_t bits = 0);
+
+// The data word of a frame (the layout IRDecodeResult::data uses) from
+// its fields, with the fixed, complement and checksum bits filled in
+uint32_t irComposeData(const IRProtocolTiming& timing, uint32_t address, uint32_t command,
+                       bool toggle = false);
+
+// Frame bits that only follow from the others are right
+bool irCheckData(const IRProtocolTiming& timing, uint32_t data);
+
+// Mask of the low bits bits
+inline uint32_t irBitMask(uint8_t bits) {
+    return bits >= 32 ? 0xFFFFFFFFUL : (1UL << bits) - 1;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef IRSIGNAL_H
+#define IRSIGNAL_H
+
+#include <Arduino.h>
+#include "IRProtocols.h"
+
+// An IR signal as a value: the name and the raw durations live in the
+// object, so learning, history and loading never touch the heap.
+//
+// Raw captures of up to IR_SIGNAL_INLINE_RAW durations (every 48-bit
+// pulse distance frame) are kept inline. Longer ones, mostly air
+// conditioners, take a block of IR_SIGNAL_MAX_RAW durations from a
+// static pool of IR_RAW_POOL_BLOCKS shared by all signals. Blocks are
+// claimed and released with atomics, from either core, and a signal keeps
+// its block for the next capture that needs one.
+//
+// Copies are deep; when the pool is out of blocks the copy has no raw
+// durations (getRawLength() tells). Moves hand the block over.
+
+#define IR_SIGNAL_NAME_SIZE    32    // NUL included
+#define IR_SIGNAL_INLINE_RAW   100
+#define IR_SIGNAL_MAX_RAW      300   // longest capture kept
+#define IR_RAW_POOL_BLOCKS     16    // at most 32
+
+struct IRSignal {
+    IRProtocol protocol;
+    char name[IR_SIGNAL_NAME_SIZE];
+    uint32_t command;
+    uint32_t address;
+    uint16_t frequency;         // carrier, Hz: measured (IRCarrier.h) or the protocol's
+    uint8_t dutyCycle;          // carrier duty, percent; 0 when not measured
+    uint8_t bits;               // frame length of variable-length protocols (Sony); 0 for the default
+    unsigned long timestamp;
+
+    IRSignal();
+    IRSignal(const IRSignal& other);
+    IRSignal(IRSignal&& other);
+    ~IRSignal();
+    IRSignal& operator=(const IRSignal& other);
+    IRSignal& operator=(IRSignal&& other);
+
+    // Truncated to IR_SIGNAL_NAME_SIZE - 1 characters
+    void setName(const char* text);
+    void setName(const String& text) { setName(text.c_str()); }
+
+    // Raw durations, alternating mark/space from a mark
+    const uint16_t* getRaw() const { return rawLength ? rawData : nullptr; }
+    uint16_t getRawLength() const { return rawLength; }
+    bool setRaw(const uint16_t* data, uint16_t length);
+
+    // Room for length durations, to be filled in place; nullptr (and no
+    // raw durations) when longer than IR_SIGNAL_MAX_RAW or the pool is out
+    uint16_t* resizeRaw(uint16_t length);
+    void clearRaw();
+    bool usesPool() const { return rawData != inlineRaw; }
+
+    static int getPoolFree();
+
+private:
+    uint16_t* rawData;          // inlineRaw or a pool block
+    uint16_t rawLength;
+    uint16_t inlineRaw[IR_SIGNAL_INLINE_RAW];
+
+    void copyFields(const IRSignal& other);
+    void releaseBlock();
+};
+
+#endif
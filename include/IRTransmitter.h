@@ -0,0 +1,70 @@
+#ifndef IRTRANSMITTER_H
+#define IRTRANSMITTER_H
+
+#include <Arduino.h>
+#include "IRWaveform.h"
+
+#ifndef NATIVE_HAL
+#include <driver/rmt.h>
+#endif
+
+// Sends an IRWaveform on the IR LED through the RMT peripheral. The RMT
+// generates the carrier in hardware and clocks the frame out on its own,
+// so send() returns at once and the CPU is free for the whole frame.
+//
+// One frame at a time: send() fails while a frame is on the air. The
+// completion callback runs in interrupt context on the device (the RMT
+// TX-end interrupt); use it to notify a scheduler job, nothing more.
+//
+// The native build replays the frame on the pin as virtual-time events
+// (carrier envelope only) and completes at the frame's end.
+
+#define IR_TX_RMT_CHANNEL   0
+#define IR_TX_MAX_ITEMS     (IR_WAVEFORM_MAX_LENGTH / 2 + 32)  // room for split long spaces
+
+typedef void (*IRTransmitCallback)(void* arg);
+
+class IRTransmitter {
+public:
+    IRTransmitter();
+    bool begin(uint8_t pin);
+
+    // Queues a frame; false when busy, not started or the frame does not fit
+    bool send(const IRWaveform& waveform, IRTransmitCallback done = nullptr, void* arg = nullptr);
+    bool isBusy() { return busy; }
+
+    // Statistics
+    uint32_t getFramesSent() { return framesSent; }
+    uint32_t getRejected() { return rejected; }
+
+private:
+    uint8_t txPin;
+    bool started;
+    volatile bool busy;
+    IRTransmitCallback doneCallback;
+    void* doneArg;
+    uint32_t currentCarrier;
+    uint8_t currentDuty;
+
+    // The RMT driver reads the items while sending, so they live here
+    uint32_t items[IR_TX_MAX_ITEMS];
+    size_t itemCount;
+
+    uint32_t framesSent;
+    uint32_t rejected;
+
+    void finish();
+
+#ifdef NATIVE_HAL
+    size_t playIndex;
+    uint8_t playHalf;
+    static void playNext(void* arg);
+#else
+    bool setCarrier(uint32_t carrierHz, uint8_t dutyPercent);
+    static void IRAM_ATTR txEnd(rmt_channel_t channel, void* arg);
+#endif
+};
+
+extern IRTransmitter irTransmitter;
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef IRWAVEFORM_H
+#define IRWAVEFORM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "IRProtocols.h"
+
+// An IR frame as alternating mark/space durations (microseconds, first
+// entry a mark) plus the carrier it is modulated with. The protocol
+// encoders build one from the decoder's timing table, so every protocol
+// that is received can be sent; IRTransmitter turns it into RMT items.
+//
+// No hardware access, so the encoders and the RMT packing run unchanged
+// in the host build and the benchmarks.
+
+#define IR_WAVEFORM_MAX_LENGTH 320
+#define IR_DEFAULT_CARRIER_HZ 38000
+#define IR_DEFAULT_DUTY_PERCENT 33
+
+// RMT items: 1 us ticks, 15-bit durations
+#define IR_RMT_MAX_DURATION 32767
+
+class IRWaveform {
+public:
+    IRWaveform();
+
+    // Starts an empty frame
+    void begin(uint32_t carrierHz, uint8_t dutyPercent = IR_DEFAULT_DUTY_PERCENT);
+
+    // Keeps the durations and changes the carrier, e.g. to the one
+    // measured when the signal was learned
+    void setCarrier(uint32_t carrierHz, uint8_t dutyPercent = IR_DEFAULT_DUTY_PERCENT);
+
+    // Append; a mark after a mark (or space after space) is merged.
+    // False once the frame is full.
+    bool mark(uint32_t us);
+    bool space(uint32_t us);
+
+    // Protocol encoders (begin() included); false when the frame does not fit.
+    // encode() sends a data word laid out as IRDecodeResult::data (see
+    // irComposeData()): header, bits, stop mark, without the trailing gap.
+    bool encode(const IRProtocolTiming& timing, uint32_t data);
+    bool encodeNEC(uint32_t address, uint32_t command);   // 16-bit fields as sent (NECraw)
+    bool encodeSony(uint32_t data, int nbits);   // 12, 15 or 20 bits
+    bool encodeRaw(const uint16_t* data, uint16_t length, uint16_t frequency);
+
+    // Packs the frame into RMT items (level 1 = carrier on) followed by a
+    // zero end marker. Durations above IR_RMT_MAX_DURATION are split.
+    // Returns the item count including the marker, 0 when maxItems is too small.
+    size_t toRMTItems(uint32_t* items, size_t maxItems) const;
+
+    uint32_t getCarrier() const { return carrierHz; }
+    uint8_t getDutyPercent() const { return dutyPercent; }
+    uint16_t getLength() const { return length; }
+    uint32_t getDuration(uint16_t index) const { return index < length ? durations[index] : 0; }
+    uint32_t getTotalMicros() const;
+
+private:
+    uint32_t carrierHz;
+    uint8_t dutyPercent;
+    uint16_t length;
+    uint32_t durations[IR_WAVEFORM_MAX_LENGTH];
+
+    bool append(uint32_t us, bool isMark);
+};
+
+#endif
@@ -16,6 +16,8 @@ enum JoystickDirection {
 #define JOYSTICK_DOWN_PIN   5
 #define JOYSTICK_SELECT_PIN 6
 
+#define JOYSTICK_DEBOUNCE_MS 50
+
 class Joystick {
 public:
     Joystick();
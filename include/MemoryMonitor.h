@@ -0,0 +1,97 @@
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include <Arduino.h>
+
+// Heap and stack telemetry.
+//
+// Every operator new / delete in the firmware is counted (global
+// replacements in MemoryMonitor.cpp) and charged to the call site that is
+// active on the allocating core. A site is entered with MEMORY_SITE(...)
+// at the top of the function; nested sites charge the innermost one.
+//
+// Arduino String grows its buffer with malloc/realloc, which operator new
+// never sees, so each site also records the net change in free heap
+// across its calls. A site whose net bytes keep climbing is leaking,
+// whether through new[] or through a String that is kept around. The
+// net figure is approximate while the other core is allocating.
+
+#define MEMORY_SAMPLE_INTERVAL_MS 10000
+#define MEMORY_LOW_HEAP_BYTES     (16 * 1024)  // warn when the largest block drops below this
+
+enum MemorySite {
+    MEMORY_SITE_OTHER = 0,
+    MEMORY_SITE_IR_DECODE,
+    MEMORY_SITE_RF_DECODE,
+    MEMORY_SITE_IR_LOAD,
+    MEMORY_SITE_RF_LOAD,
+    MEMORY_SITE_IR_SAVE,
+    MEMORY_SITE_RF_SAVE,
+    MEMORY_SITE_SIGNAL_NAME,
+    MEMORY_SITE_COUNT
+};
+
+struct MemorySiteStats {
+    uint32_t calls;
+    uint32_t news;
+    uint32_t deletes;
+    uint32_t newBytes;
+    int32_t netHeapBytes;   // free heap lost across all calls (negative = freed)
+};
+
+class MemoryMonitor {
+public:
+    // Called from the global operator new / delete
+    void recordNew(size_t size);
+    void recordDelete();
+
+    // Site tracking (use MEMORY_SITE)
+    MemorySite enterSite(MemorySite site);
+    void exitSite(MemorySite previous, MemorySite site, int32_t heapLost);
+
+    // Samples free heap and largest block; warns once when the largest
+    // block falls below MEMORY_LOW_HEAP_BYTES
+    void update();
+
+    // Statistics
+    uint32_t getNewCount() { return totalNews; }
+    uint32_t getDeleteCount() { return totalDeletes; }
+    uint32_t getLiveAllocations() { return totalNews - totalDeletes; }
+    uint32_t getMinLargestBlock() { return minLargestBlock; }
+    const MemorySiteStats& getSiteStats(MemorySite site) { return sites[site]; }
+    const char* getSiteName(MemorySite site);
+
+    // Heap, stack watermarks and per-site counters
+    void dump(Print& out);
+
+private:
+    // Zero-initialized before any constructor runs, so allocations made
+    // during static initialization are already counted
+    volatile uint32_t totalNews;
+    volatile uint32_t totalDeletes;
+    volatile uint32_t totalNewBytes;
+    MemorySiteStats sites[MEMORY_SITE_COUNT];
+    volatile uint8_t currentSite[2];    // per core
+    uint32_t minLargestBlock;
+    bool lowHeapWarned;
+
+    static uint8_t coreIndex();
+};
+
+// Charges allocations in the enclosing scope to a site
+class MemorySiteScope {
+public:
+    MemorySiteScope(MemorySite site);
+    ~MemorySiteScope();
+
+private:
+    MemorySite site;
+    MemorySite previous;
+    uint32_t freeHeapAtEntry;
+};
+
+#define MEMORY_SITE(site) MemorySiteScope memorySiteScope(site)
+
+extern MemoryMonitor memoryMonitor;
+
+#endif
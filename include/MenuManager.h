@@ -36,8 +36,12 @@ public:
     int getCurrentSelection() { return currentSelection; }
     bool isInSubmenu() { return currentState != MENU_MAIN; }
     
-    // Module execution
+    // Module execution; the action screen stays up until SELECT
     void runModule(int moduleId, int actionId);
+    bool isScreenOpen() { return currentState == MENU_MODULE_RUNNING; }
+    
+    // Redraw on the next update(), e.g. when an action's progress moved
+    void refresh() { needsRedraw = true; }
 
 private:
     MenuState currentState;
@@ -47,12 +51,23 @@ private:
     bool needsRedraw;
     unsigned long lastInputTime;
     
+    // Full-screen page shown in MENU_MODULE_RUNNING
+    const char* screenTitle;
+    const char* screenBody;
+    int screenModule;       // module whose action is running, -1 for none
+    int screenAction;
+    int previousSelection;
+    
     void updateMaxItems();
     void drawMainMenu();
     void drawCurrentSubmenu();
+    void drawActionScreen();
+    void drawIRAnalyzer();
     const MenuItem* getCurrentMenuItems();
     int getCurrentMenuCount();
     void executeMenuAction();
+    void openScreen(const char* title, const char* body, int moduleId = -1, int actionId = 0);
+    void closeScreen();
     
     // Menu helpers
     void moveUp();
@@ -0,0 +1,62 @@
+#ifndef MODULE_H
+#define MODULE_H
+
+#include <Arduino.h>
+
+// Module ids, in main menu order (MENU_NFC .. MENU_GPIO), so a main menu
+// selection doubles as a module id
+enum ModuleId {
+    MODULE_NFC = 0,
+    MODULE_IR,
+    MODULE_IBUTTON,
+    MODULE_RF,
+    MODULE_GPIO,
+    MODULE_COUNT
+};
+
+#define MODULE_BIT(id) (1UL << (id))
+#define MODULE_MASK_ALL (MODULE_BIT(MODULE_COUNT) - 1)
+
+// Events the menu sends to a module
+enum ModuleEventType {
+    MODULE_EVENT_ACTION_START = 0,  // a submenu action screen was opened
+    MODULE_EVENT_ACTION_STOP        // ... and closed again
+};
+
+struct ModuleEvent {
+    ModuleEventType type;
+    int actionId;                   // submenu item (NFC_SCAN, IR_SCAN, ...)
+};
+
+// Counters kept by the registry for every module
+struct ModuleStats {
+    uint32_t updates;
+    uint32_t events;
+    bool initFailed;
+};
+
+// Common interface of the hardware modules. The registry owns the calls:
+// update() only runs while the module is active.
+class Module {
+public:
+    Module(ModuleId id, const char* name) : moduleId(id), moduleName(name) {}
+    virtual ~Module() {}
+
+    virtual bool init() = 0;
+    virtual void update() = 0;
+    virtual void onEvent(const ModuleEvent& event) {}
+    
+    // Percent done of a running action, shown on its screen; -1 for none
+    virtual int getProgress(int actionId) { return -1; }
+
+    ModuleId getModuleId() { return moduleId; }
+    const char* getModuleName() { return moduleName; }
+    ModuleStats& getStats() { return stats; }
+
+private:
+    ModuleId moduleId;
+    const char* moduleName;
+    ModuleStats stats = {};
+};
+
+#endif
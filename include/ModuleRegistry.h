@@ -0,0 +1,53 @@
+#ifndef MODULEREGISTRY_H
+#define MODULEREGISTRY_H
+
+#include <Arduino.h>
+#include "Module.h"
+#include "Scheduler.h"
+
+// Fixed table of all modules plus a bitmask of the active ones. Callers
+// test a bit instead of comparing module names, and every call into a
+// module goes through here so it can be counted.
+//
+// Modules initialize lazily: the settings only enable them, and the first
+// activate() (entering the module's menu) runs init().
+class ModuleRegistry {
+public:
+    ModuleRegistry();
+
+    // Modules the settings allow
+    void setEnabled(uint32_t enabledMask);
+    
+    // The scheduler job that drives a module; it is notified when the
+    // module becomes active so a stopped periodic job starts ticking
+    void setJob(ModuleId id, Scheduler* scheduler, int job);
+    
+    // Initializes the module on first use; true once it is active.
+    // A module whose init() failed is not probed again.
+    bool activate(ModuleId id);
+
+    // Dispatch (no-ops for inactive modules)
+    void update(ModuleId id);
+    void dispatch(ModuleId id, const ModuleEvent& event);
+    int getProgress(ModuleId id, int actionId);
+
+    // Getters
+    Module* get(ModuleId id);
+    bool isActive(ModuleId id) { return activeMask & MODULE_BIT(id); }
+    uint32_t getActiveMask() { return activeMask; }
+    uint32_t getInitializedMask() { return initializedMask; }
+
+    void printStats();
+
+private:
+    Module* modules[MODULE_COUNT];
+    Scheduler* schedulers[MODULE_COUNT];
+    int jobs[MODULE_COUNT];
+    uint32_t enabledMask;
+    uint32_t initializedMask;
+    volatile uint32_t activeMask;
+};
+
+extern ModuleRegistry moduleRegistry;
+
+#endif
@@ -5,11 +5,15 @@
 #include <SPI.h>
 #include <MFRC522.h>
 #include <ArduinoJson.h>
+#include "Module.h"
 
 // NFC pin definitions
 #define NFC_SS_PIN    10
 #define NFC_RST_PIN   9
 
+// Card presence poll
+#define NFC_POLL_INTERVAL_MS 100
+
 // NFC card types
 enum NFCCardType {
     NFC_UNKNOWN = 0,
@@ -30,11 +34,11 @@ struct NFCCard {
     unsigned long timestamp;
 };
 
-class NFCModule {
+class NFCModule : public Module {
 public:
     NFCModule();
-    bool init();
-    void update();
+    bool init() override;
+    void update() override;
     
     // Scanning functions
     bool scanForCard();
@@ -0,0 +1,100 @@
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include <Arduino.h>
+#include "Module.h"
+#include "Scheduler.h"
+
+// Power saving, both switched by the autoSleep setting:
+//
+//   Light sleep  When neither scheduler has anything due for at least
+//                POWER_MIN_SLEEP_US, the UI task puts the chip into light
+//                sleep until the earlier deadline instead of idling in
+//                FreeRTOS. A wake pin at its active level (joystick, or a
+//                receiver that is listening) ends the sleep early.
+//   Screen off   The OLED is switched off after sleepTimeout ms without
+//                input; the next press only turns it back on.
+//
+// Light sleep also suspends the USB serial console, which is why it is
+// not on unconditionally.
+//
+// Waking takes a few hundred microseconds, longer than the shortest IR
+// mark, so a module holds the chip awake while it is timing a frame
+// (holdAwake from the first edge until the frame is processed). The edge
+// that wakes the chip from an idle receiver is timestamped late by the
+// wake-up time; a leader mark is long enough to absorb that.
+//
+// The host build has no light sleep: sleep() waits as usual and only does
+// the accounting, so a replay reports how long the device would sleep.
+
+#define POWER_MIN_SLEEP_US      2000UL  // shorter idle stretches are not worth the entry/exit cost
+#define POWER_WAKE_LATENCY_US   500UL   // timer wake-up is set this much early
+#define POWER_MAX_WAKE_PINS     6
+
+// Holders that are not a module's receiver, with a bit of their own after
+// the modules' (a module releases its bit whenever its receiver is idle)
+enum PowerHold {
+    POWER_HOLD_IR_TX = MODULE_COUNT     // an RMT frame is on the air (APB clock drives it)
+};
+
+class PowerManager {
+public:
+    PowerManager();
+
+    // autoSleep and sleepTimeout from the settings
+    void configure(bool autoSleep, uint32_t sleepTimeoutMs);
+    bool isLightSleepEnabled() { return lightSleepEnabled; }
+    uint32_t getScreenTimeoutMs() { return screenTimeoutMs; }
+
+    // A pin that ends light sleep at the given level (HIGH/LOW) and
+    // notifies job on scheduler, if any, once the chip is up
+    bool addWakePin(uint8_t pin, int level, Scheduler* scheduler = nullptr, int job = -1);
+    void setWakePinEnabled(uint8_t pin, bool enabled);
+
+    // Keep the chip out of light sleep (ISR-safe)
+    void holdAwake(ModuleId id);
+    void releaseAwake(ModuleId id);
+    void holdAwake(PowerHold hold);
+    void releaseAwake(PowerHold hold);
+
+    // Called by the UI task in place of uiScheduler.wait(): sleeps for up
+    // to timeoutUs and returns true, or returns false without sleeping
+    bool sleep(unsigned long timeoutUs);
+
+    // Screen: true when the screen had been off (the input only woke it)
+    bool onActivity();
+    void screenOff();
+
+    // Statistics
+    uint32_t getSleepCount() { return sleepCount; }
+    uint64_t getSleptUs() { return sleptUs; }
+    void dump(Print& out);
+
+private:
+    struct WakePin {
+        uint8_t pin;
+        int level;
+        Scheduler* scheduler;
+        int job;
+        volatile bool enabled;
+    };
+
+    bool lightSleepEnabled;
+    uint32_t screenTimeoutMs;
+    volatile uint32_t awakeMask;
+    WakePin wakePins[POWER_MAX_WAKE_PINS];
+    int wakePinCount;
+
+    uint32_t sleepCount;
+    uint64_t sleptUs;
+    uint32_t heldSkips;
+    uint32_t pinSkips;
+    uint32_t screenOffCount;
+
+    bool wakePinActive();
+    void enterLightSleep(unsigned long sleepUs);
+};
+
+extern PowerManager powerManager;
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Module.h"
+
+// Duration histograms for the hot paths, measured in CPU cycles
+// (ESP.getCycleCount(), ~4 ns at 240 MHz). On the native build the cycle
+// counter follows virtual time, so only simulated bus and SD time shows up.
+//
+// Buckets are log-linear: four per power of two, so a reported percentile
+// is never more than 25% above the true value. Each probe is only ever
+// written from one core (modules stay on their task, display and SD are
+// UI-side), so recording needs no locking.
+//
+// Dump over serial with the "prof" console command.
+
+// Probes; the first MODULE_COUNT are the modules' update() calls
+enum ProfileProbe {
+    PROBE_MODULE_NFC = MODULE_NFC,
+    PROBE_MODULE_IR = MODULE_IR,
+    PROBE_MODULE_IBUTTON = MODULE_IBUTTON,
+    PROBE_MODULE_RF = MODULE_RF,
+    PROBE_MODULE_GPIO = MODULE_GPIO,
+    PROBE_DISPLAY_FLUSH = MODULE_COUNT,
+    PROBE_STORAGE_UPDATE,
+    PROBE_SD_READ,
+    PROBE_SD_WRITE,
+    PROBE_SD_SCAN,
+    PROBE_COUNT
+};
+
+#define PROFILER_BUCKETS 124  // 4 per power of two up to 2^32 cycles
+
+struct ProfileHistogram {
+    uint32_t count;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t buckets[PROFILER_BUCKETS];
+};
+
+class Profiler {
+public:
+    Profiler();
+
+    void record(ProfileProbe probe, uint32_t cycles);
+    void reset();
+
+    // Statistics (in cycles)
+    const ProfileHistogram& getHistogram(ProfileProbe probe) { return histograms[probe]; }
+    uint32_t getPercentile(ProfileProbe probe, uint8_t percent);
+    const char* getProbeName(ProfileProbe probe);
+
+    // count / mean / min / p50 / p99 / max per probe, in microseconds
+    void dump(Print& out);
+    // Non-empty buckets of one probe
+    void dumpHistogram(Print& out, ProfileProbe probe);
+
+    static uint8_t bucketFor(uint32_t cycles);
+    static uint32_t bucketLowerBound(uint8_t bucket);
+
+private:
+    ProfileHistogram histograms[PROBE_COUNT];
+};
+
+// Records the lifetime of the enclosing scope
+class ProfileScope {
+public:
+    ProfileScope(ProfileProbe probe) : probe(probe), start(ESP.getCycleCount()) {}
+    ~ProfileScope();
+
+private:
+    ProfileProbe probe;
+    uint32_t start;
+};
+
+#define PROFILE_SCOPE(probe) ProfileScope profileScope(probe)
+
+extern Profiler profiler;
+
+#endif
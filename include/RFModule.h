@@ -3,11 +3,27 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "Module.h"
+#include "EdgeRing.h"
 
 // RF pin definitions
 #define RF_RECEIVER_PIN 12
 #define RF_TRANSMITTER_PIN 13
 
+// Capture: the pin interrupt queues every edge with its micros() timestamp
+// and level in a ring (EdgeRing.h), and update() turns them into pulse
+// durations at full microsecond resolution. A burst starts at a rising
+// edge (the receiver idles low), so durations alternate high, low, high...
+// Edges the ring or the burst buffer had no room for are counted, and a
+// burst that lost any is reported.
+#define RF_EDGE_RING_SIZE     1024      // edges; about 100 ms of a 4800 bps burst
+#define RF_MAX_RAW_LENGTH     1000      // durations kept per burst
+#define RF_DRAIN_INTERVAL_US  20000UL   // ring drained at least this often while receiving
+// A burst ends after this long without an edge
+#define RF_RECEIVE_TIMEOUT_US 200000UL
+// Time spent on each frequency during a scan
+#define RF_SCAN_DWELL_US      1000UL
+
 // RF protocols
 enum RFProtocol {
     RF_UNKNOWN = 0,
@@ -18,27 +34,64 @@ enum RFProtocol {
     RF_RAW
 };
 
-// RF signal structure
+// RF signal structure. The raw durations are owned by the signal: a raw
+// burst takes a block of RF_MAX_RAW_LENGTH durations from a static pool of
+// RF_RAW_POOL_BLOCKS shared by all signals, so capture never touches the
+// heap and raw storage is bounded no matter how long the history. Blocks
+// are claimed and released with atomics, from either core, and a signal
+// keeps its block for the next burst.
+//
+// Copies are deep; when the pool is out of blocks the copy has no raw
+// durations (getRawLength() tells). Moves hand the block over.
+#define RF_RAW_POOL_BLOCKS    8         // at most 32; 4 KB each
+#define RF_RAW_POOL_RESERVE   2         // left free by the history for loading and sending
+
 struct RFSignal {
     RFProtocol protocol;
     String name;
     uint32_t frequency;
     uint32_t bitrate;
     uint32_t data;
-    uint8_t* rawData;
-    size_t rawLength;
     uint8_t modulation;
     unsigned long timestamp;
+
+    RFSignal();
+    RFSignal(const RFSignal& other);
+    RFSignal(RFSignal&& other);
+    ~RFSignal();
+    RFSignal& operator=(const RFSignal& other);
+    RFSignal& operator=(RFSignal&& other);
+
+    // Durations in us, alternating high/low from a high
+    const uint32_t* getRaw() const { return rawLength ? rawData : nullptr; }
+    size_t getRawLength() const { return rawLength; }
+    bool setRaw(const uint32_t* durations, size_t length);
+
+    // Room for length durations, to be filled in place; nullptr (and no
+    // raw durations) when longer than RF_MAX_RAW_LENGTH or the pool is out
+    uint32_t* resizeRaw(size_t length);
+    void clearRaw();
+    bool hasBlock() const { return rawData != nullptr; }
+
+    static int getPoolFree();
+
+private:
+    uint32_t* rawData;          // a pool block or nullptr
+    size_t rawLength;
+
+    void copyFields(const RFSignal& other);
 };
 
-class RFModule {
+class RFModule : public Module {
 public:
     RFModule();
-    bool init();
-    void update();
+    bool init() override;
+    void update() override;
+    void onEvent(const ModuleEvent& event) override;
     
     // Receiving functions
     bool receiveSignal();
+    void stopReceiving();
     bool decodeSignal(RFSignal* signal);
     String getProtocolString(RFProtocol protocol);
     
@@ -46,7 +99,7 @@ public:
     bool transmitSignal(const RFSignal* signal);
     bool transmitASK(uint32_t data, uint8_t bits, uint32_t frequency);
     bool transmitFSK(uint32_t data, uint8_t bits, uint32_t frequency);
-    bool transmitRaw(uint8_t* data, size_t length, uint32_t frequency);
+    bool transmitRaw(const uint32_t* durations, size_t length, uint32_t frequency);
     
     // Frequency scanning
     void startFrequencyScan(uint32_t startFreq, uint32_t endFreq);
@@ -70,9 +123,15 @@ public:
     // Status
     bool isReceiving();
     bool isTransmitting();
+    bool hasReceivedSignal() { return signalReceived; }
+    uint32_t getDroppedEdges() { return edgeRing.getOverflows() + truncatedEdges; }
+    unsigned long getNextDeadline();
     bool isInitialized() { return rfInitialized; }
 
 private:
+    // Host microbenchmarks (bench/) drive the decoders directly
+    friend class ModuleBench;
+    
     bool rfInitialized;
     RFSignal currentSignal;
     bool signalReceived;
@@ -83,12 +142,22 @@ private:
     uint32_t scanStartFreq;
     uint32_t scanEndFreq;
     unsigned long lastReceiveTime;
+    unsigned long lastScanStepTime;
+    
+    // Edges from the pin interrupt
+    EdgeRing<RF_EDGE_RING_SIZE> edgeRing;
+    volatile uint8_t lastLevel;
     
-    // Raw data buffer
-    static const int MAX_RAW_LENGTH = 1000;
-    uint8_t rawBuffer[MAX_RAW_LENGTH];
-    volatile size_t rawIndex;
-    volatile unsigned long lastEdgeTime;
+    // Burst being assembled
+    static const int MAX_RAW_LENGTH = RF_MAX_RAW_LENGTH;
+    uint32_t rawBuffer[MAX_RAW_LENGTH];
+    size_t rawIndex;
+    bool burstOpen;
+    uint32_t lastEdgeTime;   // of the last edge taken from the ring; start of reception before the first
+    uint8_t lastEdgeLevel;
+    uint32_t burstOverflows; // ring overflow count when the burst started
+    uint32_t truncatedEdges; // edges past the end of a full burst buffer
+    uint32_t burstLost;      // edges the current burst is missing
     
     // History storage
     static const int MAX_HISTORY = 50;
@@ -104,8 +173,9 @@ private:
     
     // Helper functions
     void startReceiving();
-    void stopReceiving();
-    void captureRawData();
+    void captureEdge();
+    void addEdge(const Edge& edge);
+    void finishBurst();
     String generateSignalName(RFProtocol protocol, uint32_t frequency);
     void setFrequency(uint32_t frequency);
     static void IRAM_ATTR rfInterruptHandler();
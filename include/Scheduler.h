@@ -0,0 +1,119 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#ifndef NATIVE_HAL
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Deadline scheduler for one task. Jobs run when their deadline passes or
+// when they are notified (from another task or from an ISR); between runs
+// the owning task sleeps until the earliest deadline instead of polling on a
+// fixed tick.
+//
+// A job is either periodic (re-armed one period after its previous deadline)
+// or one-shot (disarmed before it runs; it re-arms itself with scheduleAt()
+// if it still has work, e.g. a reception timeout that moved). A cancelled
+// periodic job restarts its period when it is next notified.
+//
+// Deadlines are micros() values and compared wrap-safe, so the 71 minute
+// micros() rollover on the ESP32 is harmless.
+
+#define SCHEDULER_MAX_JOBS     12
+#define SCHEDULER_MAX_PINS     4
+#define SCHEDULER_MAX_SLEEP_US 1000000UL  // re-check at least once a second
+
+typedef void (*SchedulerJob)();
+
+class Scheduler {
+public:
+    Scheduler(const char* name);
+
+    // Registration (before begin())
+    int addJob(const char* name, SchedulerJob job, unsigned long periodUs = 0);
+    bool wakeOnPin(uint8_t pin, int id, int mode);
+
+    // Deadlines
+    void scheduleAt(int id, unsigned long atMicros);
+    void scheduleIn(int id, unsigned long delayUs);
+    void cancel(int id);
+    void notify(int id);
+    void IRAM_ATTR notifyFromISR(int id);
+
+    // Bind to the calling task so notifications can wake it
+    void begin();
+
+    // Runs every notified or due job once and returns the time until the
+    // next deadline (capped at SCHEDULER_MAX_SLEEP_US)
+    unsigned long runDue();
+
+    // Sleeps for up to timeoutUs or until a job is notified
+    void wait(unsigned long timeoutUs);
+
+    // Time left until the deadline runDue() last returned; 0 while jobs are
+    // running or a notification is pending. Safe to call from another task.
+    unsigned long getIdleUs();
+    bool hasPending() { return pendingMask != 0; }
+
+    // Makes the owning task re-check its deadlines now
+    void wake() { wakeTask(); }
+
+#ifdef NATIVE_HAL
+    // Drive this scheduler from virtual-time timers instead of a task, the
+    // host stand-in for a task running on the other core
+    void startTimer();
+#endif
+
+    // Statistics
+    const char* getName() { return schedulerName; }
+    int getJobCount() { return jobCount; }
+    const char* getJobName(int id);
+    uint32_t getJobRuns(int id);
+    uint32_t getWakeups() { return wakeups; }
+
+private:
+    struct Job {
+        const char* name;
+        SchedulerJob run;
+        unsigned long periodUs;
+        unsigned long deadline;
+        bool armed;
+        uint32_t runs;
+    };
+
+    struct PinWake {
+        Scheduler* scheduler;
+        int id;
+    };
+
+    const char* schedulerName;
+    Job jobs[SCHEDULER_MAX_JOBS];
+    int jobCount;
+    volatile uint32_t pendingMask;
+    PinWake pinWakes[SCHEDULER_MAX_PINS];
+    int pinWakeCount;
+    uint32_t wakeups;
+    volatile bool running;
+    volatile unsigned long idleUntil;
+
+#ifdef NATIVE_HAL
+    bool timerDriven;
+    uint64_t timerId;
+
+    void armTimer(unsigned long delayUs);
+    static void timerCallback(void* arg);
+#else
+    TaskHandle_t taskHandle;
+#endif
+
+    unsigned long nextSleepUs();
+    void wakeTask();
+    static void IRAM_ATTR pinWakeISR(void* arg);
+};
+
+extern Scheduler captureScheduler;
+extern Scheduler uiScheduler;
+
+#endif
@@ -10,7 +10,7 @@ struct SystemSettings {
     uint8_t brightness;
     uint8_t contrast;
     bool autoSleep;
-    uint16_t sleepTimeout;
+    uint32_t sleepTimeout;  // ms without input before the screen turns off
     bool invertDisplay;
     
     // Sound settings
@@ -38,6 +38,7 @@ struct SystemSettings {
     bool iButtonEnabled;
     bool rfEnabled;
     bool gpioEnabled;
+    bool irCarrierSensor;   // raw IR sensor fitted on IR_CARRIER_PIN
 };
 
 class SettingsManager {
@@ -55,6 +56,8 @@ public:
     uint8_t getBrightness() { return settings.brightness; }
     uint8_t getVolume() { return settings.volume; }
     bool isSoundEnabled() { return settings.soundEnabled; }
+    bool isAutoSleepEnabled() { return settings.autoSleep; }
+    uint32_t getSleepTimeout() { return settings.sleepTimeout; }
     bool isAutoSaveEnabled() { return settings.autoSave; }
     bool isDebugModeEnabled() { return settings.debugMode; }
     
@@ -69,7 +72,7 @@ public:
     // Display settings
     void setContrast(uint8_t contrast);
     void setAutoSleep(bool enabled);
-    void setSleepTimeout(uint16_t timeout);
+    void setSleepTimeout(uint32_t timeout);
     void setInvertDisplay(bool invert);
     
     // Sound settings
@@ -87,6 +90,9 @@ public:
     // Module settings
     void setModuleEnabled(const String& module, bool enabled);
     bool isModuleEnabled(const String& module);
+    uint32_t getEnabledModules();  // MODULE_BIT() mask, see Module.h
+    void setIRCarrierSensor(bool fitted);
+    bool isIRCarrierSensorFitted() { return settings.irCarrierSensor; }
     
     // Status
     bool isInitialized() { return settingsInitialized; }
@@ -12,11 +12,15 @@
 #define SD_MISO_PIN  17
 #define SD_SCK_PIN   18
 
+// Card presence check
+#define STORAGE_CHECK_INTERVAL_MS 5000
+
 // Directory structure
 #define ROOT_DIR        "/"
 #define SETTINGS_DIR    "/settings"
 #define NFC_DIR         "/nfc"
 #define IR_DIR          "/ir"
+#define IR_REMOTE_DIR   "/ir/remotes"
 #define IBUTTON_DIR     "/ibutton"
 #define RF_DIR          "/rf"
 #define GPIO_DIR        "/gpio"
@@ -27,6 +31,7 @@
 #define SETTINGS_EXT    ".json"
 #define NFC_EXT         ".nfc"
 #define IR_EXT          ".ir"
+#define IR_REMOTE_EXT   ".irl"
 #define IBUTTON_EXT     ".ibtn"
 #define RF_EXT          ".rf"
 #define GPIO_EXT        ".gpio"
@@ -68,6 +73,8 @@ public:
     // Binary file operations
     bool writeBinaryFile(const String& path, const uint8_t* data, size_t size);
     bool readBinaryFile(const String& path, uint8_t* data, size_t& size);
+    bool appendBinaryFile(const String& path, const uint8_t* data, size_t size);
+    bool readBinaryAt(const String& path, size_t offset, uint8_t* data, size_t size);
     
     // Backup and restore
     bool backupSettings();
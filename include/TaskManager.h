@@ -0,0 +1,147 @@
+#ifndef TASKMANAGER_H
+#define TASKMANAGER_H
+
+#include <Arduino.h>
+
+#ifndef NATIVE_HAL
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#endif
+
+// Work is split across the two ESP32-S3 cores:
+//
+//   core 0  "capture"  priority 5  IR, RF, GPIO and iButton update/decode.
+//                                  Never touches the display, SD card or
+//                                  SPI bus once booted.
+//   core 1  "ui"       priority 2  Joystick, menu, NFC, storage and the
+//                                  display flush. NFC stays here because the
+//                                  MFRC522 shares the SPI bus with the SD card.
+//
+// The one exception is the boot load: the capture core mounts the SD card
+// and reads the settings and IR fingerprint index while the UI core
+// animates over I2C. Nothing on the UI core can reach SPI until the load
+// is done: NFC is only initialized when its module is first activated,
+// and the storage, input and console jobs wait for systemReady, which is
+// set once the load has finished. Capture itself has not started yet.
+//
+// Each task runs its Scheduler (captureScheduler / uiScheduler): it sleeps
+// until the earliest job deadline or until a job is notified, so neither
+// side polls on a fixed tick.
+//
+// Capture outranks every application task so a slow SD write or I2C flush
+// on core 1 can no longer delay edge timestamps or reception timeouts. The
+// Arduino loop task (priority 1) deletes itself once both tasks are up.
+//
+// The cores only talk through two bounded queues. Neither side ever blocks
+// on a full queue: the message is dropped and counted instead. Queuing a
+// message notifies the receiving side's job.
+//
+//   capture -> ui  CaptureEvent    (decoded signals, key present, ...)
+//   ui -> capture  CaptureCommand  (start/stop learning, ...)
+//
+// Whenever both sides are idle long enough, the UI task puts the chip into
+// light sleep instead of waiting (see PowerManager.h).
+//
+// The native build has no second core: the UI scheduler runs from loop()
+// and the capture scheduler from virtual-time timers, which interleaves the
+// two the same way.
+
+#include "Scheduler.h"
+
+#define CAPTURE_TASK_CORE      0
+#define CAPTURE_TASK_PRIORITY  5
+#define CAPTURE_TASK_STACK     4096
+
+#define UI_TASK_CORE           1
+#define UI_TASK_PRIORITY       2
+#define UI_TASK_STACK          8192
+
+#define CAPTURE_EVENT_QUEUE_LENGTH   16
+#define CAPTURE_COMMAND_QUEUE_LENGTH 8
+
+// Capture -> UI
+enum CaptureEventType {
+    CAPTURE_EVENT_IR_SIGNAL = 0,
+    CAPTURE_EVENT_RF_SIGNAL,
+    CAPTURE_EVENT_IBUTTON_KEY
+};
+
+struct CaptureEvent {
+    CaptureEventType type;
+    unsigned long timestamp;
+};
+
+// UI -> capture
+enum CaptureCommandType {
+    CAPTURE_CMD_IR_LEARN_START = 0,
+    CAPTURE_CMD_IR_LEARN_STOP,
+    CAPTURE_CMD_RF_LEARN_START,
+    CAPTURE_CMD_RF_LEARN_STOP,
+    CAPTURE_CMD_IR_GLITCH_FILTER,    // value: minimum pulse in us
+    CAPTURE_CMD_IR_ADAPTIVE,         // value: 1 on, 0 off
+    CAPTURE_CMD_IR_DUMP_HISTORY      // print the IR history to Serial
+};
+
+struct CaptureCommand {
+    CaptureCommandType type;
+    uint32_t value;
+};
+
+class TaskManager {
+public:
+    TaskManager();
+    // commandJob (capture side) and eventJob (UI side) are notified
+    // whenever a message is queued for them
+    bool begin(int commandJob, int eventJob);
+
+    // Called from the sketch's loop()
+    void loop();
+
+    // Queues (non-blocking; false when the queue is full or empty)
+    bool postEvent(const CaptureEvent& event);
+    bool receiveEvent(CaptureEvent* event);
+    bool sendCommand(CaptureCommandType type, uint32_t value = 0);
+    bool receiveCommand(CaptureCommand* command);
+
+    // Statistics
+    uint32_t getDroppedEvents() { return droppedEvents; }
+    uint32_t getDroppedCommands() { return droppedCommands; }
+    bool isRunning() { return running; }
+    
+    // Bytes of stack never touched so far (0 when not available)
+    uint32_t getCaptureStackHighWater();
+    uint32_t getUIStackHighWater();
+
+private:
+    int commandJob;
+    int eventJob;
+    bool running;
+    volatile uint32_t droppedEvents;
+    volatile uint32_t droppedCommands;
+
+    // One pass of the UI task: due jobs, then sleep until the next deadline
+    static void runUI();
+
+#ifdef NATIVE_HAL
+    // Single-threaded stand-ins for the FreeRTOS queues
+    CaptureEvent eventBuffer[CAPTURE_EVENT_QUEUE_LENGTH];
+    uint8_t eventHead;
+    uint8_t eventCount;
+    CaptureCommand commandBuffer[CAPTURE_COMMAND_QUEUE_LENGTH];
+    uint8_t commandHead;
+    uint8_t commandCount;
+#else
+    QueueHandle_t eventQueue;
+    QueueHandle_t commandQueue;
+    TaskHandle_t captureHandle;
+    TaskHandle_t uiHandle;
+
+    static void captureTask(void* arg);
+    static void uiTask(void* arg);
+#endif
+};
+
+extern TaskManager taskManager;
+
+#endif
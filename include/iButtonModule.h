@@ -4,10 +4,14 @@
 #include <Arduino.h>
 #include <OneWire.h>
 #include <ArduinoJson.h>
+#include "Module.h"
 
 // iButton pin definition
 #define IBUTTON_PIN 11
 
+// Key presence poll
+#define IBUTTON_POLL_INTERVAL_MS 500
+
 // iButton family codes
 enum iButtonFamily {
     IBUTTON_UNKNOWN = 0x00,
@@ -33,11 +37,11 @@ struct iButtonKey {
     unsigned long timestamp;
 };
 
-class iButtonModule {
+class iButtonModule : public Module {
 public:
     iButtonModule();
-    bool init();
-    void update();
+    bool init() override;
+    void update() override;
     
     // Scanning functions
     bool scanForKey();
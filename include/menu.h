@@ -35,6 +35,8 @@ enum IRSubMenu {
     IR_SCAN = 0,
     IR_EMULATE,
     IR_HISTORY,
+    IR_UNIVERSAL,
+    IR_ANALYZE,
     IR_BACK,
     IR_SUBMENU_COUNT
 };
@@ -0,0 +1,101 @@
+#include "Adafruit_SSD1306.h"
+#include "NativeHAL.h"
+
+// Largest I2C write the Adafruit driver issues (Wire buffer minus control byte)
+#define SSD1306_WIRE_CHUNK 31
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi ? twi : &Wire), buffer(nullptr), i2caddr(0),
+      wireClkDuring(clkDuring), wireClkAfter(clkAfter), frameCount(0) {
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    delete[] buffer;
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t addr, bool reset, bool periphBegin) {
+    if (!buffer) {
+        buffer = new uint8_t[getBufferSize()];
+    }
+    clearDisplay();
+
+    i2caddr = addr ? addr : 0x3C;
+    if (periphBegin) wire->begin();
+
+    // Init sequence is 25 command bytes on the real part
+    wire->setClock(wireClkDuring);
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    for (int i = 0; i < 25; i++) wire->write((uint8_t)0x00);
+    wire->endTransmission();
+    wire->setClock(wireClkAfter);
+
+    return true;
+}
+
+void Adafruit_SSD1306::display() {
+    if (!buffer) return;
+
+    wire->setClock(wireClkDuring);
+
+    // Page/column address window
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    for (int i = 0; i < 6; i++) wire->write((uint8_t)0x00);
+    wire->endTransmission();
+
+    // Frame buffer in chunks, each with a data control byte
+    size_t remaining = getBufferSize();
+    const uint8_t* ptr = buffer;
+    while (remaining > 0) {
+        size_t chunk = remaining < SSD1306_WIRE_CHUNK ? remaining : SSD1306_WIRE_CHUNK;
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)0x40);
+        wire->write(ptr, chunk);
+        wire->endTransmission();
+        ptr += chunk;
+        remaining -= chunk;
+    }
+
+    wire->setClock(wireClkAfter);
+    frameCount++;
+    nativeHAL.notifyFrame(buffer, getBufferSize());
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    if (buffer) memset(buffer, 0, getBufferSize());
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i) {
+    ssd1306_command(i ? 0xA7 : 0xA6);
+}
+
+void Adafruit_SSD1306::dim(bool dim) {
+    ssd1306_command(0x81);
+    ssd1306_command(dim ? 0x00 : 0xCF);
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    wire->write(c);
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!buffer || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+
+    uint8_t& cell = buffer[x + (y / 8) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+        case SSD1306_WHITE:   cell |= bit; break;
+        case SSD1306_BLACK:   cell &= ~bit; break;
+        case SSD1306_INVERSE: cell ^= bit; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+    if (!buffer || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return false;
+    return (buffer[x + (y / 8) * WIDTH] & (1 << (y & 7))) != 0;
+}
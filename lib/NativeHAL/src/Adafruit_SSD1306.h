@@ -0,0 +1,54 @@
+#ifndef ADAFRUIT_SSD1306_H
+#define ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK   0
+#define SSD1306_WHITE   1
+#define SSD1306_INVERSE 2
+
+#define BLACK   SSD1306_BLACK
+#define WHITE   SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+
+#define SSD1306_EXTERNALVCC  0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+#define SSD1306_DISPLAYOFF   0xAE
+#define SSD1306_DISPLAYON    0xAF
+
+// SSD1306 on I2C. The frame buffer uses the controller's page layout
+// (one byte = 8 vertical pixels), and display() pushes it over Wire with
+// the same transaction sizes as the Adafruit driver, so a flush costs the
+// same virtual time as on the device.
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+               bool reset = true, bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void invertDisplay(bool i);
+    void dim(bool dim);
+    void ssd1306_command(uint8_t c);
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y);
+    uint8_t* getBuffer() { return buffer; }
+    size_t getBufferSize() const { return (size_t)WIDTH * ((HEIGHT + 7) / 8); }
+    uint32_t getFrameCount() const { return frameCount; }
+
+private:
+    TwoWire* wire;
+    uint8_t* buffer;
+    uint8_t i2caddr;
+    uint32_t wireClkDuring;
+    uint32_t wireClkAfter;
+    uint32_t frameCount;
+};
+
+#endif
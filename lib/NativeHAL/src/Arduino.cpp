@@ -0,0 +1,103 @@
+#include "Arduino.h"
+#include "NativeHAL.h"
+
+static unsigned long randomState = 1;
+
+unsigned long millis() {
+    return (unsigned long)(nativeHAL.nowMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)nativeHAL.nowMicros();
+}
+
+void delay(uint32_t ms) {
+    nativeHAL.advanceMicros((uint64_t)ms * 1000);
+    nativeHAL.checkRunLimit();
+}
+
+void delayMicroseconds(uint32_t us) {
+    nativeHAL.advanceMicros(us);
+    nativeHAL.checkRunLimit();
+}
+
+void yield() {
+    nativeHAL.checkRunLimit();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    nativeHAL.configurePin(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    nativeHAL.writePin(pin, val);
+}
+
+int digitalRead(uint8_t pin) {
+    return nativeHAL.readPin(pin);
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return (uint16_t)nativeHAL.readAnalog(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    nativeHAL.attachPinInterrupt(pin, handler, mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    nativeHAL.attachPinInterruptArg(pin, handler, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+    nativeHAL.detachPinInterrupt(pin);
+}
+
+// Interrupt handlers only run while virtual time is being advanced, never
+// concurrently with sketch code, so there is nothing to mask here.
+void interrupts() {
+}
+
+void noInterrupts() {
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+    // The buzzer is fire-and-forget on the device (LEDC keeps running)
+}
+
+void noTone(uint8_t pin) {
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits) {
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+}
+
+void ledcDetachPin(uint8_t pin) {
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    if (inMax == inMin) return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    // Fixed LCG so runs are reproducible
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 16) % (unsigned long)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) randomState = seed;
+}
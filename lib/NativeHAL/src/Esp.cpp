@@ -0,0 +1,49 @@
+#include "Esp.h"
+#include "NativeHAL.h"
+#include <stdlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define NATIVE_FREE_HEAP      (280 * 1024)
+#define NATIVE_MAX_ALLOC_HEAP (110 * 1024)
+
+EspClass ESP;
+
+static uint32_t minFreeHeap = NATIVE_FREE_HEAP;
+
+uint32_t EspClass::getFreeHeap() {
+#ifdef __GLIBC__
+    static size_t baseline = mallinfo2().uordblks;
+    size_t inUse = mallinfo2().uordblks;
+    size_t grown = inUse > baseline ? inUse - baseline : 0;
+    uint32_t freeHeap = grown < NATIVE_FREE_HEAP ? NATIVE_FREE_HEAP - grown : 0;
+#else
+    uint32_t freeHeap = NATIVE_FREE_HEAP;
+#endif
+    if (freeHeap < minFreeHeap) minFreeHeap = freeHeap;
+    return freeHeap;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return minFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    // No fragmentation model; the largest block is capped like the device's
+    uint32_t freeHeap = getFreeHeap();
+    return freeHeap < NATIVE_MAX_ALLOC_HEAP ? freeHeap : NATIVE_MAX_ALLOC_HEAP;
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+    return nativeHAL.getCpuFreqMHz();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(nativeHAL.nowMicros() * nativeHAL.getCpuFreqMHz());
+}
+
+void EspClass::restart() {
+    throw NativeHALStop();
+}
@@ -0,0 +1,23 @@
+#ifndef ESP_H
+#define ESP_H
+
+#include <stdint.h>
+
+// ESP object. The heap starts at nominal ESP32-S3 figures and, on glibc,
+// shrinks by whatever the host process has allocated since the first
+// query, so leaks show up as they would on the device. The cycle counter
+// follows virtual time at the nominal CPU clock.
+class EspClass {
+public:
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getCpuFreqMHz();
+    uint32_t getCycleCount();
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,197 @@
+#include "FS.h"
+#include "SD.h"
+#include "NativeHAL.h"
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+class FileImpl {
+public:
+    FILE* fp = nullptr;
+    bool directory = false;
+    std::string firmwarePath;
+    std::string hostPath;
+    std::vector<std::string> entries;
+    size_t nextEntry = 0;
+    bool writable = false;
+    size_t bytesWritten = 0;
+
+    ~FileImpl() {
+        if (fp) fclose(fp);
+        // Report once per open/close so a writeJsonFile() is one record
+        if (writable) nativeHAL.notifyStorageWrite(firmwarePath.c_str(), bytesWritten);
+    }
+};
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    size_t written = fwrite(buf, 1, size, impl->fp);
+    impl->bytesWritten += written;
+    return written;
+}
+
+int File::available() {
+    if (!impl || !impl->fp) return 0;
+    return (int)(size() - position());
+}
+
+int File::read() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    if (c == EOF) return -1;
+    ungetc(c, impl->fp);
+    return c;
+}
+
+void File::flush() {
+    if (impl && impl->fp) fflush(impl->fp);
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fread(buf, 1, size, impl->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || !impl->fp) return false;
+    int whence = (mode == SeekCur) ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(impl->fp, pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->fp) return 0;
+    long pos = ftell(impl->fp);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!impl || impl->directory) return 0;
+    if (impl->fp) fflush(impl->fp);
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) != 0) return 0;
+    return (size_t)st.st_size;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl && (impl->fp || impl->directory);
+}
+
+const char* File::path() const {
+    return impl ? impl->firmwarePath.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    if (!impl) return nullptr;
+    size_t slash = impl->firmwarePath.rfind('/');
+    return impl->firmwarePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+    return impl && impl->directory;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->directory || impl->nextEntry >= impl->entries.size()) {
+        return File();
+    }
+
+    std::string child = impl->firmwarePath;
+    if (child.empty() || child[child.size() - 1] != '/') child += "/";
+    child += impl->entries[impl->nextEntry++];
+    return SD.open(child.c_str(), mode);
+}
+
+void File::rewindDirectory() {
+    if (impl) impl->nextEntry = 0;
+}
+
+std::string FS::hostPath(const char* path) {
+    std::string out = nativeHAL.getSDRoot();
+    if (!path || path[0] != '/') out += "/";
+    if (path) out += path;
+    while (out.size() > 1 && out[out.size() - 1] == '/') out.erase(out.size() - 1);
+    return out;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    if (!mounted || !path) return File();
+
+    std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+    impl->firmwarePath = path;
+    impl->hostPath = hostPath(path);
+
+    struct stat st;
+    bool exists = stat(impl->hostPath.c_str(), &st) == 0;
+
+    if (exists && S_ISDIR(st.st_mode)) {
+        impl->directory = true;
+        DIR* dir = opendir(impl->hostPath.c_str());
+        if (!dir) return File();
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            impl->entries.push_back(entry->d_name);
+        }
+        closedir(dir);
+        // FAT returns creation order; sort so host runs are reproducible
+        std::sort(impl->entries.begin(), impl->entries.end());
+        return File(impl);
+    }
+
+    if (!exists && strcmp(mode, FILE_READ) == 0) {
+        return File();
+    }
+
+    const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "wb" :
+                           strcmp(mode, FILE_APPEND) == 0 ? "ab" : "rb";
+    impl->fp = fopen(impl->hostPath.c_str(), hostMode);
+    if (!impl->fp) return File();
+    impl->writable = strcmp(mode, FILE_READ) != 0;
+    return File(impl);
+}
+
+bool FS::exists(const char* path) {
+    if (!mounted) return false;
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    if (!mounted) return false;
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    if (!mounted) return false;
+    return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    if (!mounted) return false;
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || exists(path);
+}
+
+bool FS::rmdir(const char* path) {
+    if (!mounted) return false;
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}
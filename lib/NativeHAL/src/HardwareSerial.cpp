@@ -0,0 +1,58 @@
+#include "HardwareSerial.h"
+#include "NativeHAL.h"
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial() : inputPos(0) {
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+}
+
+void HardwareSerial::end() {
+    fflush(stdout);
+}
+
+int HardwareSerial::available() {
+    return (int)(input.size() - inputPos);
+}
+
+int HardwareSerial::read() {
+    if (inputPos >= input.size()) return -1;
+    int c = (unsigned char)input[inputPos++];
+    if (inputPos == input.size()) {
+        input.clear();
+        inputPos = 0;
+    }
+    return c;
+}
+
+int HardwareSerial::peek() {
+    if (inputPos >= input.size()) return -1;
+    return (unsigned char)input[inputPos];
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (nativeHAL.isSerialEchoEnabled() && c != '\r') {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (nativeHAL.isSerialEchoEnabled()) {
+        for (size_t i = 0; i < size; i++) {
+            if (buffer[i] != '\r') fputc(buffer[i], stdout);
+        }
+    }
+    return size;
+}
+
+void HardwareSerial::pushInput(const char* data) {
+    if (data) input += data;
+}
@@ -0,0 +1,33 @@
+#ifndef HARDWARESERIAL_H
+#define HARDWARESERIAL_H
+
+#include <string>
+#include "Stream.h"
+
+// UART0 mapped to the host's stdout. Input can be injected by a simulator
+// with pushInput() and is consumed through the usual Stream API.
+class HardwareSerial : public Stream {
+public:
+    HardwareSerial();
+    void begin(unsigned long baud);
+    void end();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    void pushInput(const char* data);
+    operator bool() const { return true; }
+
+private:
+    std::string input;
+    size_t inputPos;
+};
+
+extern HardwareSerial Serial;
+
+#endif
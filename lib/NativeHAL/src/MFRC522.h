@@ -0,0 +1,77 @@
+#ifndef MFRC522_H
+#define MFRC522_H
+
+#include "Arduino.h"
+
+// MFRC522 reader with an empty field: the chip answers version probes but
+// never sees a card.
+class MFRC522 {
+public:
+    enum PCD_Register : byte {
+        CommandReg = 0x01 << 1,
+        VersionReg = 0x37 << 1
+    };
+
+    enum PICC_Command : byte {
+        PICC_CMD_MF_AUTH_KEY_A = 0x60,
+        PICC_CMD_MF_AUTH_KEY_B = 0x61
+    };
+
+    enum PICC_Type : byte {
+        PICC_TYPE_UNKNOWN,
+        PICC_TYPE_ISO_14443_4,
+        PICC_TYPE_ISO_18092,
+        PICC_TYPE_MIFARE_MINI,
+        PICC_TYPE_MIFARE_1K,
+        PICC_TYPE_MIFARE_4K,
+        PICC_TYPE_MIFARE_UL,
+        PICC_TYPE_MIFARE_PLUS,
+        PICC_TYPE_MIFARE_DESFIRE,
+        PICC_TYPE_TNP3XXX,
+        PICC_TYPE_NOT_COMPLETE = 0xFF
+    };
+
+    enum StatusCode : byte {
+        STATUS_OK,
+        STATUS_ERROR,
+        STATUS_COLLISION,
+        STATUS_TIMEOUT,
+        STATUS_NO_ROOM,
+        STATUS_INTERNAL_ERROR,
+        STATUS_INVALID,
+        STATUS_CRC_WRONG,
+        STATUS_MIFARE_NACK = 0xFF
+    };
+
+    typedef struct {
+        byte size;
+        byte uidByte[10];
+        byte sak;
+    } Uid;
+
+    typedef struct {
+        byte keyByte[6];
+    } MIFARE_Key;
+
+    Uid uid;
+
+    MFRC522(byte chipSelectPin, byte resetPowerDownPin);
+
+    void PCD_Init();
+    byte PCD_ReadRegister(PCD_Register reg);
+    StatusCode PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key* key, Uid* uid);
+    void PCD_StopCrypto1();
+
+    bool PICC_IsNewCardPresent();
+    bool PICC_ReadCardSerial();
+    StatusCode PICC_HaltA();
+    static PICC_Type PICC_GetType(byte sak);
+
+    StatusCode MIFARE_Read(byte blockAddr, byte* buffer, byte* bufferSize);
+
+private:
+    byte chipSelectPin;
+    byte resetPowerDownPin;
+};
+
+#endif
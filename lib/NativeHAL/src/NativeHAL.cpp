@@ -0,0 +1,251 @@
+#include "NativeHAL.h"
+#include "Arduino.h"
+#include <algorithm>
+#include <sys/stat.h>
+#include <time.h>
+
+NativeHAL nativeHAL;
+
+NativeHAL::NativeHAL()
+    : currentMicros(0), runLimitMicros((uint64_t)NATIVE_HAL_DEFAULT_RUN_MS * 1000),
+      eventSequence(0), sdPresent(true), serialEcho(true), observer(nullptr) {
+    for (int i = 0; i < NATIVE_HAL_MAX_PINS; i++) {
+        pins[i].mode = INPUT;
+        pins[i].outputLevel = LOW;
+        pins[i].externalLevel = -1;
+        pins[i].analogValue = 0;
+        pins[i].handler = nullptr;
+        pins[i].argHandler = nullptr;
+        pins[i].handlerArg = nullptr;
+        pins[i].interruptMode = 0;
+    }
+    setSDRoot(NATIVE_HAL_DEFAULT_SD_ROOT);
+}
+
+void NativeHAL::begin(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--sd" && hasValue) {
+            setSDRoot(argv[++i]);
+        } else if (arg == "--no-sd") {
+            sdPresent = false;
+        } else if (arg == "--run-ms" && hasValue) {
+            runLimitMicros = strtoull(argv[++i], NULL, 10) * 1000ULL;
+        } else if (arg == "--quiet") {
+            serialEcho = false;
+        }
+    }
+
+    if (sdPresent) {
+        mkdir(sdRoot, 0755);
+    }
+}
+
+void NativeHAL::end() {
+    fflush(stdout);
+}
+
+void NativeHAL::advanceMicros(uint64_t us) {
+    advanceTo(currentMicros + us);
+}
+
+void NativeHAL::advanceTo(uint64_t us) {
+    // Deliver every event due up to the target, each at its own timestamp
+    while (!events.empty() && events.front().atMicros <= us) {
+        std::pop_heap(events.begin(), events.end(), EventLater());
+        Event event = events.back();
+        events.pop_back();
+
+        if (event.callback && cancelledCallbacks.erase(event.sequence)) {
+            continue;
+        }
+
+        if (event.atMicros > currentMicros) {
+            currentMicros = event.atMicros;
+        }
+        dispatchEvent(event);
+    }
+
+    if (us > currentMicros) {
+        currentMicros = us;
+    }
+}
+
+void NativeHAL::checkRunLimit() {
+    if (isStopRequested()) {
+        throw NativeHALStop();
+    }
+}
+
+void NativeHAL::configurePin(uint8_t pin, uint8_t mode) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].mode = mode;
+}
+
+void NativeHAL::writePin(uint8_t pin, uint8_t level) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].outputLevel = level ? HIGH : LOW;
+}
+
+int NativeHAL::readPin(uint8_t pin) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return LOW;
+
+    const PinState& state = pins[pin];
+    if (state.mode == OUTPUT) {
+        return state.outputLevel;
+    }
+    if (state.externalLevel >= 0) {
+        return state.externalLevel;
+    }
+    return (state.mode == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+int NativeHAL::getOutputLevel(uint8_t pin) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return LOW;
+    return pins[pin].outputLevel;
+}
+
+void NativeHAL::setPinLevel(uint8_t pin, int level) {
+    applyExternalLevel(pin, level ? HIGH : LOW);
+}
+
+void NativeHAL::releasePin(uint8_t pin) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    int before = readPin(pin);
+    pins[pin].externalLevel = -1;
+    int after = readPin(pin);
+    if (before != after) {
+        // Releasing a pulled-up line is an edge like any other
+        pins[pin].externalLevel = before;
+        applyExternalLevel(pin, after);
+        pins[pin].externalLevel = -1;
+    }
+}
+
+void NativeHAL::setAnalogValue(uint8_t pin, int value) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].analogValue = value;
+}
+
+int NativeHAL::readAnalog(uint8_t pin) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return 0;
+    return pins[pin].analogValue;
+}
+
+void NativeHAL::attachPinInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].handler = handler;
+    pins[pin].argHandler = nullptr;
+    pins[pin].handlerArg = nullptr;
+    pins[pin].interruptMode = mode;
+}
+
+void NativeHAL::attachPinInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].handler = nullptr;
+    pins[pin].argHandler = handler;
+    pins[pin].handlerArg = arg;
+    pins[pin].interruptMode = mode;
+}
+
+void NativeHAL::detachPinInterrupt(uint8_t pin) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+    pins[pin].handler = nullptr;
+    pins[pin].argHandler = nullptr;
+    pins[pin].handlerArg = nullptr;
+    pins[pin].interruptMode = 0;
+}
+
+void NativeHAL::schedulePinLevel(uint64_t atMicros, uint8_t pin, int level) {
+    Event event = {atMicros, eventSequence++, pin, level ? HIGH : LOW, nullptr, nullptr};
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end(), EventLater());
+}
+
+uint64_t NativeHAL::scheduleCallback(uint64_t atMicros, void (*callback)(void*), void* arg) {
+    if (!callback) return 0;
+    Event event = {atMicros, eventSequence++, 0, 0, callback, arg};
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end(), EventLater());
+    return event.sequence + 1;
+}
+
+void NativeHAL::cancelCallback(uint64_t id) {
+    // Ids are sequence + 1 so that 0 can mean "none"; the event is skipped when popped
+    if (id > 0) cancelledCallbacks.insert(id - 1);
+}
+
+uint64_t NativeHAL::nextEventMicros() {
+    if (events.empty()) return UINT64_MAX;
+    return events.front().atMicros;
+}
+
+void NativeHAL::setSDRoot(const char* path) {
+    if (!path) return;
+    strncpy(sdRoot, path, sizeof(sdRoot) - 1);
+    sdRoot[sizeof(sdRoot) - 1] = '\0';
+
+    // Strip trailing slashes so "/ir" can be appended directly
+    size_t len = strlen(sdRoot);
+    while (len > 1 && sdRoot[len - 1] == '/') {
+        sdRoot[--len] = '\0';
+    }
+}
+
+uint64_t NativeHAL::hostNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void NativeHAL::notifyLoop(uint64_t startMicros) {
+    if (observer) observer->onLoop(startMicros, currentMicros);
+}
+
+void NativeHAL::notifyFrame(const uint8_t* buffer, size_t size) {
+    if (observer) observer->onFrame(buffer, size);
+}
+
+void NativeHAL::notifyStorageWrite(const char* path, size_t bytes) {
+    if (observer) observer->onStorageWrite(path, bytes);
+}
+
+void NativeHAL::notifyDecode(const char* module, uint32_t edges, bool matched, uint64_t hostNanos) {
+    if (observer) observer->onDecode(module, edges, matched, hostNanos);
+}
+
+void NativeHAL::applyExternalLevel(uint8_t pin, int level) {
+    if (pin >= NATIVE_HAL_MAX_PINS) return;
+
+    int before = readPin(pin);
+    pins[pin].externalLevel = level;
+    int after = readPin(pin);
+
+    PinState& state = pins[pin];
+    if ((!state.handler && !state.argHandler) || before == after) return;
+
+    bool fire = false;
+    switch (state.interruptMode) {
+        case CHANGE:  fire = true; break;
+        case RISING:  fire = (after == HIGH); break;
+        case FALLING: fire = (after == LOW); break;
+        case ONLOW:   fire = (after == LOW); break;
+        case ONHIGH:  fire = (after == HIGH); break;
+        default: break;
+    }
+
+    if (fire) {
+        if (state.handler) state.handler();
+        else state.argHandler(state.handlerArg);
+    }
+}
+
+void NativeHAL::dispatchEvent(const Event& event) {
+    if (event.callback) {
+        event.callback(event.arg);
+    } else {
+        applyExternalLevel(event.pin, event.level);
+    }
+}
@@ -0,0 +1,140 @@
+#ifndef NATIVEHAL_H
+#define NATIVEHAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <set>
+#include <vector>
+
+// Host-side hardware model for the native environment.
+//
+// Time is virtual: it only moves when firmware code calls delay(),
+// delayMicroseconds() or yield(), when a modelled bus transfer takes time
+// (e.g. an SSD1306 flush), or when a simulator calls advanceMicros().
+// Scheduled pin events fire their interrupt handlers at their exact
+// timestamp while time is being advanced, so a run is fully deterministic.
+
+#define NATIVE_HAL_MAX_PINS 64
+#define NATIVE_HAL_DEFAULT_SD_ROOT ".native_sd"
+#define NATIVE_HAL_DEFAULT_RUN_MS 10000
+
+// Thrown from delay()/yield() once the run limit is reached so that
+// blocking firmware loops unwind back to main()
+struct NativeHALStop {};
+
+// Receives notifications from the simulated peripherals and the firmware's
+// native-only hooks. Used by host tooling such as the replay engine.
+class NativeHALObserver {
+public:
+    virtual ~NativeHALObserver() {}
+    virtual void onLoop(uint64_t startMicros, uint64_t endMicros) {}
+    virtual void onFrame(const uint8_t* buffer, size_t size) {}
+    virtual void onStorageWrite(const char* path, size_t bytes) {}
+    virtual void onDecode(const char* module, uint32_t edges, bool matched, uint64_t hostNanos) {}
+};
+
+class NativeHAL {
+public:
+    NativeHAL();
+    void begin(int argc, char** argv);
+    void end();
+
+    // Virtual clock
+    uint64_t nowMicros() { return currentMicros; }
+    void advanceMicros(uint64_t us);
+    void advanceTo(uint64_t us);
+    void setRunLimit(uint64_t us) { runLimitMicros = us; }
+    uint64_t getRunLimit() { return runLimitMicros; }
+    bool isStopRequested() { return currentMicros >= runLimitMicros; }
+    void checkRunLimit();
+
+    // Pin model
+    void configurePin(uint8_t pin, uint8_t mode);
+    void writePin(uint8_t pin, uint8_t level);
+    int readPin(uint8_t pin);
+    int getOutputLevel(uint8_t pin);
+    void setPinLevel(uint8_t pin, int level);
+    void releasePin(uint8_t pin);
+    void setAnalogValue(uint8_t pin, int value);
+    int readAnalog(uint8_t pin);
+    void attachPinInterrupt(uint8_t pin, void (*handler)(void), int mode);
+    void attachPinInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+    void detachPinInterrupt(uint8_t pin);
+
+    // Scheduled events, delivered in timestamp order while time advances
+    void schedulePinLevel(uint64_t atMicros, uint8_t pin, int level);
+    uint64_t scheduleCallback(uint64_t atMicros, void (*callback)(void*), void* arg);
+    void cancelCallback(uint64_t id);
+    uint64_t nextEventMicros();
+    size_t pendingEventCount() { return events.size(); }
+
+    // SD card model (a directory on the host file system)
+    void setSDRoot(const char* path);
+    const char* getSDRoot() { return sdRoot; }
+    void setSDPresent(bool present) { sdPresent = present; }
+    bool isSDPresent() { return sdPresent; }
+
+    // Serial console
+    void setSerialEcho(bool enabled) { serialEcho = enabled; }
+    bool isSerialEchoEnabled() { return serialEcho; }
+
+    // Virtual CPU clock used for ESP.getCycleCount()
+    uint32_t getCpuFreqMHz() { return 240; }
+
+    // Host wall clock, for measuring real work rather than virtual time
+    uint64_t hostNanos();
+
+    // Observer hooks (at most one observer; nullptr to detach)
+    void setObserver(NativeHALObserver* obs) { observer = obs; }
+    void notifyLoop(uint64_t startMicros);
+    void notifyFrame(const uint8_t* buffer, size_t size);
+    void notifyStorageWrite(const char* path, size_t bytes);
+    void notifyDecode(const char* module, uint32_t edges, bool matched, uint64_t hostNanos);
+
+private:
+    struct PinState {
+        uint8_t mode;
+        uint8_t outputLevel;
+        int externalLevel;      // -1 when nothing drives the pin
+        int analogValue;
+        void (*handler)(void);
+        void (*argHandler)(void*);
+        void* handlerArg;
+        int interruptMode;
+    };
+
+    struct Event {
+        uint64_t atMicros;
+        uint64_t sequence;
+        uint8_t pin;
+        int level;
+        void (*callback)(void*);
+        void* arg;
+    };
+
+    struct EventLater {
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.atMicros != b.atMicros) return a.atMicros > b.atMicros;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    uint64_t currentMicros;
+    uint64_t runLimitMicros;
+    uint64_t eventSequence;
+    PinState pins[NATIVE_HAL_MAX_PINS];
+    std::vector<Event> events;
+    std::set<uint64_t> cancelledCallbacks;
+
+    char sdRoot[256];
+    bool sdPresent;
+    bool serialEcho;
+    NativeHALObserver* observer;
+
+    void applyExternalLevel(uint8_t pin, int level);
+    void dispatchEvent(const Event& event);
+};
+
+extern NativeHAL nativeHAL;
+
+#endif
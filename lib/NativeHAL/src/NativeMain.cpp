@@ -0,0 +1,33 @@
+#include "Arduino.h"
+#include "NativeHAL.h"
+#include "Replay.h"
+
+// Host entry point: run the sketch until the virtual run limit is reached.
+//
+//   program [--run-ms N] [--sd DIR] [--no-sd] [--quiet]
+//           [--replay TIMELINE] [--record DIR]
+//
+// Builds that provide their own main() define NATIVE_HAL_NO_MAIN.
+#ifndef NATIVE_HAL_NO_MAIN
+int main(int argc, char** argv) {
+    nativeHAL.begin(argc, argv);
+    if (!replayEngine.begin(argc, argv)) {
+        return 1;
+    }
+
+    try {
+        setup();
+        while (!nativeHAL.isStopRequested()) {
+            uint64_t loopStart = nativeHAL.nowMicros();
+            loop();
+            nativeHAL.notifyLoop(loopStart);
+        }
+    } catch (const NativeHALStop&) {
+        // Run limit reached inside a blocking wait
+    }
+
+    replayEngine.end();
+    nativeHAL.end();
+    return 0;
+}
+#endif
@@ -0,0 +1,80 @@
+#include "OneWire.h"
+
+OneWire::OneWire(uint8_t pin) : pin(pin) {
+    pinMode(pin, INPUT);
+}
+
+uint8_t OneWire::reset() {
+    // 480us reset low + 480us presence window
+    delayMicroseconds(960);
+    return 0;
+}
+
+void OneWire::select(const uint8_t rom[8]) {
+    write(0x55);
+    for (int i = 0; i < 8; i++) write(rom[i]);
+}
+
+void OneWire::skip() {
+    write(0xCC);
+}
+
+void OneWire::write(uint8_t v, uint8_t power) {
+    // 8 slots of ~65us
+    delayMicroseconds(8 * 65);
+}
+
+void OneWire::write_bytes(const uint8_t* buf, uint16_t count, bool power) {
+    for (uint16_t i = 0; i < count; i++) write(buf[i]);
+}
+
+uint8_t OneWire::read() {
+    delayMicroseconds(8 * 65);
+    return 0xFF;
+}
+
+void OneWire::read_bytes(uint8_t* buf, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) buf[i] = read();
+}
+
+void OneWire::depower() {
+}
+
+void OneWire::reset_search() {
+}
+
+bool OneWire::search(uint8_t* newAddr, bool search_mode) {
+    return reset() != 0;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--) {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t OneWire::crc16(const uint8_t* input, uint16_t len, uint16_t crc) {
+    static const uint8_t oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
+
+    for (uint16_t i = 0; i < len; i++) {
+        uint16_t cdata = input[i];
+        cdata = (cdata ^ crc) & 0xff;
+        crc >>= 8;
+
+        if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4]) crc ^= 0xC001;
+
+        cdata <<= 6;
+        crc ^= cdata;
+        cdata <<= 1;
+        crc ^= cdata;
+    }
+    return crc;
+}
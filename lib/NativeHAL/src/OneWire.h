@@ -0,0 +1,31 @@
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#include "Arduino.h"
+
+// 1-Wire bus with no devices attached: resets see no presence pulse and
+// reads float high. The CRC helpers are the real Dallas algorithms.
+class OneWire {
+public:
+    OneWire(uint8_t pin);
+
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t* buf, uint16_t count, bool power = 0);
+    uint8_t read();
+    void read_bytes(uint8_t* buf, uint16_t count);
+    void depower();
+
+    void reset_search();
+    bool search(uint8_t* newAddr, bool search_mode = true);
+
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+    static uint16_t crc16(const uint8_t* input, uint16_t len, uint16_t crc = 0);
+
+private:
+    uint8_t pin;
+};
+
+#endif
@@ -0,0 +1,504 @@
+#include "Replay.h"
+#include "Arduino.h"
+#include <errno.h>
+#include <sys/stat.h>
+
+ReplayEngine replayEngine;
+
+// ---------------------------------------------------------------------------
+// ReplayHistogram
+
+ReplayHistogram::ReplayHistogram()
+    : count(0), sum(0), minValue(UINT64_MAX), maxValue(0) {
+    memset(buckets, 0, sizeof(buckets));
+}
+
+int ReplayHistogram::bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS) return (int)value;
+
+    int exponent = 63 - __builtin_clzll(value);   // >= 4
+    int sub = (int)((value >> (exponent - 4)) & (SUB_BUCKETS - 1));
+    int bucket = SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint64_t ReplayHistogram::bucketLowerBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return (uint64_t)bucket;
+
+    int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 4;
+    int sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((uint64_t)(SUB_BUCKETS + sub)) << (exponent - 4);
+}
+
+void ReplayHistogram::add(uint64_t value) {
+    count++;
+    sum += value;
+    if (value < minValue) minValue = value;
+    if (value > maxValue) maxValue = value;
+    buckets[bucketFor(value)]++;
+}
+
+uint64_t ReplayHistogram::percentile(double p) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)count);
+    if (rank >= count) rank = count - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            uint64_t value = bucketLowerBound(i);
+            return constrain(value, getMin(), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+// ---------------------------------------------------------------------------
+// ReplayEngine
+
+static uint64_t hashFrame(const uint8_t* buffer, size_t size) {
+    // FNV-1a, 64-bit
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= buffer[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+ReplayEngine::ReplayEngine()
+    : active(false), repeatPeriod(0), cycle(0),
+      joyUpPin(REPLAY_DEFAULT_JOY_UP_PIN), joyDownPin(REPLAY_DEFAULT_JOY_DOWN_PIN),
+      joySelectPin(REPLAY_DEFAULT_JOY_SELECT_PIN), irPin(REPLAY_DEFAULT_IR_PIN),
+      rfPin(REPLAY_DEFAULT_RF_PIN), hostStartNanos(0), inputs(0),
+      inputsWithoutChange(0), inputPending(false), inputMicros(0), inputFrameHash(0),
+      frames(0), lastFrameHash(0), storageWrites(0), storageBytes(0),
+      framesLog(nullptr), storageLog(nullptr) {
+}
+
+bool ReplayEngine::begin(int argc, char** argv) {
+    const char* timelinePath = nullptr;
+    const char* recordPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+            timelinePath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        }
+    }
+
+    if (!timelinePath && !recordPath) return true;
+
+    if (timelinePath && !loadTimeline(timelinePath)) return false;
+    if (recordPath && !setRecordDir(recordPath)) return false;
+
+    // Receiver outputs idle before the first event: IR demodulators are
+    // active-low, the sub-GHz receiver's data line is active-high
+    nativeHAL.setPinLevel(irPin, HIGH);
+    nativeHAL.setPinLevel(rfPin, LOW);
+
+    scheduleCycle(0);
+    if (repeatPeriod > 0) {
+        nativeHAL.scheduleCallback(repeatPeriod, repeatCallback, this);
+    }
+
+    active = true;
+    hostStartNanos = nativeHAL.hostNanos();
+    nativeHAL.setObserver(this);
+    return true;
+}
+
+void ReplayEngine::end() {
+    if (!active) return;
+
+    nativeHAL.setObserver(nullptr);
+    printReport(stdout);
+
+    if (!recordDir.empty()) {
+        String reportPath = String(recordDir.c_str()) + "/report.txt";
+        FILE* report = fopen(reportPath.c_str(), "w");
+        if (report) {
+            printReport(report);
+            fclose(report);
+        }
+    }
+
+    if (framesLog) fclose(framesLog);
+    if (storageLog) fclose(storageLog);
+    framesLog = nullptr;
+    storageLog = nullptr;
+    active = false;
+}
+
+bool ReplayEngine::loadTimeline(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "replay: cannot open %s\n", path);
+        return false;
+    }
+
+    timeline.clear();
+    repeatPeriod = 0;
+
+    char line[4096];
+    int lineNumber = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        if (!parseLine(line, lineNumber)) {
+            ok = false;
+            break;
+        }
+    }
+    fclose(file);
+
+    if (ok && repeatPeriod > 0) {
+        for (size_t i = 0; i < timeline.size(); i++) {
+            if (timeline[i].atMicros >= repeatPeriod) {
+                fprintf(stderr, "replay: events past the repeat period would overlap the next cycle\n");
+                return false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+bool ReplayEngine::parsePinName(const char* name, uint8_t* pin) {
+    if (strcmp(name, "up") == 0) *pin = joyUpPin;
+    else if (strcmp(name, "down") == 0) *pin = joyDownPin;
+    else if (strcmp(name, "select") == 0) *pin = joySelectPin;
+    else return false;
+    return true;
+}
+
+bool ReplayEngine::parseLine(char* line, int lineNumber) {
+    char* comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+
+    std::vector<char*> tokens;
+    for (char* token = strtok(line, " \t\r\n"); token; token = strtok(nullptr, " \t\r\n")) {
+        tokens.push_back(token);
+    }
+    if (tokens.empty()) return true;
+
+    // Directives
+    if (strcmp(tokens[0], "repeat") == 0 && tokens.size() == 2) {
+        repeatPeriod = (uint64_t)(atof(tokens[1]) * 1000.0);
+        return true;
+    }
+    if (strcmp(tokens[0], "pin") == 0 && tokens.size() == 3) {
+        uint8_t pin = (uint8_t)strtoul(tokens[2], nullptr, 0);
+        if (strcmp(tokens[1], "up") == 0) joyUpPin = pin;
+        else if (strcmp(tokens[1], "down") == 0) joyDownPin = pin;
+        else if (strcmp(tokens[1], "select") == 0) joySelectPin = pin;
+        else if (strcmp(tokens[1], "ir") == 0) irPin = pin;
+        else if (strcmp(tokens[1], "rf") == 0) rfPin = pin;
+        else {
+            fprintf(stderr, "replay: line %d: unknown pin name '%s'\n", lineNumber, tokens[1]);
+            return false;
+        }
+        return true;
+    }
+
+    if (tokens.size() < 2) {
+        fprintf(stderr, "replay: line %d: expected '<ms> <event> ...'\n", lineNumber);
+        return false;
+    }
+
+    Event event;
+    event.atMicros = (uint64_t)(atof(tokens[0]) * 1000.0);
+    event.pin = 0;
+    event.value = 0;
+    event.activeLevel = HIGH;
+    const char* kind = tokens[1];
+
+    if (strcmp(kind, "joy") == 0 && tokens.size() >= 3) {
+        event.type = EVENT_JOYSTICK;
+        if (!parsePinName(tokens[2], &event.pin)) {
+            fprintf(stderr, "replay: line %d: joystick direction must be up, down or select\n", lineNumber);
+            return false;
+        }
+        double holdMs = tokens.size() >= 4 ? atof(tokens[3]) : REPLAY_DEFAULT_HOLD_MS;
+        event.value = (int)(holdMs * 1000.0);
+    } else if ((strcmp(kind, "ir") == 0 || strcmp(kind, "rf") == 0) && tokens.size() >= 4) {
+        bool ir = strcmp(kind, "ir") == 0;
+        event.type = EVENT_EDGES;
+        event.source = kind;
+        event.pin = ir ? irPin : rfPin;
+        event.activeLevel = ir ? LOW : HIGH;
+
+        if (ir && strcmp(tokens[2], "nec") == 0 && tokens.size() == 5) {
+            uint32_t address = strtoul(tokens[3], nullptr, 0);
+            uint32_t command = strtoul(tokens[4], nullptr, 0);
+            event.durations.push_back(9000);
+            event.durations.push_back(4500);
+            for (int i = 0; i < 32; i++) {
+                uint32_t bit = i < 16 ? (address >> i) & 1 : (command >> (i - 16)) & 1;
+                event.durations.push_back(560);
+                event.durations.push_back(bit ? 1690 : 560);
+            }
+            event.durations.push_back(560);
+        } else if (strcmp(tokens[2], "raw") == 0) {
+            for (size_t i = 3; i < tokens.size(); i++) {
+                event.durations.push_back(strtoul(tokens[i], nullptr, 0));
+            }
+        } else {
+            fprintf(stderr, "replay: line %d: unknown %s event '%s'\n", lineNumber, kind, tokens[2]);
+            return false;
+        }
+    } else if (strcmp(kind, "gpio") == 0 && tokens.size() == 4) {
+        event.pin = (uint8_t)strtoul(tokens[2], nullptr, 0);
+        if (strcmp(tokens[3], "release") == 0) {
+            event.type = EVENT_GPIO_RELEASE;
+        } else {
+            event.type = EVENT_GPIO;
+            event.value = atoi(tokens[3]) ? HIGH : LOW;
+        }
+    } else if (strcmp(kind, "analog") == 0 && tokens.size() == 4) {
+        event.type = EVENT_ANALOG;
+        event.pin = (uint8_t)strtoul(tokens[2], nullptr, 0);
+        event.value = atoi(tokens[3]);
+    } else if (strcmp(kind, "serial") == 0 && tokens.size() >= 3) {
+        event.type = EVENT_SERIAL;
+        for (size_t i = 2; i < tokens.size(); i++) {
+            if (i > 2) event.source += ' ';
+            event.source += tokens[i];
+        }
+        event.source += '\n';
+    } else {
+        fprintf(stderr, "replay: line %d: cannot parse '%s' event\n", lineNumber, kind);
+        return false;
+    }
+
+    if (event.pin >= NATIVE_HAL_MAX_PINS) {
+        fprintf(stderr, "replay: line %d: pin out of range\n", lineNumber);
+        return false;
+    }
+
+    timeline.push_back(event);
+    return true;
+}
+
+bool ReplayEngine::setRecordDir(const char* path) {
+    recordDir = path;
+    while (recordDir.size() > 1 && recordDir[recordDir.size() - 1] == '/') {
+        recordDir.erase(recordDir.size() - 1);
+    }
+
+    std::string framesDir = recordDir + "/frames";
+    if ((mkdir(recordDir.c_str(), 0755) != 0 && errno != EEXIST) ||
+        (mkdir(framesDir.c_str(), 0755) != 0 && errno != EEXIST)) {
+        fprintf(stderr, "replay: cannot create %s\n", recordDir.c_str());
+        return false;
+    }
+
+    framesLog = fopen((recordDir + "/frames.csv").c_str(), "w");
+    storageLog = fopen((recordDir + "/storage.csv").c_str(), "w");
+    if (!framesLog || !storageLog) {
+        fprintf(stderr, "replay: cannot write logs in %s\n", recordDir.c_str());
+        return false;
+    }
+
+    fprintf(framesLog, "time_us,frame,hash,changed\n");
+    fprintf(storageLog, "time_us,path,bytes\n");
+    return true;
+}
+
+void ReplayEngine::scheduleCycle(uint64_t offset) {
+    for (size_t i = 0; i < timeline.size(); i++) {
+        const Event& event = timeline[i];
+        uint64_t at = offset + event.atMicros;
+
+        switch (event.type) {
+            case EVENT_JOYSTICK:
+                // Buttons pull to ground against INPUT_PULLUP
+                nativeHAL.schedulePinLevel(at, event.pin, LOW);
+                nativeHAL.scheduleCallback(at, inputCallback, this);
+                nativeHAL.schedulePinLevel(at + event.value, event.pin, HIGH);
+                break;
+            case EVENT_EDGES:
+                scheduleEdges(offset, event);
+                break;
+            case EVENT_GPIO:
+                nativeHAL.schedulePinLevel(at, event.pin, event.value);
+                break;
+            case EVENT_GPIO_RELEASE:
+            case EVENT_ANALOG:
+            case EVENT_SERIAL:
+                nativeHAL.scheduleCallback(at, eventCallback, (void*)&event);
+                break;
+        }
+    }
+}
+
+void ReplayEngine::scheduleEdges(uint64_t offset, const Event& event) {
+    uint64_t at = offset + event.atMicros;
+    int level = event.activeLevel;
+    int idleLevel = !event.activeLevel;
+    uint64_t edges = 1;
+
+    nativeHAL.schedulePinLevel(at, event.pin, level);
+    for (size_t i = 0; i < event.durations.size(); i++) {
+        at += event.durations[i];
+        level = !level;
+        // A trailing space is just the line staying idle
+        if (i + 1 == event.durations.size() && level != idleLevel) break;
+        nativeHAL.schedulePinLevel(at, event.pin, level);
+        edges++;
+    }
+
+    edgesInjected[event.source] += edges;
+}
+
+void ReplayEngine::inputCallback(void* arg) {
+    ((ReplayEngine*)arg)->markInput();
+}
+
+void ReplayEngine::eventCallback(void* arg) {
+    const Event* event = (const Event*)arg;
+    if (event->type == EVENT_GPIO_RELEASE) {
+        nativeHAL.releasePin(event->pin);
+    } else if (event->type == EVENT_ANALOG) {
+        nativeHAL.setAnalogValue(event->pin, event->value);
+    } else if (event->type == EVENT_SERIAL) {
+        Serial.pushInput(event->source.c_str());
+    }
+}
+
+void ReplayEngine::repeatCallback(void* arg) {
+    ReplayEngine* engine = (ReplayEngine*)arg;
+    engine->cycle++;
+    uint64_t offset = engine->cycle * engine->repeatPeriod;
+    engine->scheduleCycle(offset);
+    nativeHAL.scheduleCallback(offset + engine->repeatPeriod, repeatCallback, engine);
+}
+
+void ReplayEngine::markInput() {
+    if (inputPending) {
+        // The previous input never changed the screen
+        inputsWithoutChange++;
+    }
+    inputs++;
+    inputPending = true;
+    inputMicros = nativeHAL.nowMicros();
+    inputFrameHash = lastFrameHash;
+}
+
+void ReplayEngine::onLoop(uint64_t startMicros, uint64_t endMicros) {
+    loopLatency.add(endMicros - startMicros);
+}
+
+void ReplayEngine::onFrame(const uint8_t* buffer, size_t size) {
+    uint64_t now = nativeHAL.nowMicros();
+    uint64_t hash = hashFrame(buffer, size);
+    bool changed = (frames == 0 || hash != lastFrameHash);
+
+    frames++;
+    lastFrameHash = hash;
+
+    if (inputPending && hash != inputFrameHash) {
+        // display() returns once the last byte is on the bus
+        inputToPixel.add(now - inputMicros);
+        inputPending = false;
+    }
+
+    if (distinctFrames.find(hash) == distinctFrames.end()) {
+        distinctFrames[hash] = true;
+        saveFrame(hash, buffer, size);
+    }
+
+    if (framesLog) {
+        fprintf(framesLog, "%llu,%llu,%016llx,%d\n", (unsigned long long)now,
+                (unsigned long long)frames, (unsigned long long)hash, changed ? 1 : 0);
+    }
+}
+
+void ReplayEngine::saveFrame(uint64_t hash, const uint8_t* buffer, size_t size) {
+    if (recordDir.empty()) return;
+
+    // SSD1306 page layout -> PBM rows; the panel is 128 wide
+    const int width = 128;
+    const int height = (int)(size / width) * 8;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frames/%016llx.pbm", recordDir.c_str(), (unsigned long long)hash);
+    FILE* file = fopen(path, "wb");
+    if (!file) return;
+
+    fprintf(file, "P4\n%d %d\n", width, height);
+    for (int y = 0; y < height; y++) {
+        uint8_t row[width / 8];
+        memset(row, 0, sizeof(row));
+        for (int x = 0; x < width; x++) {
+            if (buffer[x + (y / 8) * width] & (1 << (y & 7))) {
+                row[x / 8] |= 0x80 >> (x & 7);
+            }
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+    fclose(file);
+}
+
+void ReplayEngine::onStorageWrite(const char* path, size_t bytes) {
+    storageWrites++;
+    storageBytes += bytes;
+
+    if (storageLog) {
+        fprintf(storageLog, "%llu,%s,%llu\n", (unsigned long long)nativeHAL.nowMicros(),
+                path, (unsigned long long)bytes);
+    }
+}
+
+void ReplayEngine::onDecode(const char* module, uint32_t edges, bool matched, uint64_t hostNanos) {
+    DecoderStats& stats = decoders[module];
+    stats.decodes++;
+    if (matched) stats.matched++;
+    stats.edges += edges;
+    stats.hostNanos += hostNanos;
+}
+
+void ReplayEngine::printReport(FILE* out) {
+    double simulatedSec = nativeHAL.nowMicros() / 1e6;
+    double hostSec = (nativeHAL.hostNanos() - hostStartNanos) / 1e9;
+
+    fprintf(out, "\n=== Replay report ===\n");
+    fprintf(out, "simulated %.3f s in %.3f s host (%.0fx)\n",
+            simulatedSec, hostSec, hostSec > 0 ? simulatedSec / hostSec : 0.0);
+
+    fprintf(out, "loop latency (us): n=%llu min=%llu mean=%.1f p50=%llu p99=%llu max=%llu\n",
+            (unsigned long long)loopLatency.getCount(), (unsigned long long)loopLatency.getMin(),
+            loopLatency.getMean(), (unsigned long long)loopLatency.percentile(50),
+            (unsigned long long)loopLatency.percentile(99), (unsigned long long)loopLatency.getMax());
+
+    fprintf(out, "input-to-pixel (ms): inputs=%llu no-change=%llu min=%.1f mean=%.1f p99=%.1f max=%.1f\n",
+            (unsigned long long)inputs, (unsigned long long)(inputsWithoutChange + (inputPending ? 1 : 0)),
+            inputToPixel.getMin() / 1000.0, inputToPixel.getMean() / 1000.0,
+            inputToPixel.percentile(99) / 1000.0, inputToPixel.getMax() / 1000.0);
+
+    fprintf(out, "frames: %llu flushed, %u distinct\n",
+            (unsigned long long)frames, (unsigned)distinctFrames.size());
+    fprintf(out, "storage: %llu writes, %llu bytes\n",
+            (unsigned long long)storageWrites, (unsigned long long)storageBytes);
+
+    for (std::map<std::string, uint64_t>::iterator it = edgesInjected.begin(); it != edgesInjected.end(); ++it) {
+        const DecoderStats* stats = nullptr;
+        std::map<std::string, DecoderStats>::iterator found = decoders.find(it->first);
+        if (found != decoders.end()) stats = &found->second;
+
+        uint64_t decodes = stats ? stats->decodes : 0;
+        fprintf(out, "decoder %s: %llu edges injected, %llu captured, %llu decodes (%llu matched)",
+                it->first.c_str(), (unsigned long long)it->second,
+                (unsigned long long)(stats ? stats->edges : 0), (unsigned long long)decodes,
+                (unsigned long long)(stats ? stats->matched : 0));
+        if (stats && decodes > 0 && stats->hostNanos > 0) {
+            fprintf(out, ", %.0f ns/decode, %.1f Medges/s",
+                    (double)stats->hostNanos / decodes, stats->edges * 1000.0 / stats->hostNanos);
+        }
+        fprintf(out, "\n");
+    }
+}
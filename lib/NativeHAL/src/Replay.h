@@ -0,0 +1,162 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "NativeHAL.h"
+
+// Replays a recorded input timeline against setup()/loop() in virtual time
+// and measures what the firmware does with it.
+//
+//   program --replay workload.txt [--record out/] [--run-ms N]
+//
+// Timeline format, one event per line, times in milliseconds from boot:
+//
+//   # comment
+//   1000     joy select [hold_ms]          press a joystick button (default 100 ms)
+//   2500     ir nec 0x00ff 0x0045          NEC frame, as IRModule::transmitNEC sends it
+//   2600     ir raw 9000 4500 560 560 ...  mark/space durations in us
+//   4000     rf raw 400 800 400 ...        high/low durations in us
+//   5000     gpio 10 1                     drive a pin (0, 1 or release)
+//   5000     analog 1 2048                 set an ADC reading
+//   6000     serial prof                   type a line on the serial console
+//   pin ir 7                               override the default wiring
+//   repeat 60000                           replay the whole timeline every 60 s
+//
+// With --record, every flushed frame and every storage write is logged to
+// frames.csv / storage.csv in the given directory, and each distinct frame
+// is saved once as frames/<hash>.pbm.
+
+// Board wiring (Joystick.h, IRModule.h, RFModule.h)
+#define REPLAY_DEFAULT_JOY_UP_PIN     4
+#define REPLAY_DEFAULT_JOY_DOWN_PIN   5
+#define REPLAY_DEFAULT_JOY_SELECT_PIN 6
+#define REPLAY_DEFAULT_IR_PIN         7
+#define REPLAY_DEFAULT_RF_PIN         12
+
+#define REPLAY_DEFAULT_HOLD_MS 100
+
+// Log-linear histogram (16 sub-buckets per power of two, ~6% resolution)
+// so hours of samples fit in a fixed few kilobytes
+class ReplayHistogram {
+public:
+    ReplayHistogram();
+    void add(uint64_t value);
+    uint64_t getCount() const { return count; }
+    uint64_t getMin() const { return count ? minValue : 0; }
+    uint64_t getMax() const { return maxValue; }
+    double getMean() const { return count ? (double)sum / count : 0.0; }
+    uint64_t percentile(double p) const;
+
+private:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = SUB_BUCKETS + 60 * SUB_BUCKETS;
+
+    uint64_t count;
+    uint64_t sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+    uint32_t buckets[BUCKETS];
+
+    static int bucketFor(uint64_t value);
+    static uint64_t bucketLowerBound(int bucket);
+};
+
+class ReplayEngine : public NativeHALObserver {
+public:
+    ReplayEngine();
+
+    // Parses --replay/--record; returns false if the timeline is unusable
+    bool begin(int argc, char** argv);
+    void end();
+    bool isActive() { return active; }
+
+    bool loadTimeline(const char* path);
+    bool setRecordDir(const char* path);
+    void printReport(FILE* out);
+
+    // NativeHALObserver
+    void onLoop(uint64_t startMicros, uint64_t endMicros) override;
+    void onFrame(const uint8_t* buffer, size_t size) override;
+    void onStorageWrite(const char* path, size_t bytes) override;
+    void onDecode(const char* module, uint32_t edges, bool matched, uint64_t hostNanos) override;
+
+private:
+    enum EventType {
+        EVENT_JOYSTICK,
+        EVENT_EDGES,
+        EVENT_GPIO,
+        EVENT_GPIO_RELEASE,
+        EVENT_ANALOG,
+        EVENT_SERIAL
+    };
+
+    struct Event {
+        EventType type;
+        uint64_t atMicros;
+        uint8_t pin;
+        int value;                    // level, analog value or hold time (us)
+        int activeLevel;              // EVENT_EDGES: level during a mark
+        std::string source;           // EVENT_EDGES: "ir" or "rf"; EVENT_SERIAL: the line
+        std::vector<uint32_t> durations;
+    };
+
+    struct DecoderStats {
+        uint64_t decodes;
+        uint64_t matched;
+        uint64_t edges;
+        uint64_t hostNanos;
+    };
+
+    bool active;
+    std::vector<Event> timeline;
+    uint64_t repeatPeriod;
+    uint64_t cycle;
+
+    // Wiring
+    uint8_t joyUpPin;
+    uint8_t joyDownPin;
+    uint8_t joySelectPin;
+    uint8_t irPin;
+    uint8_t rfPin;
+
+    // Measurements
+    uint64_t hostStartNanos;
+    ReplayHistogram loopLatency;
+    ReplayHistogram inputToPixel;
+    uint64_t inputs;
+    uint64_t inputsWithoutChange;
+    bool inputPending;
+    uint64_t inputMicros;
+    uint64_t inputFrameHash;
+    uint64_t frames;
+    uint64_t lastFrameHash;
+    std::map<uint64_t, bool> distinctFrames;
+    uint64_t storageWrites;
+    uint64_t storageBytes;
+    std::map<std::string, uint64_t> edgesInjected;
+    std::map<std::string, DecoderStats> decoders;
+
+    // Recording
+    std::string recordDir;
+    FILE* framesLog;
+    FILE* storageLog;
+
+    bool parseLine(char* line, int lineNumber);
+    bool parsePinName(const char* name, uint8_t* pin);
+    void scheduleCycle(uint64_t offset);
+    void scheduleEdges(uint64_t offset, const Event& event);
+    void markInput();
+    void saveFrame(uint64_t hash, const uint8_t* buffer, size_t size);
+
+    static void inputCallback(void* arg);
+    static void eventCallback(void* arg);
+    static void repeatCallback(void* arg);
+};
+
+extern ReplayEngine replayEngine;
+
+#endif
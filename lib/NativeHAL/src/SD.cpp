@@ -0,0 +1,61 @@
+#include "SD.h"
+#include "NativeHAL.h"
+#include <dirent.h>
+#include <sys/stat.h>
+
+fs::SDFS SD;
+
+// Nominal 8 GB card
+static const uint64_t NATIVE_SD_CARD_SIZE = 8ULL * 1024 * 1024 * 1024;
+
+static uint64_t directoryBytes(const std::string& path) {
+    uint64_t total = 0;
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return 0;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string child = path + "/" + entry->d_name;
+        struct stat st;
+        if (stat(child.c_str(), &st) != 0) continue;
+        total += S_ISDIR(st.st_mode) ? directoryBytes(child) : (uint64_t)st.st_size;
+    }
+    closedir(dir);
+    return total;
+}
+
+namespace fs {
+
+bool SDFS::begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency,
+                 const char* mountpoint, uint8_t maxFiles, bool formatIfEmpty) {
+    if (!nativeHAL.isSDPresent()) {
+        mounted = false;
+        return false;
+    }
+    ::mkdir(nativeHAL.getSDRoot(), 0755);
+    mounted = true;
+    return true;
+}
+
+void SDFS::end() {
+    mounted = false;
+}
+
+sdcard_type_t SDFS::cardType() {
+    return mounted ? CARD_SDHC : CARD_NONE;
+}
+
+uint64_t SDFS::cardSize() {
+    return mounted ? NATIVE_SD_CARD_SIZE : 0;
+}
+
+uint64_t SDFS::totalBytes() {
+    return mounted ? NATIVE_SD_CARD_SIZE : 0;
+}
+
+uint64_t SDFS::usedBytes() {
+    return mounted ? directoryBytes(nativeHAL.getSDRoot()) : 0;
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+// SPI bus with nothing attached: reads return 0xFF like a floating MISO
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings settings) {}
+    void endTransaction() {}
+    void setFrequency(uint32_t freq) {}
+    uint8_t transfer(uint8_t data) { return 0xFF; }
+    void transfer(void* data, uint32_t size) {}
+};
+
+extern SPIClass SPI;
+
+#endif
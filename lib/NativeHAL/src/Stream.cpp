@@ -0,0 +1,32 @@
+#include "Stream.h"
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    String ret;
+    int c = read();
+    while (c >= 0) {
+        ret += (char)c;
+        c = read();
+    }
+    return ret;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String ret;
+    int c = read();
+    while (c >= 0 && c != terminator) {
+        ret += (char)c;
+        c = read();
+    }
+    return ret;
+}
@@ -0,0 +1,293 @@
+#include "WString.h"
+#include <ctype.h>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    if (value == 0) return "0";
+
+    char digits[65];
+    int pos = 64;
+    digits[pos] = '\0';
+    while (value > 0 && pos > 0) {
+        unsigned int digit = value % base;
+        digits[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    }
+    return std::string(&digits[pos]);
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+    if (base == 10 && value < 0) {
+        return "-" + formatUnsigned((unsigned long long)(-(value + 1)) + 1, base);
+    }
+    // Arduino prints negative numbers in other bases as two's complement
+    return formatUnsigned((unsigned long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces) {
+    if (std::isnan(value)) return "nan";
+    if (std::isinf(value)) return "inf";
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    return std::string(buf);
+}
+
+String::String(const char* cstr) : buffer(cstr ? cstr : "") {
+}
+
+String::String(char c) : buffer(1, c) {
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(formatUnsigned(value, base)) {
+}
+
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(formatUnsigned(value, base)) {
+}
+
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(formatUnsigned(value, base)) {
+}
+
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {
+}
+
+String::String(unsigned long long value, unsigned char base) : buffer(formatUnsigned(value, base)) {
+}
+
+String::String(float value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {
+}
+
+String::String(double value, unsigned int decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {
+}
+
+String& String::operator=(const char* cstr) {
+    buffer = cstr ? cstr : "";
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    buffer.reserve(size);
+    return true;
+}
+
+bool String::concat(const String& str) {
+    buffer += str.buffer;
+    return true;
+}
+
+bool String::concat(const char* cstr) {
+    if (!cstr) return false;
+    buffer += cstr;
+    return true;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+    if (!cstr) return false;
+    buffer.append(cstr, length);
+    return true;
+}
+
+bool String::concat(char c) {
+    buffer += c;
+    return true;
+}
+
+bool String::concat(unsigned char num) { buffer += formatUnsigned(num, 10); return true; }
+bool String::concat(int num) { buffer += formatSigned(num, 10); return true; }
+bool String::concat(unsigned int num) { buffer += formatUnsigned(num, 10); return true; }
+bool String::concat(long num) { buffer += formatSigned(num, 10); return true; }
+bool String::concat(unsigned long num) { buffer += formatUnsigned(num, 10); return true; }
+bool String::concat(long long num) { buffer += formatSigned(num, 10); return true; }
+bool String::concat(unsigned long long num) { buffer += formatUnsigned(num, 10); return true; }
+bool String::concat(float num) { buffer += formatFloat(num, 2); return true; }
+bool String::concat(double num) { buffer += formatFloat(num, 2); return true; }
+
+int String::compareTo(const String& s) const {
+    return buffer.compare(s.buffer);
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    if (buffer.size() != s.buffer.size()) return false;
+    for (size_t i = 0; i < buffer.size(); i++) {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return buffer.compare(0, prefix.buffer.size(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.buffer.size() > buffer.size()) return false;
+    return buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < buffer.size() ? buffer[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if (index < buffer.size()) buffer[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= buffer.size()) {
+        dummy = '\0';
+        return dummy;
+    }
+    return buffer[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!buf || bufsize == 0) return;
+    if (index >= buffer.size()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = std::min((size_t)bufsize - 1, buffer.size() - index);
+    memcpy(buf, buffer.data() + index, n);
+    buf[n] = 0;
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+    getBytes((unsigned char*)buf, bufsize, index);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    size_t pos = buffer.find(ch, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+    size_t pos = buffer.find(str.buffer, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const {
+    size_t pos = buffer.rfind(ch);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+    size_t pos = buffer.rfind(ch, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+    size_t pos = buffer.rfind(str.buffer);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+    if (beginIndex >= buffer.size()) return String();
+    if (endIndex > buffer.size()) endIndex = buffer.size();
+
+    String out;
+    out.buffer.assign(buffer, beginIndex, endIndex - beginIndex);
+    return out;
+}
+
+void String::replace(char find, char replacement) {
+    for (size_t i = 0; i < buffer.size(); i++) {
+        if (buffer[i] == find) buffer[i] = replacement;
+    }
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.buffer.empty()) return;
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.size(), replacement.buffer);
+        pos += replacement.buffer.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < buffer.size()) buffer.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < buffer.size()) buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = (char)tolower((unsigned char)buffer[i]);
+    }
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < buffer.size(); i++) {
+        buffer[i] = (char)toupper((unsigned char)buffer[i]);
+    }
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < buffer.size() && isspace((unsigned char)buffer[begin])) begin++;
+    size_t end = buffer.size();
+    while (end > begin && isspace((unsigned char)buffer[end - 1])) end--;
+    buffer = buffer.substr(begin, end - begin);
+}
+
+long String::toInt() const {
+    return atol(buffer.c_str());
+}
+
+float String::toFloat() const {
+    return (float)atof(buffer.c_str());
+}
+
+double String::toDouble() const {
+    return atof(buffer.c_str());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const String& lhs, char rhs) {
+    String out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+String operator+(const String& lhs, int rhs) { String out(lhs); out.concat(rhs); return out; }
+String operator+(const String& lhs, unsigned int rhs) { String out(lhs); out.concat(rhs); return out; }
+String operator+(const String& lhs, long rhs) { String out(lhs); out.concat(rhs); return out; }
+String operator+(const String& lhs, unsigned long rhs) { String out(lhs); out.concat(rhs); return out; }
+String operator+(const String& lhs, float rhs) { String out(lhs); out.concat(rhs); return out; }
+String operator+(const String& lhs, double rhs) { String out(lhs); out.concat(rhs); return out; }
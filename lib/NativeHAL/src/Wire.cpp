@@ -0,0 +1,49 @@
+#include "Wire.h"
+#include "NativeHAL.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : clockHz(100000), pendingBytes(0), bytesTransferred(0) {
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    if (frequency) clockHz = frequency;
+    return true;
+}
+
+bool TwoWire::end() {
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    if (frequency) clockHz = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+    // Address byte
+    pendingBytes = 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    // 9 clocks per byte (8 data + ACK) plus start/stop overhead
+    uint64_t bits = (uint64_t)pendingBytes * 9 + 2;
+    nativeHAL.advanceMicros((bits * 1000000ULL + clockHz - 1) / clockHz);
+    bytesTransferred += pendingBytes;
+    pendingBytes = 0;
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint16_t address, uint8_t size, bool sendStop) {
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    pendingBytes++;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+    pendingBytes += quantity;
+    return quantity;
+}
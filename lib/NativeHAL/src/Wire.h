@@ -0,0 +1,37 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "Stream.h"
+
+// I2C bus. Transfers cost virtual time at the configured clock so that
+// display flushes show up in loop timing as they do on the device.
+class TwoWire : public Stream {
+public:
+    TwoWire();
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() { return clockHz; }
+
+    void beginTransmission(uint16_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop = true);
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t quantity) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    uint64_t getBytesTransferred() { return bytesTransferred; }
+
+private:
+    uint32_t clockHz;
+    size_t pendingBytes;
+    uint64_t bytesTransferred;
+};
+
+extern TwoWire Wire;
+
+#endif
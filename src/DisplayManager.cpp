@@ -1,25 +1,26 @@
 #include "DisplayManager.h"
 #include "logo.h"
+#include "Profiler.h"
 
 DisplayManager displayManager;
 
 DisplayManager::DisplayManager() 
-    : display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET),
-      displayInitialized(false), lastUpdate(0) {
+    : oled(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET),
+      displayInitialized(false), poweredOn(true), lastUpdate(0) {
 }
 
 bool DisplayManager::init() {
     Wire.begin();
     
-    if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
+    if (!oled.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
         Serial.println("SSD1306 allocation failed");
         return false;
     }
     
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.setCursor(0, 0);
+    oled.clearDisplay();
+    oled.setTextSize(1);
+    oled.setTextColor(SSD1306_WHITE);
+    oled.setCursor(0, 0);
     
     displayInitialized = true;
     Serial.println("Display initialized");
@@ -29,20 +30,30 @@ bool DisplayManager::init() {
 
 void DisplayManager::clear() {
     if (!displayInitialized) return;
-    display.clearDisplay();
+    oled.clearDisplay();
 }
 
 void DisplayManager::display() {
-    if (!displayInitialized) return;
-    display.display();
+    if (!displayInitialized || !poweredOn) return;
+    PROFILE_SCOPE(PROBE_DISPLAY_FLUSH);
+    oled.display();
     lastUpdate = millis();
 }
 
+void DisplayManager::setPower(bool on) {
+    if (!displayInitialized || on == poweredOn) return;
+    
+    // The controller keeps its RAM while off, so the panel comes back with
+    // the last frame until the next flush
+    oled.ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    poweredOn = on;
+}
+
 void DisplayManager::drawStatusBar() {
     if (!displayInitialized) return;
     
     // Draw status bar background
-    display.drawLine(0, STATUS_BAR_HEIGHT, SCREEN_WIDTH, STATUS_BAR_HEIGHT, SSD1306_WHITE);
+    oled.drawLine(0, STATUS_BAR_HEIGHT, SCREEN_WIDTH, STATUS_BAR_HEIGHT, SSD1306_WHITE);
     
     // Draw battery (right side)
     drawBattery(85); // Mock battery level
@@ -62,13 +73,13 @@ void DisplayManager::drawBattery(int percentage) {
     int y = 2;
     
     // Battery outline
-    display.drawRect(x, y, 16, 6, SSD1306_WHITE);
-    display.drawRect(x + 16, y + 1, 2, 4, SSD1306_WHITE);
+    oled.drawRect(x, y, 16, 6, SSD1306_WHITE);
+    oled.drawRect(x + 16, y + 1, 2, 4, SSD1306_WHITE);
     
     // Battery fill
     int fillWidth = (14 * percentage) / 100;
     if (fillWidth > 0) {
-        display.fillRect(x + 1, y + 1, fillWidth, 4, SSD1306_WHITE);
+        oled.fillRect(x + 1, y + 1, fillWidth, 4, SSD1306_WHITE);
     }
 }
 
@@ -84,8 +95,8 @@ void DisplayManager::drawTime() {
     int textWidth = strlen(timeStr) * 6;
     int x = (SCREEN_WIDTH - textWidth) / 2;
     
-    display.setCursor(x, 1);
-    display.print(timeStr);
+    oled.setCursor(x, 1);
+    oled.print(timeStr);
 }
 
 void DisplayManager::drawWiFiStatus(bool connected) {
@@ -94,13 +105,13 @@ void DisplayManager::drawWiFiStatus(bool connected) {
     
     if (connected) {
         // WiFi connected icon
-        display.drawLine(x, y + 5, x + 2, y + 3, SSD1306_WHITE);
-        display.drawLine(x + 2, y + 3, x + 4, y + 5, SSD1306_WHITE);
-        display.drawLine(x + 1, y + 4, x + 3, y + 2, SSD1306_WHITE);
+        oled.drawLine(x, y + 5, x + 2, y + 3, SSD1306_WHITE);
+        oled.drawLine(x + 2, y + 3, x + 4, y + 5, SSD1306_WHITE);
+        oled.drawLine(x + 1, y + 4, x + 3, y + 2, SSD1306_WHITE);
     } else {
         // WiFi disconnected icon
-        display.drawLine(x, y + 5, x + 4, y + 1, SSD1306_WHITE);
-        display.drawLine(x, y + 1, x + 4, y + 5, SSD1306_WHITE);
+        oled.drawLine(x, y + 5, x + 4, y + 1, SSD1306_WHITE);
+        oled.drawLine(x, y + 1, x + 4, y + 5, SSD1306_WHITE);
     }
 }
 
@@ -109,13 +120,13 @@ void DisplayManager::drawSDStatus(bool inserted) {
     int y = 2;
     
     // SD card outline
-    display.drawRect(x, y, 8, 6, SSD1306_WHITE);
-    display.drawLine(x + 6, y, x + 8, y + 2, SSD1306_WHITE);
-    display.drawLine(x + 8, y + 2, x + 8, y + 6, SSD1306_WHITE);
+    oled.drawRect(x, y, 8, 6, SSD1306_WHITE);
+    oled.drawLine(x + 6, y, x + 8, y + 2, SSD1306_WHITE);
+    oled.drawLine(x + 8, y + 2, x + 8, y + 6, SSD1306_WHITE);
     
     if (inserted) {
         // Fill when inserted
-        display.fillRect(x + 1, y + 1, 5, 4, SSD1306_WHITE);
+        oled.fillRect(x + 1, y + 1, 5, 4, SSD1306_WHITE);
     }
 }
 
@@ -139,19 +150,19 @@ void DisplayManager::drawMenu(const char* items[], int count, int selected) {
         
         // Highlight selected item
         if (itemIndex == selected) {
-            display.fillRect(0, y, SCREEN_WIDTH, itemHeight - 1, SSD1306_WHITE);
-            display.setTextColor(SSD1306_BLACK);
+            oled.fillRect(0, y, SCREEN_WIDTH, itemHeight - 1, SSD1306_WHITE);
+            oled.setTextColor(SSD1306_BLACK);
         } else {
-            display.setTextColor(SSD1306_WHITE);
+            oled.setTextColor(SSD1306_WHITE);
         }
         
-        display.setCursor(5, y + 1);
-        display.print(items[itemIndex]);
+        oled.setCursor(5, y + 1);
+        oled.print(items[itemIndex]);
         
         // Draw selection arrow
         if (itemIndex == selected) {
-            display.setCursor(1, y + 1);
-            display.print(">");
+            oled.setCursor(1, y + 1);
+            oled.print(">");
         }
     }
     
@@ -160,16 +171,16 @@ void DisplayManager::drawMenu(const char* items[], int count, int selected) {
         drawScrollbar(count, visibleItems, scrollOffset);
     }
     
-    display.setTextColor(SSD1306_WHITE); // Reset text color
+    oled.setTextColor(SSD1306_WHITE); // Reset text color
 }
 
 void DisplayManager::drawSubmenu(const char* title, const char* items[], int count, int selected) {
     if (!displayInitialized) return;
     
     // Draw title
-    display.setCursor(5, MENU_AREA_Y);
-    display.print(title);
-    display.drawLine(0, MENU_AREA_Y + 10, SCREEN_WIDTH, MENU_AREA_Y + 10, SSD1306_WHITE);
+    oled.setCursor(5, MENU_AREA_Y);
+    oled.print(title);
+    oled.drawLine(0, MENU_AREA_Y + 10, SCREEN_WIDTH, MENU_AREA_Y + 10, SSD1306_WHITE);
     
     // Draw menu items below title
     int startY = MENU_AREA_Y + 15;
@@ -181,38 +192,38 @@ void DisplayManager::drawSubmenu(const char* title, const char* items[], int cou
         
         // Highlight selected item
         if (i == selected) {
-            display.fillRect(0, y, SCREEN_WIDTH, itemHeight - 1, SSD1306_WHITE);
-            display.setTextColor(SSD1306_BLACK);
+            oled.fillRect(0, y, SCREEN_WIDTH, itemHeight - 1, SSD1306_WHITE);
+            oled.setTextColor(SSD1306_BLACK);
         } else {
-            display.setTextColor(SSD1306_WHITE);
+            oled.setTextColor(SSD1306_WHITE);
         }
         
-        display.setCursor(5, y + 1);
-        display.print(items[i]);
+        oled.setCursor(5, y + 1);
+        oled.print(items[i]);
         
         // Draw selection arrow
         if (i == selected) {
-            display.setCursor(1, y + 1);
-            display.print(">");
+            oled.setCursor(1, y + 1);
+            oled.print(">");
         }
     }
     
-    display.setTextColor(SSD1306_WHITE); // Reset text color
+    oled.setTextColor(SSD1306_WHITE); // Reset text color
 }
 
 void DisplayManager::drawModuleScreen(const char* title, const char* content) {
     if (!displayInitialized) return;
     
     // Draw title bar
-    display.fillRect(0, MENU_AREA_Y, SCREEN_WIDTH, 12, SSD1306_WHITE);
-    display.setTextColor(SSD1306_BLACK);
-    display.setCursor(5, MENU_AREA_Y + 2);
-    display.print(title);
+    oled.fillRect(0, MENU_AREA_Y, SCREEN_WIDTH, 12, SSD1306_WHITE);
+    oled.setTextColor(SSD1306_BLACK);
+    oled.setCursor(5, MENU_AREA_Y + 2);
+    oled.print(title);
     
     // Draw content
-    display.setTextColor(SSD1306_WHITE);
-    display.setCursor(5, MENU_AREA_Y + 20);
-    display.print(content);
+    oled.setTextColor(SSD1306_WHITE);
+    oled.setCursor(5, MENU_AREA_Y + 20);
+    oled.print(content);
 }
 
 void DisplayManager::drawProgressBar(int percentage) {
@@ -224,20 +235,52 @@ void DisplayManager::drawProgressBar(int percentage) {
     int y = SCREEN_HEIGHT - 20;
     
     // Draw progress bar outline
-    display.drawRect(x, y, barWidth, barHeight, SSD1306_WHITE);
+    oled.drawRect(x, y, barWidth, barHeight, SSD1306_WHITE);
     
     // Draw progress fill
     int fillWidth = (barWidth - 2) * percentage / 100;
     if (fillWidth > 0) {
-        display.fillRect(x + 1, y + 1, fillWidth, barHeight - 2, SSD1306_WHITE);
+        oled.fillRect(x + 1, y + 1, fillWidth, barHeight - 2, SSD1306_WHITE);
     }
     
     // Draw percentage text
     char percentStr[5];
     sprintf(percentStr, "%d%%", percentage);
     int textWidth = strlen(percentStr) * 6;
-    display.setCursor((SCREEN_WIDTH - textWidth) / 2, y - 12);
-    display.print(percentStr);
+    oled.setCursor((SCREEN_WIDTH - textWidth) / 2, y - 12);
+    oled.print(percentStr);
+}
+
+// Two-sided bar chart: up[] above an axis across the middle, down[]
+// below it, each scaled to its own largest count. Any count shows as at
+// least one pixel.
+void DisplayManager::drawHistogram(int x, int y, int width, int height,
+                                   const uint16_t* up, const uint16_t* down, int bins) {
+    if (!displayInitialized || bins <= 0) return;
+    
+    uint32_t upMax = 1, downMax = 1;
+    for (int i = 0; i < bins; i++) {
+        if (up[i] > upMax) upMax = up[i];
+        if (down[i] > downMax) downMax = down[i];
+    }
+    
+    int axis = y + height / 2;
+    int reach = height / 2 - 1;
+    int column = width / bins;
+    int barWidth = column > 1 ? column - 1 : 1;
+    oled.drawFastHLine(x, axis, width, SSD1306_WHITE);
+    
+    for (int i = 0; i < bins; i++) {
+        int columnX = x + i * column;
+        int upHeight = (up[i] * reach + upMax - 1) / upMax;
+        int downHeight = (down[i] * reach + downMax - 1) / downMax;
+        if (upHeight > 0) {
+            oled.fillRect(columnX, axis - upHeight, barWidth, upHeight, SSD1306_WHITE);
+        }
+        if (downHeight > 0) {
+            oled.fillRect(columnX, axis + 1, barWidth, downHeight, SSD1306_WHITE);
+        }
+    }
 }
 
 void DisplayManager::drawScrollText(const char* text, int x, int y, int maxWidth) {
@@ -248,8 +291,8 @@ void DisplayManager::drawScrollText(const char* text, int x, int y, int maxWidth
     
     if (textWidth <= maxWidth) {
         // Text fits, draw normally
-        display.setCursor(x, y);
-        display.print(text);
+        oled.setCursor(x, y);
+        oled.print(text);
     } else {
         // Text is too long, implement scrolling
         static unsigned long lastScrollTime = 0;
@@ -263,46 +306,38 @@ void DisplayManager::drawScrollText(const char* text, int x, int y, int maxWidth
             lastScrollTime = millis();
         }
         
-        display.setCursor(x - (scrollOffset * 6), y);
-        display.print(text);
+        oled.setCursor(x - (scrollOffset * 6), y);
+        oled.print(text);
     }
 }
 
-void DisplayManager::showBootAnimation() {
-    if (!displayInitialized) return;
+bool DisplayManager::drawBootFrame(int frame) {
+    if (!displayInitialized || frame < 0 || frame >= BOOT_ANIMATION_FRAMES) return false;
     
-    // Clear display
-    display.clearDisplay();
+    oled.clearDisplay();
     
-    // Draw wolf logo with animation
-    for (int frame = 0; frame < 10; frame++) {
-        display.clearDisplay();
-        
-        // Draw logo centered
+    if (frame == BOOT_ANIMATION_FRAMES - 1) {
+        // Show "FlipperS3" text
+        drawCenteredText("FlipperS3", 25);
+        drawCenteredText("v1.0", 40);
+    } else {
+        // Draw wolf logo centered
         int logoX = (SCREEN_WIDTH - LOGO_WIDTH) / 2;
         int logoY = (SCREEN_HEIGHT - LOGO_HEIGHT) / 2;
         
-        display.drawBitmap(logoX, logoY, wolf_logo_bitmap, LOGO_WIDTH, LOGO_HEIGHT, SSD1306_WHITE);
+        oled.drawBitmap(logoX, logoY, wolf_logo_bitmap, LOGO_WIDTH, LOGO_HEIGHT, SSD1306_WHITE);
         
-        // Add fade effect or animation
+        // Growing effect
         if (frame < 5) {
-            // Growing effect
             int size = (frame + 1) * LOGO_HEIGHT / 5;
             int offsetY = (LOGO_HEIGHT - size) / 2;
-            display.fillRect(logoX, logoY + offsetY + size, LOGO_WIDTH, offsetY, SSD1306_BLACK);
-            display.fillRect(logoX, logoY, LOGO_WIDTH, offsetY, SSD1306_BLACK);
+            oled.fillRect(logoX, logoY + offsetY + size, LOGO_WIDTH, offsetY, SSD1306_BLACK);
+            oled.fillRect(logoX, logoY, LOGO_WIDTH, offsetY, SSD1306_BLACK);
         }
-        
-        display.display();
-        delay(200);
     }
     
-    // Show "FlipperS3" text
-    display.clearDisplay();
-    drawCenteredText("FlipperS3", 25);
-    drawCenteredText("v1.0", 40);
-    display.display();
-    delay(1500);
+    display();
+    return true;
 }
 
 void DisplayManager::drawLogo() {
@@ -311,7 +346,7 @@ void DisplayManager::drawLogo() {
     int logoX = (SCREEN_WIDTH - LOGO_WIDTH) / 2;
     int logoY = (SCREEN_HEIGHT - LOGO_HEIGHT) / 2;
     
-    display.drawBitmap(logoX, logoY, wolf_logo_bitmap, LOGO_WIDTH, LOGO_HEIGHT, SSD1306_WHITE);
+    oled.drawBitmap(logoX, logoY, wolf_logo_bitmap, LOGO_WIDTH, LOGO_HEIGHT, SSD1306_WHITE);
 }
 
 void DisplayManager::drawCenteredText(const char* text, int y) {
@@ -320,21 +355,21 @@ void DisplayManager::drawCenteredText(const char* text, int y) {
     int textWidth = strlen(text) * 6; // Assuming 6 pixels per character
     int x = (SCREEN_WIDTH - textWidth) / 2;
     
-    display.setCursor(x, y);
-    display.print(text);
+    oled.setCursor(x, y);
+    oled.print(text);
 }
 
 void DisplayManager::drawIcon(int x, int y, const char* icon) {
     if (!displayInitialized) return;
     
-    display.setCursor(x, y);
-    display.print(icon);
+    oled.setCursor(x, y);
+    oled.print(icon);
 }
 
 void DisplayManager::drawFrame(int x, int y, int width, int height) {
     if (!displayInitialized) return;
     
-    display.drawRect(x, y, width, height, SSD1306_WHITE);
+    oled.drawRect(x, y, width, height, SSD1306_WHITE);
 }
 
 void DisplayManager::drawScrollbar(int totalItems, int visibleItems, int scrollPosition) {
@@ -345,7 +380,7 @@ void DisplayManager::drawScrollbar(int totalItems, int visibleItems, int scrollP
     int scrollbarHeight = MENU_AREA_HEIGHT;
     
     // Draw scrollbar track
-    display.drawLine(scrollbarX, scrollbarY, scrollbarX, scrollbarY + scrollbarHeight, SSD1306_WHITE);
+    oled.drawLine(scrollbarX, scrollbarY, scrollbarX, scrollbarY + scrollbarHeight, SSD1306_WHITE);
     
     // Calculate thumb size and position
     int thumbHeight = (scrollbarHeight * visibleItems) / totalItems;
@@ -354,5 +389,5 @@ void DisplayManager::drawScrollbar(int totalItems, int visibleItems, int scrollP
     int thumbPosition = (scrollbarHeight - thumbHeight) * scrollPosition / (totalItems - visibleItems);
     
     // Draw scrollbar thumb
-    display.fillRect(scrollbarX - 1, scrollbarY + thumbPosition, 3, thumbHeight, SSD1306_WHITE);
+    oled.fillRect(scrollbarX - 1, scrollbarY + thumbPosition, 3, thumbHeight, SSD1306_WHITE);
 }
@@ -4,7 +4,7 @@
 GPIOModule gpioModule;
 
 GPIOModule::GPIOModule() 
-    : gpioInitialized(false), configuredPinCount(0), analyzing(false),
+    : Module(MODULE_GPIO, "gpio"), gpioInitialized(false), configuredPinCount(0), analyzing(false),
       scenarioRunning(false), scenarioStartTime(0), changeCount(0), changeIndex(0) {
 }
 
@@ -0,0 +1,145 @@
+#include "IRAnalyzer.h"
+
+static const char* ENCODING_PULSE_DISTANCE = "Pulse distance";
+static const char* ENCODING_PULSE_WIDTH = "Pulse width";
+static const char* ENCODING_BIPHASE = "Biphase";
+static const char* ENCODING_UNKNOWN = "Unknown";
+
+IRAnalyzer::IRAnalyzer() : sequence(0) {
+    reset();
+}
+
+void IRAnalyzer::reset() {
+    beginWrite();
+    memset(&state, 0, sizeof(state));
+    state.protocol = nullptr;
+    endWrite();
+}
+
+void IRAnalyzer::beginWrite() {
+    __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void IRAnalyzer::endWrite() {
+    __atomic_store_n(&sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+void IRAnalyzer::read(IRAnalysis* out) {
+    uint32_t before, after;
+    do {
+        before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+        memcpy(out, &state, sizeof(state));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+}
+
+uint8_t IRAnalyzer::binOf(uint32_t us) {
+    if (us < IR_ANALYZER_MIN_US) return 0;
+
+    // Octave and its quarter from the top three bits
+    int octave = 31 - __builtin_clz(us);
+    int quarter = (us >> (octave - 2)) & 3;
+    int bin = (octave - 7) * 4 + quarter;
+    return bin < IR_ANALYZER_BINS ? bin : IR_ANALYZER_BINS - 1;
+}
+
+void IRAnalyzer::beginFrame() {
+    beginWrite();
+    for (int i = 0; i < IR_ANALYZER_BINS; i++) {
+        state.marks[i] >>= 1;
+        state.spaces[i] >>= 1;
+    }
+    endWrite();
+}
+
+void IRAnalyzer::addDuration(uint32_t us, bool mark) {
+    uint16_t& count = (mark ? state.marks : state.spaces)[binOf(us)];
+    if (count == UINT16_MAX) return;
+
+    beginWrite();
+    count++;
+    endWrite();
+}
+
+void IRAnalyzer::frameDecoded(const IRDecodeResult& result, uint16_t durations) {
+    beginWrite();
+    state.frames++;
+    state.protocol = result.timing->name;
+    state.bits = result.bits;
+    state.repeat = result.repeat;
+    state.durations = durations;
+    endWrite();
+}
+
+void IRAnalyzer::frameRaw(const uint16_t* durations, uint16_t count) {
+    uint8_t bits;
+    const char* encoding = guessEncoding(durations, count, &bits);
+
+    beginWrite();
+    state.frames++;
+    state.protocol = encoding;
+    state.bits = bits;
+    state.repeat = false;
+    state.durations = count;
+    endWrite();
+}
+
+void IRAnalyzer::setCarrier(uint32_t hz, uint8_t dutyPercent) {
+    beginWrite();
+    state.carrierHz = hz;
+    state.dutyPercent = dutyPercent;
+    endWrite();
+}
+
+const char* IRAnalyzer::guessEncoding(const uint16_t* durations, uint16_t count, uint8_t* bits) {
+    *bits = 0;
+    if (!durations || count < 4) return ENCODING_UNKNOWN;
+    uint16_t length = count - 1;   // the gap is not part of the code
+
+    uint16_t shortestMark = UINT16_MAX;
+    for (uint16_t i = 2; i < length; i += 2) {
+        if (durations[i] < shortestMark) shortestMark = durations[i];
+    }
+
+    // A leading mark three times the shortest one is a header
+    uint16_t first = (uint32_t)durations[0] >= (uint32_t)shortestMark * 3 ? 2 : 0;
+
+    uint16_t shortest[2] = {UINT16_MAX, UINT16_MAX};
+    uint16_t longest[2] = {0, 0};
+    uint16_t levelCount[2] = {0, 0};
+    for (uint16_t i = first; i < length; i++) {
+        int level = i & 1;
+        if (durations[i] < shortest[level]) shortest[level] = durations[i];
+        if (durations[i] > longest[level]) longest[level] = durations[i];
+        levelCount[level]++;
+    }
+    if (levelCount[0] == 0 || levelCount[1] == 0) return ENCODING_UNKNOWN;
+
+    bool marksVary = (uint32_t)longest[0] * 2 > (uint32_t)shortest[0] * 3;
+    bool spacesVary = (uint32_t)longest[1] * 2 > (uint32_t)shortest[1] * 3;
+
+    if (spacesVary && !marksVary) {
+        *bits = min(levelCount[1], (uint16_t)255);
+        return ENCODING_PULSE_DISTANCE;
+    }
+    if (marksVary && !spacesVary) {
+        *bits = min(levelCount[0], (uint16_t)255);
+        return ENCODING_PULSE_WIDTH;
+    }
+
+    // Every duration one or two half-bits
+    bool halvesOnly = (uint32_t)longest[0] * 2 <= (uint32_t)shortest[0] * 5 &&
+                      (uint32_t)longest[1] * 2 <= (uint32_t)shortest[1] * 5;
+    if (marksVary && spacesVary && halvesOnly) {
+        uint32_t half = min(shortest[0], shortest[1]);
+        uint32_t halves = 0;
+        for (uint16_t i = first; i < length; i++) {
+            halves += (durations[i] + half / 2) / half;
+        }
+        *bits = min((halves + 1) / 2, (uint32_t)255);
+        return ENCODING_BIPHASE;
+    }
+    return ENCODING_UNKNOWN;
+}
@@ -0,0 +1,163 @@
+#include "IRCarrier.h"
+
+#define IR_CARRIER_MAX_PERIODS (IR_CARRIER_MAX_EDGES / 2)
+
+#ifdef NATIVE_HAL
+static IRCarrierMeter* carrierInstance = nullptr;
+#endif
+
+IRCarrierMeter::IRCarrierMeter()
+    : carrierPin(0), started(false), capturing(false), count(0), armed(false) {
+}
+
+bool IRCarrierMeter::begin(uint8_t pin) {
+    if (started) return true;
+    carrierPin = pin;
+    // Held inactive if the sensor is missing or unpowered
+    pinMode(carrierPin, INPUT_PULLDOWN);
+
+#ifdef NATIVE_HAL
+    carrierInstance = this;
+#else
+    if (mcpwm_gpio_init(MCPWM_UNIT_1, MCPWM_CAP_0, carrierPin) != ESP_OK) {
+        return false;
+    }
+#endif
+
+    started = true;
+    return true;
+}
+
+void IRCarrierMeter::start() {
+    if (!started || capturing) return;
+
+#ifdef NATIVE_HAL
+    attachInterrupt(digitalPinToInterrupt(carrierPin), pinChanged, CHANGE);
+#else
+    mcpwm_capture_config_t config = {};
+    config.cap_edge = MCPWM_BOTH_EDGE;
+    config.cap_prescale = 1;
+    config.capture_cb = captured;
+    config.user_data = this;
+    if (mcpwm_capture_enable_channel(MCPWM_UNIT_1, MCPWM_SELECT_CAP0, &config) != ESP_OK) {
+        return;
+    }
+#endif
+
+    capturing = true;
+    arm();
+}
+
+void IRCarrierMeter::stop() {
+    if (!capturing) return;
+    armed = false;
+
+#ifdef NATIVE_HAL
+    detachInterrupt(digitalPinToInterrupt(carrierPin));
+#else
+    mcpwm_capture_disable_channel(MCPWM_UNIT_1, MCPWM_SELECT_CAP0);
+#endif
+    capturing = false;
+}
+
+void IRCarrierMeter::arm() {
+    armed = false;
+    count = 0;
+    armed = capturing;
+}
+
+// Capture interrupt; once the buffer is full it only returns
+void IRAM_ATTR IRCarrierMeter::record(uint32_t tick, uint8_t level) {
+    uint16_t index = count;
+    if (!armed || index >= IR_CARRIER_MAX_EDGES) return;
+
+    ticks[index] = tick;
+    levels[index] = level;
+    __atomic_store_n(&count, (uint16_t)(index + 1), __ATOMIC_RELEASE);
+}
+
+#ifdef NATIVE_HAL
+void IRCarrierMeter::pinChanged() {
+    if (carrierInstance) {
+        carrierInstance->record(micros(), digitalRead(carrierInstance->carrierPin));
+    }
+}
+#else
+bool IRAM_ATTR IRCarrierMeter::captured(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel,
+                                        const cap_event_data_t* event, void* arg) {
+    IRCarrierMeter* meter = (IRCarrierMeter*)arg;
+    meter->record(event->cap_value, event->cap_edge == MCPWM_POS_EDGE ? HIGH : LOW);
+    return false;
+}
+#endif
+
+bool IRCarrierMeter::measure(IRCarrierEstimate* result) {
+    uint16_t edges = __atomic_load_n(&count, __ATOMIC_ACQUIRE);
+    return estimate(ticks, levels, edges, IR_CARRIER_TICK_HZ, result);
+}
+
+bool IRCarrierMeter::estimate(const uint32_t* ticks, const uint8_t* levels, uint16_t count,
+                              uint32_t tickHz, IRCarrierEstimate* result) {
+    if (!ticks || !levels || !result) return false;
+
+    uint32_t shortest = tickHz / IR_CARRIER_MAX_HZ;
+    uint32_t longest = tickHz / IR_CARRIER_MIN_HZ;
+
+    // Period and active time from each active edge to the next one
+    uint32_t periods[IR_CARRIER_MAX_PERIODS];
+    uint32_t active[IR_CARRIER_MAX_PERIODS];
+    uint16_t found = 0;
+    int last = -1;
+    for (uint16_t i = 0; i < count && found < IR_CARRIER_MAX_PERIODS; i++) {
+        if (levels[i] != IR_CARRIER_ACTIVE_LEVEL) continue;
+
+        if (last >= 0) {
+            uint32_t period = ticks[i] - ticks[last];
+            bool inactiveBetween = i - last == 2 && levels[last + 1] != IR_CARRIER_ACTIVE_LEVEL;
+            if (inactiveBetween && period >= shortest && period <= longest) {
+                periods[found] = period;
+                active[found] = ticks[last + 1] - ticks[last];
+                found++;
+            }
+        }
+        last = i;
+    }
+    if (found < IR_CARRIER_MIN_PERIODS) return false;
+
+    // Median by insertion sort of a copy; at most a few thousand steps
+    uint32_t sorted[IR_CARRIER_MAX_PERIODS];
+    for (uint16_t i = 0; i < found; i++) {
+        uint32_t value = periods[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    uint32_t median = sorted[found / 2];
+
+    uint64_t periodSum = 0;
+    uint64_t activeSum = 0;
+    uint16_t used = 0;
+    for (uint16_t i = 0; i < found; i++) {
+        uint32_t difference = periods[i] > median ? periods[i] - median : median - periods[i];
+        if (difference * 8 > median) continue;
+        periodSum += periods[i];
+        activeSum += active[i];
+        used++;
+    }
+    if (used < IR_CARRIER_MIN_PERIODS) return false;
+
+    uint32_t frequency = (uint32_t)(((uint64_t)tickHz * used + periodSum / 2) / periodSum);
+    uint32_t duty = (uint32_t)((activeSum * 100 + periodSum / 2) / periodSum);
+    if (frequency < IR_CARRIER_MIN_HZ || frequency > IR_CARRIER_MAX_HZ ||
+        duty < IR_CARRIER_MIN_DUTY || duty > IR_CARRIER_MAX_DUTY) {
+        return false;
+    }
+
+    result->frequency = frequency;
+    result->dutyPercent = (uint8_t)duty;
+    result->periods = used;
+    return true;
+}
@@ -0,0 +1,326 @@
+#include "IRDecoder.h"
+
+static_assert(IR_PROTOCOL_TABLE_SIZE <= IR_MAX_CANDIDATES, "too many IR protocol rows");
+
+IRDecoder::IRDecoder() : adaptive(true) {
+    reset();
+}
+
+void IRDecoder::reset() {
+    // Timing variants are never stepped
+    for (uint32_t rows = irDecodedRows; rows; rows &= rows - 1) {
+        int i = __builtin_ctz(rows);
+        const IRProtocolTiming& timing = irProtocols[i];
+        Candidate& c = candidates[i];
+        c.phase = timing.headerMark ? PHASE_HEADER_MARK : PHASE_BIT_MARK;
+        c.bitCount = 0;
+        c.repeat = false;
+        c.data = 0;
+        c.scale = 0;
+
+        // RC5 starts with a space half-bit nobody can see
+        bool idleHalf = timing.encoding == IR_BIPHASE && (timing.flags & IR_LEADING_HALF_IDLE);
+        c.halves = idleHalf ? 1 : 0;
+        c.firstHalf = 0;
+    }
+    aliveMask = irDecodedRows;
+    doneMask = 0;
+    started = false;
+}
+
+bool IRDecoder::feed(uint32_t duration, bool mark) {
+    // Silence before the first mark belongs to no frame
+    if (!started) {
+        if (!mark) return false;
+        started = true;
+        leaderMark = duration;
+    }
+
+    uint32_t mask = aliveMask;
+    while (mask) {
+        int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        Candidate& c = candidates[i];
+        bool wasDone = c.phase == PHASE_DONE;
+        if (!step(irProtocols[i], c, duration, mark)) {
+            aliveMask &= ~(1UL << i);
+            doneMask &= ~(1UL << i);
+        } else if (!wasDone && c.phase == PHASE_DONE) {
+            doneMask |= 1UL << i;
+        }
+    }
+
+    // Report as soon as nothing still in progress could claim the frame.
+    // Once every row is out, the rest of the frame is ignored until finish().
+    if (doneMask && (aliveMask & ~doneMask) == 0) {
+        return emit(__builtin_ctz(doneMask));
+    }
+    return false;
+}
+
+bool IRDecoder::settle(uint32_t quietUs) {
+    if (!doneMask) return false;
+
+    uint32_t mask = aliveMask;
+    while (mask) {
+        int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+        if (!isGap(irProtocols[i], quietUs)) return false;
+    }
+    return emit(__builtin_ctz(doneMask));
+}
+
+uint32_t IRDecoder::getSettleTime() {
+    if (!doneMask) return 0;
+
+    uint32_t longest = 0;
+    uint32_t mask = aliveMask;
+    while (mask) {
+        int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+        const IRProtocolTiming& timing = irProtocols[i];
+        uint32_t space = longestSpace(timing);
+        space += space * timing.tolerance / 100 + 1;
+        if (space > longest) longest = space;
+    }
+    return longest;
+}
+
+bool IRDecoder::finish() {
+    bool found = doneMask && emit(__builtin_ctz(doneMask));
+    if (!found) reset();
+    return found;
+}
+
+bool IRDecoder::decode(const uint16_t* durations, uint16_t count, IRDecodeResult* out) {
+    reset();
+    for (uint16_t i = 0; i < count; i++) {
+        if (feed(durations[i], i % 2 == 0)) {
+            if (out) *out = result;
+            return true;
+        }
+    }
+    if (finish()) {
+        if (out) *out = result;
+        return true;
+    }
+    return false;
+}
+
+bool IRDecoder::emit(int index) {
+    const Candidate& c = candidates[index];
+    for (int variant = index + 1; !c.repeat && variant < IR_PROTOCOL_TABLE_SIZE &&
+                                  (irProtocols[variant].flags & IR_TIMING_VARIANT); variant++) {
+        if (irCheckData(irProtocols[variant], c.data)) {
+            index = variant;
+            break;
+        }
+    }
+    const IRProtocolTiming& timing = irProtocols[index];
+
+    result.timing = &timing;
+    result.protocol = timing.protocol;
+    result.data = c.data;
+    result.bits = c.repeat ? 0 : timing.bits;
+    result.repeat = c.repeat;
+
+    result.address = (c.data >> timing.addressShift) & irBitMask(timing.addressBits);
+    result.command = (c.data >> timing.commandShift) & irBitMask(timing.commandBits);
+    if (!c.repeat && (timing.flags & IR_FIELD_BIT) && !((c.data >> (timing.bits - 2)) & 1)) {
+        result.command |= 1UL << timing.commandBits;
+    }
+
+    reset();
+    return true;
+}
+
+bool IRDecoder::matches(uint32_t measured, uint32_t expected, uint8_t tolerance) {
+    if (expected == 0) return false;
+    uint32_t slack = expected * tolerance / 100;
+    return measured + slack >= expected && measured <= expected + slack;
+}
+
+uint32_t IRDecoder::longestSpace(const IRProtocolTiming& timing) {
+    uint32_t longest;
+    if (timing.encoding == IR_BIPHASE) {
+        // Two half-bits, each twice as long for the double-width bit
+        longest = timing.oneMark * (timing.doubleBit != IR_NO_DOUBLE_BIT ? 4 : 2);
+    } else {
+        longest = timing.oneSpace > timing.zeroSpace ? timing.oneSpace : timing.zeroSpace;
+    }
+    if (timing.headerSpace > longest) longest = timing.headerSpace;
+    if (timing.repeatSpace > longest) longest = timing.repeatSpace;
+    return longest;
+}
+
+// A space too long to occur inside a frame of this protocol
+bool IRDecoder::isGap(const IRProtocolTiming& timing, uint32_t space) {
+    uint32_t longest = longestSpace(timing);
+    return space > longest + longest * timing.tolerance / 100;
+}
+
+// The leader is matched: scale and stretch for the rest of the frame
+void IRDecoder::learnLeader(const IRProtocolTiming& timing, Candidate& c, uint32_t space, uint32_t nominalSpace) {
+    if (!adaptive) return;
+
+    uint32_t nominal = timing.headerMark + nominalSpace;
+    c.scale = (nominal << IR_SCALE_SHIFT) / (leaderMark + space);
+
+    // Only as much stretch as the tolerance would have let through anyway
+    uint16_t shortest = timing.zeroMark && timing.zeroMark < timing.oneMark ? timing.zeroMark : timing.oneMark;
+    int32_t limit = shortest * timing.tolerance / 100;
+    int32_t stretch = (int32_t)((leaderMark * c.scale) >> IR_SCALE_SHIFT) - timing.headerMark;
+    if (stretch > limit) stretch = limit;
+    if (stretch < -limit) stretch = -limit;
+    c.stretch = stretch;
+}
+
+inline uint32_t IRDecoder::correct(const Candidate& c, uint32_t duration, bool mark) {
+    // Gaps are left alone (and cannot overflow the product)
+    if (duration > UINT16_MAX) return duration;
+
+    int32_t scaled = (duration * c.scale) >> IR_SCALE_SHIFT;
+    scaled += mark ? -c.stretch : c.stretch;
+    return scaled > 0 ? scaled : 0;
+}
+
+bool IRDecoder::step(const IRProtocolTiming& timing, Candidate& c, uint32_t duration, bool mark) {
+    uint8_t tol = timing.tolerance;
+
+    // Complete rows only survive the silence after the frame
+    if (c.phase == PHASE_DONE) {
+        return !mark && isGap(timing, duration);
+    }
+
+    // Past the leader: measured against it
+    if (c.scale) {
+        duration = correct(c, duration, mark);
+    }
+
+    switch (c.phase) {
+        case PHASE_HEADER_MARK:
+            if (!mark || !matches(duration, timing.headerMark, tol)) return false;
+            c.phase = PHASE_HEADER_SPACE;
+            return true;
+
+        case PHASE_HEADER_SPACE:
+            if (mark) return false;
+            if (matches(duration, timing.headerSpace, tol)) {
+                learnLeader(timing, c, duration, timing.headerSpace);
+                c.phase = PHASE_BIT_MARK;
+                return true;
+            }
+            if (timing.repeatSpace && matches(duration, timing.repeatSpace, tol)) {
+                learnLeader(timing, c, duration, timing.repeatSpace);
+                c.phase = PHASE_REPEAT_STOP;
+                return true;
+            }
+            return false;
+
+        case PHASE_REPEAT_STOP:
+            if (!mark || !matches(duration, timing.stopMark, tol)) return false;
+            c.repeat = true;
+            c.phase = PHASE_DONE;
+            return true;
+
+        case PHASE_STOP_MARK:
+            if (!mark || !matches(duration, timing.stopMark, tol)) return false;
+            return complete(timing, c);
+
+        default:
+            break;
+    }
+
+    // Data bits
+    switch (timing.encoding) {
+        case IR_PULSE_DISTANCE:
+            if (c.phase == PHASE_BIT_MARK) {
+                if (!mark || !matches(duration, timing.oneMark, tol)) return false;
+                c.phase = PHASE_BIT_SPACE;
+                return true;
+            }
+            if (mark) return false;
+            if (matches(duration, timing.oneSpace, tol)) return addBit(timing, c, 1);
+            if (matches(duration, timing.zeroSpace, tol)) return addBit(timing, c, 0);
+            return false;
+
+        case IR_PULSE_WIDTH:
+            if (c.phase == PHASE_BIT_SPACE) {
+                if (mark || !matches(duration, timing.oneSpace, tol)) return false;
+                c.phase = PHASE_BIT_MARK;
+                return true;
+            }
+            if (!mark) return false;
+            if (matches(duration, timing.oneMark, tol)) return addBit(timing, c, 1);
+            if (matches(duration, timing.zeroMark, tol)) return addBit(timing, c, 0);
+            return false;
+
+        case IR_BIPHASE:
+            return stepBiphase(timing, c, duration, mark);
+    }
+    return false;
+}
+
+// A duration covers one or two half-bits (the double-width bit counts
+// double), possibly straddling a bit boundary
+bool IRDecoder::stepBiphase(const IRProtocolTiming& timing, Candidate& c, uint32_t duration, bool mark) {
+    uint8_t level = mark ? 1 : 0;
+    uint32_t remaining = duration;
+
+    while (remaining > 0) {
+        // Anything left after the last bit would extend the frame
+        if (c.phase == PHASE_DONE) return false;
+
+        uint32_t half = timing.oneMark * (c.bitCount == timing.doubleBit ? 2 : 1);
+        uint32_t slack = half * timing.tolerance / 100;
+        if (remaining + slack < half) return false;
+
+        if (c.halves == 0) {
+            c.firstHalf = level;
+            c.halves = 1;
+
+            // The last bit is settled by its first half: the second one has
+            // the other level, and its end merges into the silence
+            if (c.bitCount == timing.bits - 1 && level == 1) {
+                c.halves = 0;
+                if (!addBit(timing, c, (timing.flags & IR_ONE_SPACE_FIRST) ? 0 : 1)) return false;
+            }
+        } else {
+            if (c.firstHalf == level) return false;
+            c.halves = 0;
+            bool one = (timing.flags & IR_ONE_SPACE_FIRST) ? c.firstHalf == 0 : c.firstHalf == 1;
+            if (!addBit(timing, c, one ? 1 : 0)) return false;
+        }
+
+        remaining = remaining > half ? remaining - half : 0;
+        if (remaining <= slack) remaining = 0;
+    }
+    return true;
+}
+
+bool IRDecoder::addBit(const IRProtocolTiming& timing, Candidate& c, uint8_t bit) {
+    if (timing.flags & IR_MSB_FIRST) {
+        c.data = (c.data << 1) | bit;
+    } else {
+        c.data |= (uint32_t)bit << c.bitCount;
+    }
+    c.bitCount++;
+
+    if (c.bitCount < timing.bits) {
+        // Pulse width: the fixed space follows; the others start a new bit
+        c.phase = timing.encoding == IR_PULSE_WIDTH ? PHASE_BIT_SPACE : PHASE_BIT_MARK;
+        return true;
+    }
+    if (timing.stopMark) {
+        c.phase = PHASE_STOP_MARK;
+        return true;
+    }
+    return complete(timing, c);
+}
+
+bool IRDecoder::complete(const IRProtocolTiming& timing, Candidate& c) {
+    if (!irCheckData(timing, c.data)) return false;
+    c.phase = PHASE_DONE;
+    return true;
+}
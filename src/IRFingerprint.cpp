@@ -0,0 +1,264 @@
+#include "IRFingerprint.h"
+#include "StorageManager.h"
+
+IRFingerprintIndex irFingerprints;
+
+static const uint8_t IR_FINGERPRINT_MAGIC[3] = {'I', 'R', 'f'};
+
+#define IR_FINGERPRINT_HEADER_SIZE  8
+#define IR_FINGERPRINT_ENTRY_SIZE   72   // length, histogram, shape, label, 6 spare
+#define IR_FINGERPRINT_LOAD_CHUNK   8    // entries per SD read at boot, or write on a rebuild
+
+static_assert(2 + IR_FINGERPRINT_BINS * 2 + IR_FINGERPRINT_SHAPE_BITS / 8 + IR_FINGERPRINT_LABEL_SIZE <=
+              IR_FINGERPRINT_ENTRY_SIZE,
+              "IR fingerprint entry does not fit its record");
+
+// Upper bin edges in microseconds. They sit between the usual protocol
+// timings (444, 560/600, 889, 1200, 1690, 2250-2666, 4500, 9000) so
+// receiver jitter rarely moves a duration to the next bin.
+static const uint16_t binEdges[IR_FINGERPRINT_BINS - 1] = {
+    350, 700, 1000, 1400, 2000, 3000, 4000, 6000, 8000, 12000, 20000
+};
+
+static uint8_t binOf(uint16_t duration) {
+    uint8_t bin = 0;
+    while (bin < IR_FINGERPRINT_BINS - 1 && duration >= binEdges[bin]) {
+        bin++;
+    }
+    return bin;
+}
+
+IRFingerprintIndex::IRFingerprintIndex() : count(0), generation(0) {}
+
+void IRFingerprintIndex::compute(const uint16_t* durations, uint16_t total, IRFingerprint* fingerprint) {
+    uint16_t length = total > 0 ? total - 1 : 0;
+    uint16_t counts[2][IR_FINGERPRINT_BINS] = {{0}};
+    uint16_t shortest[2] = {UINT16_MAX, UINT16_MAX};
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t level = i & 1;
+        counts[level][binOf(durations[i])]++;
+        if (durations[i] < shortest[level]) shortest[level] = durations[i];
+    }
+
+    // Long means half again the typical short duration of its level, taken
+    // as the mean of those near the shortest so one low outlier can't move it
+    uint32_t threshold[2];
+    for (int level = 0; level < 2; level++) {
+        uint32_t sum = 0, n = 0;
+        for (uint16_t i = level; i < length; i += 2) {
+            if ((uint32_t)durations[i] * 2 < (uint32_t)shortest[level] * 3) {
+                sum += durations[i];
+                n++;
+            }
+        }
+        threshold[level] = n ? sum * 3 / (n * 2) : UINT32_MAX;
+    }
+
+    fingerprint->length = length;
+    memset(fingerprint->shape, 0, sizeof(fingerprint->shape));
+    for (uint16_t i = 0; i < length && i < IR_FINGERPRINT_SHAPE_BITS; i++) {
+        if (durations[i] > threshold[i & 1]) {
+            fingerprint->shape[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    for (int level = 0; level < 2; level++) {
+        uint32_t levelTotal = 0;
+        for (int bin = 0; bin < IR_FINGERPRINT_BINS; bin++) {
+            levelTotal += counts[level][bin];
+        }
+        for (int bin = 0; bin < IR_FINGERPRINT_BINS; bin++) {
+            fingerprint->histogram[level * IR_FINGERPRINT_BINS + bin] =
+                levelTotal ? (counts[level][bin] * 255 + levelTotal / 2) / levelTotal : 0;
+        }
+    }
+}
+
+uint16_t IRFingerprintIndex::distance(const IRFingerprint& a, const IRFingerprint& b) {
+    uint16_t sum = 0;
+    for (int i = 0; i < IR_FINGERPRINT_BINS * 2; i++) {
+        sum += a.histogram[i] > b.histogram[i] ? a.histogram[i] - b.histogram[i]
+                                               : b.histogram[i] - a.histogram[i];
+    }
+    return sum;
+}
+
+int IRFingerprintIndex::find(const IRFingerprint& fingerprint, char* label) {
+    uint32_t startGeneration = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    int entryCount = getCount();
+    int best = -1;
+    uint32_t bestScore = UINT32_MAX;
+
+    for (int i = 0; i < entryCount; i++) {
+        const IRFingerprint& candidate = entries[i].fingerprint;
+
+        // Cheapest checks first: the frame length (1/8 slack), the shape,
+        // which rejects other buttons of the same remote, then the histogram
+        uint16_t slack = candidate.length / 8 + 1;
+        if (fingerprint.length + slack < candidate.length || fingerprint.length > candidate.length + slack) {
+            continue;
+        }
+
+        int hamming = 0;
+        for (int k = 0; k < IR_FINGERPRINT_SHAPE_BITS / 8 && hamming <= IR_FINGERPRINT_MAX_HAMMING; k++) {
+            hamming += __builtin_popcount(candidate.shape[k] ^ fingerprint.shape[k]);
+        }
+        if (hamming > IR_FINGERPRINT_MAX_HAMMING) continue;
+
+        uint16_t histogramDistance = distance(candidate, fingerprint);
+        if (histogramDistance > IR_FINGERPRINT_MAX_DISTANCE) continue;
+
+        uint32_t score = histogramDistance + hamming * (IR_FINGERPRINT_MAX_DISTANCE / IR_FINGERPRINT_MAX_HAMMING);
+        if (score < bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+
+    if (best >= 0 && label) {
+        memcpy(label, entries[best].label, IR_FINGERPRINT_LABEL_SIZE);
+    }
+
+    // Rebuilt meanwhile: entries may have been overwritten under the search
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&generation, __ATOMIC_RELAXED) != startGeneration) {
+        return -1;
+    }
+    return best;
+}
+
+const char* IRFingerprintIndex::getLabel(int index) {
+    if (index < 0 || index >= getCount()) return "";
+    return entries[index].label;
+}
+
+bool IRFingerprintIndex::add(const IRFingerprint& fingerprint, const String& label, bool persist) {
+    int entryCount = getCount();
+    for (int i = 0; i < entryCount; i++) {
+        if (strncmp(entries[i].label, label.c_str(), IR_FINGERPRINT_LABEL_SIZE - 1) == 0 &&
+            memcmp(entries[i].fingerprint.shape, fingerprint.shape, sizeof(fingerprint.shape)) == 0 &&
+            distance(entries[i].fingerprint, fingerprint) == 0) {
+            return true;
+        }
+    }
+    if (entryCount >= IR_FINGERPRINT_MAX_ENTRIES) {
+        Serial.println("IR fingerprint index full, not indexed: " + label);
+        return false;
+    }
+
+    Entry& entry = entries[entryCount];
+    entry.fingerprint = fingerprint;
+    memset(entry.label, 0, sizeof(entry.label));
+    strncpy(entry.label, label.c_str(), IR_FINGERPRINT_LABEL_SIZE - 1);
+    __atomic_store_n(&count, (uint16_t)(entryCount + 1), __ATOMIC_RELEASE);
+    if (!persist) return true;
+
+    if (!storageManager.fileExists(IR_FINGERPRINT_FILE)) {
+        uint8_t header[IR_FINGERPRINT_HEADER_SIZE];
+        writeHeader(header);
+        if (!storageManager.writeBinaryFile(IR_FINGERPRINT_FILE, header, sizeof(header))) {
+            return false;
+        }
+    }
+
+    uint8_t record[IR_FINGERPRINT_ENTRY_SIZE];
+    serialize(entry, record);
+    return storageManager.appendBinaryFile(IR_FINGERPRINT_FILE, record, sizeof(record));
+}
+
+void IRFingerprintIndex::clear() {
+    __atomic_store_n(&count, (uint16_t)0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+bool IRFingerprintIndex::save() {
+    uint8_t header[IR_FINGERPRINT_HEADER_SIZE];
+    writeHeader(header);
+    if (!storageManager.writeBinaryFile(IR_FINGERPRINT_FILE, header, sizeof(header))) {
+        return false;
+    }
+
+    int entryCount = getCount();
+    uint8_t chunk[IR_FINGERPRINT_LOAD_CHUNK * IR_FINGERPRINT_ENTRY_SIZE];
+    for (int saved = 0; saved < entryCount;) {
+        int batch = min(IR_FINGERPRINT_LOAD_CHUNK, entryCount - saved);
+        for (int i = 0; i < batch; i++) {
+            serialize(entries[saved + i], chunk + i * IR_FINGERPRINT_ENTRY_SIZE);
+        }
+        if (!storageManager.appendBinaryFile(IR_FINGERPRINT_FILE, chunk, batch * IR_FINGERPRINT_ENTRY_SIZE)) {
+            return false;
+        }
+        saved += batch;
+    }
+    return true;
+}
+
+bool IRFingerprintIndex::load() {
+    count = 0;
+
+    if (!storageManager.fileExists(IR_FINGERPRINT_FILE)) return false;
+
+    uint8_t header[IR_FINGERPRINT_HEADER_SIZE];
+    if (!storageManager.readBinaryAt(IR_FINGERPRINT_FILE, 0, header, sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header, IR_FINGERPRINT_MAGIC, 3) != 0 || header[3] != IR_FINGERPRINT_VERSION ||
+        header[4] != IR_FINGERPRINT_ENTRY_SIZE) {
+        Serial.println("Unsupported IR fingerprint index, ignored");
+        return false;
+    }
+
+    size_t size = storageManager.getFileSize(IR_FINGERPRINT_FILE);
+    int stored = (size - IR_FINGERPRINT_HEADER_SIZE) / IR_FINGERPRINT_ENTRY_SIZE;
+    if (stored > IR_FINGERPRINT_MAX_ENTRIES) stored = IR_FINGERPRINT_MAX_ENTRIES;
+
+    uint8_t chunk[IR_FINGERPRINT_LOAD_CHUNK * IR_FINGERPRINT_ENTRY_SIZE];
+    int loaded = 0;
+    while (loaded < stored) {
+        int batch = min(IR_FINGERPRINT_LOAD_CHUNK, stored - loaded);
+        if (!storageManager.readBinaryAt(IR_FINGERPRINT_FILE,
+                                         IR_FINGERPRINT_HEADER_SIZE + loaded * IR_FINGERPRINT_ENTRY_SIZE,
+                                         chunk, batch * IR_FINGERPRINT_ENTRY_SIZE)) {
+            break;
+        }
+        for (int i = 0; i < batch; i++) {
+            deserialize(chunk + i * IR_FINGERPRINT_ENTRY_SIZE, &entries[loaded + i]);
+        }
+        loaded += batch;
+    }
+
+    __atomic_store_n(&count, (uint16_t)loaded, __ATOMIC_RELEASE);
+    return loaded == stored;
+}
+
+void IRFingerprintIndex::writeHeader(uint8_t* header) {
+    memset(header, 0, IR_FINGERPRINT_HEADER_SIZE);
+    memcpy(header, IR_FINGERPRINT_MAGIC, 3);
+    header[3] = IR_FINGERPRINT_VERSION;
+    header[4] = IR_FINGERPRINT_ENTRY_SIZE;
+}
+
+void IRFingerprintIndex::serialize(const Entry& entry, uint8_t* out) {
+    memset(out, 0, IR_FINGERPRINT_ENTRY_SIZE);
+    out[0] = entry.fingerprint.length & 0xFF;
+    out[1] = entry.fingerprint.length >> 8;
+    out += 2;
+    memcpy(out, entry.fingerprint.histogram, sizeof(entry.fingerprint.histogram));
+    out += sizeof(entry.fingerprint.histogram);
+    memcpy(out, entry.fingerprint.shape, sizeof(entry.fingerprint.shape));
+    out += sizeof(entry.fingerprint.shape);
+    memcpy(out, entry.label, IR_FINGERPRINT_LABEL_SIZE);
+}
+
+void IRFingerprintIndex::deserialize(const uint8_t* in, Entry* entry) {
+    entry->fingerprint.length = in[0] | (in[1] << 8);
+    in += 2;
+    memcpy(entry->fingerprint.histogram, in, sizeof(entry->fingerprint.histogram));
+    in += sizeof(entry->fingerprint.histogram);
+    memcpy(entry->fingerprint.shape, in, sizeof(entry->fingerprint.shape));
+    in += sizeof(entry->fingerprint.shape);
+    memcpy(entry->label, in, IR_FINGERPRINT_LABEL_SIZE);
+    entry->label[IR_FINGERPRINT_LABEL_SIZE - 1] = '\0';
+}
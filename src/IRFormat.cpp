@@ -0,0 +1,194 @@
+#include "IRFormat.h"
+
+static const uint8_t IR_FORMAT_MAGIC[3] = {'I', 'R', 'b'};
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Writer
+
+IRFormatWriter::IRFormatWriter(uint8_t* buffer, size_t capacity, uint8_t quantumUs)
+    : buffer(buffer), capacity(capacity), length(0), quantumUs(quantumUs ? quantumUs : 1),
+      count(0), overflow(false) {
+    putByte(IR_FORMAT_MAGIC[0]);
+    putByte(IR_FORMAT_MAGIC[1]);
+    putByte(IR_FORMAT_MAGIC[2]);
+    putByte(IR_FORMAT_VERSION);
+    putByte(this->quantumUs);
+    putByte(0);
+    putByte(0);   // count, patched by finish()
+    putByte(0);
+}
+
+void IRFormatWriter::putByte(uint8_t value) {
+    if (length >= capacity) {
+        overflow = true;
+        return;
+    }
+    buffer[length++] = value;
+}
+
+void IRFormatWriter::putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        putByte((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    putByte((uint8_t)value);
+}
+
+bool IRFormatWriter::add(const IRSignal* signal) {
+    if (!signal || overflow || count == 0xFFFF) return false;
+
+    bool raw = signal->protocol == IR_RAW && signal->getRawLength() > 0;
+    putByte((uint8_t)signal->protocol);
+    putByte((raw ? IR_FORMAT_FLAG_RAW : 0) | (signal->dutyCycle ? IR_FORMAT_FLAG_DUTY : 0) |
+            (signal->bits ? IR_FORMAT_FLAG_BITS : 0));
+
+    size_t nameLength = strlen(signal->name);
+    if (nameLength > IR_FORMAT_MAX_NAME) nameLength = IR_FORMAT_MAX_NAME;
+    putByte((uint8_t)nameLength);
+    for (size_t i = 0; i < nameLength; i++) {
+        putByte((uint8_t)signal->name[i]);
+    }
+
+    putVarint(signal->address);
+    putVarint(signal->command);
+    putVarint(signal->frequency);
+    if (signal->dutyCycle) {
+        putByte(signal->dutyCycle);
+    }
+    if (signal->bits) {
+        putByte(signal->bits);
+    }
+    putVarint((uint32_t)signal->timestamp);
+
+    if (raw) {
+        const uint16_t* rawData = signal->getRaw();
+        putVarint(signal->getRawLength());
+
+        // Marks at even indexes, spaces at odd ones
+        uint32_t previous[2] = {0, 0};
+        for (uint16_t i = 0; i < signal->getRawLength(); i++) {
+            uint32_t steps = ((uint32_t)rawData[i] + quantumUs / 2) / quantumUs;
+            uint32_t& last = previous[i & 1];
+            uint32_t difference = steps > last ? steps - last : last - steps;
+            if (last && difference * 100 <= last * IR_FORMAT_SNAP_PERCENT) {
+                steps = last;
+            }
+            putVarint(zigzag((int32_t)(steps - last)));
+            last = steps;
+        }
+    }
+
+    if (overflow) return false;
+    count++;
+    return true;
+}
+
+size_t IRFormatWriter::finish() {
+    if (overflow || capacity < IR_FORMAT_HEADER_SIZE) return 0;
+    buffer[6] = count & 0xFF;
+    buffer[7] = count >> 8;
+    return length;
+}
+
+// Reader
+
+IRFormatReader::IRFormatReader(const uint8_t* buffer, size_t size)
+    : buffer(buffer), size(size), position(IR_FORMAT_HEADER_SIZE), quantumUs(1), count(0),
+      remaining(0), valid(false) {
+    if (!isBinary(buffer, size) || buffer[3] != IR_FORMAT_VERSION || buffer[4] == 0) return;
+
+    quantumUs = buffer[4];
+    count = buffer[6] | (buffer[7] << 8);
+    remaining = count;
+    valid = true;
+}
+
+bool IRFormatReader::isBinary(const uint8_t* buffer, size_t size) {
+    return buffer && size >= IR_FORMAT_HEADER_SIZE && memcmp(buffer, IR_FORMAT_MAGIC, 3) == 0;
+}
+
+bool IRFormatReader::getByte(uint8_t* value) {
+    if (position >= size) return false;
+    *value = buffer[position++];
+    return true;
+}
+
+bool IRFormatReader::getVarint(uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+        if (!getByte(&byte)) return false;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IRFormatReader::next(IRSignal* signal) {
+    if (!valid || !signal || remaining == 0) return false;
+
+    uint8_t protocol, flags, nameLength;
+    if (!getByte(&protocol) || !getByte(&flags) || !getByte(&nameLength)) return false;
+    if (nameLength > IR_FORMAT_MAX_NAME || position + nameLength > size) return false;
+
+    char name[IR_FORMAT_MAX_NAME + 1];
+    memcpy(name, buffer + position, nameLength);
+    name[nameLength] = '\0';
+    position += nameLength;
+
+    uint32_t address, command, frequency, timestamp;
+    uint8_t duty = 0, bits = 0;
+    if (!getVarint(&address) || !getVarint(&command) || !getVarint(&frequency) ||
+        ((flags & IR_FORMAT_FLAG_DUTY) && !getByte(&duty)) ||
+        ((flags & IR_FORMAT_FLAG_BITS) && !getByte(&bits)) || !getVarint(&timestamp)) {
+        return false;
+    }
+
+    if (flags & IR_FORMAT_FLAG_RAW) {
+        // Every duration takes at least a byte
+        uint32_t rawLength;
+        if (!getVarint(&rawLength) || rawLength == 0 || rawLength > IR_SIGNAL_MAX_RAW ||
+            rawLength > size - position) {
+            return false;
+        }
+
+        uint16_t* rawData = signal->resizeRaw(rawLength);
+        if (!rawData) return false;
+        int32_t previous[2] = {0, 0};
+        for (uint32_t i = 0; i < rawLength; i++) {
+            uint32_t delta;
+            if (!getVarint(&delta)) {
+                signal->clearRaw();
+                return false;
+            }
+            int32_t& last = previous[i & 1];
+            last += unzigzag(delta);
+            uint32_t duration = last > 0 ? (uint32_t)last * quantumUs : 0;
+            rawData[i] = duration > 0xFFFF ? 0xFFFF : duration;
+        }
+    } else {
+        signal->clearRaw();
+    }
+
+    signal->protocol = (IRProtocol)protocol;
+    signal->setName(name);
+    signal->address = address;
+    signal->command = command;
+    signal->frequency = frequency;
+    signal->dutyCycle = duty;
+    signal->bits = bits;
+    signal->timestamp = timestamp;
+
+    remaining--;
+    return true;
+}
@@ -0,0 +1,47 @@
+#include "IRGlitchFilter.h"
+
+IRGlitchFilter::IRGlitchFilter()
+    : holding(false), minPulseUs(IR_GLITCH_MIN_PULSE_US), glitches(0) {
+    held.timestamp = 0;
+    held.level = HIGH;
+}
+
+void IRGlitchFilter::setMinPulse(uint16_t us) {
+    minPulseUs = min(us, (uint16_t)IR_GLITCH_MAX_PULSE_US);
+}
+
+void IRGlitchFilter::reset() {
+    holding = false;
+}
+
+bool IRGlitchFilter::push(const Edge& edge, Edge* out) {
+    if (minPulseUs == 0) {
+        *out = edge;
+        return true;
+    }
+
+    if (!holding) {
+        held = edge;
+        holding = true;
+        return false;
+    }
+
+    // Back within the minimum pulse: the line never really changed
+    if (edge.timestamp - held.timestamp < minPulseUs) {
+        holding = false;
+        glitches++;
+        return false;
+    }
+
+    *out = held;
+    held = edge;
+    return true;
+}
+
+bool IRGlitchFilter::release(uint32_t nowUs, Edge* out) {
+    if (!holding || nowUs - held.timestamp < minPulseUs) return false;
+
+    *out = held;
+    holding = false;
+    return true;
+}
@@ -0,0 +1,162 @@
+#include "IRLibrary.h"
+#include "StorageManager.h"
+
+static const uint8_t IR_LIBRARY_MAGIC[3] = {'I', 'R', 'l'};
+
+// Blob buffer for reads and writes; used from the UI task only
+static uint8_t libraryBuffer[IR_FORMAT_BUFFER_SIZE];
+
+static void putLE(uint8_t* out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t getLE(const uint8_t* in, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+IRLibrary::IRLibrary() : count(0), opened(false) {}
+
+String IRLibrary::remotePath(const String& remote) {
+    return IR_REMOTE_DIR + String("/") + remote + IR_REMOTE_EXT;
+}
+
+bool IRLibrary::open(const String& libraryPath) {
+    close();
+
+    uint8_t header[IR_LIBRARY_HEADER_SIZE];
+    if (!storageManager.readBinaryAt(libraryPath, 0, header, sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header, IR_LIBRARY_MAGIC, 3) != 0 || header[3] != IR_LIBRARY_VERSION) {
+        Serial.println("Not an IR remote library: " + libraryPath);
+        return false;
+    }
+
+    path = libraryPath;
+    count = getLE(header + 4, 2);
+    opened = true;
+    return true;
+}
+
+void IRLibrary::close() {
+    opened = false;
+    count = 0;
+    path = "";
+}
+
+bool IRLibrary::readEntry(int index, uint8_t* entry) {
+    if (!opened || index < 0 || index >= count) return false;
+    return storageManager.readBinaryAt(path, IR_LIBRARY_HEADER_SIZE + index * IR_LIBRARY_ENTRY_SIZE,
+                                       entry, IR_LIBRARY_ENTRY_SIZE);
+}
+
+bool IRLibrary::getButtonName(int index, String& name) {
+    uint8_t entry[IR_LIBRARY_ENTRY_SIZE];
+    if (!readEntry(index, entry)) return false;
+
+    entry[IR_LIBRARY_NAME_SIZE - 1] = '\0';
+    name = (const char*)entry;
+    return true;
+}
+
+IRProtocol IRLibrary::getButtonProtocol(int index) {
+    uint8_t entry[IR_LIBRARY_ENTRY_SIZE];
+    if (!readEntry(index, entry)) return IR_UNKNOWN;
+    return (IRProtocol)entry[IR_LIBRARY_NAME_SIZE + 6];
+}
+
+int IRLibrary::findButton(const String& name) {
+    if (!opened) return -1;
+
+    uint8_t chunk[IR_LIBRARY_INDEX_CHUNK * IR_LIBRARY_ENTRY_SIZE];
+    for (int first = 0; first < count; first += IR_LIBRARY_INDEX_CHUNK) {
+        int entries = min(IR_LIBRARY_INDEX_CHUNK, count - first);
+        if (!storageManager.readBinaryAt(path, IR_LIBRARY_HEADER_SIZE + first * IR_LIBRARY_ENTRY_SIZE,
+                                         chunk, entries * IR_LIBRARY_ENTRY_SIZE)) {
+            return -1;
+        }
+        for (int i = 0; i < entries; i++) {
+            const char* entryName = (const char*)(chunk + i * IR_LIBRARY_ENTRY_SIZE);
+            if (strncmp(entryName, name.c_str(), IR_LIBRARY_NAME_SIZE - 1) == 0) {
+                return first + i;
+            }
+        }
+    }
+    return -1;
+}
+
+bool IRLibrary::loadButton(int index, IRSignal* signal) {
+    uint8_t entry[IR_LIBRARY_ENTRY_SIZE];
+    if (!signal || !readEntry(index, entry)) return false;
+
+    uint32_t offset = getLE(entry + IR_LIBRARY_NAME_SIZE, 4);
+    uint32_t length = getLE(entry + IR_LIBRARY_NAME_SIZE + 4, 2);
+    if (length > sizeof(libraryBuffer) ||
+        !storageManager.readBinaryAt(path, offset, libraryBuffer, length)) {
+        return false;
+    }
+
+    IRFormatReader reader(libraryBuffer, length);
+    return reader.next(signal);
+}
+
+size_t IRLibrary::encodeButton(const IRSignal* button, uint8_t* buffer, size_t capacity) {
+    IRFormatWriter writer(buffer, capacity);
+    if (!writer.add(button)) return 0;
+    return writer.finish();
+}
+
+bool IRLibrary::write(const String& libraryPath, const IRSignal* buttons, int buttonCount) {
+    if (!buttons || buttonCount <= 0 || buttonCount > IR_LIBRARY_MAX_BUTTONS) return false;
+
+    uint8_t header[IR_LIBRARY_HEADER_SIZE] = {0};
+    memcpy(header, IR_LIBRARY_MAGIC, 3);
+    header[3] = IR_LIBRARY_VERSION;
+    putLE(header + 4, buttonCount, 2);
+    if (!storageManager.writeBinaryFile(libraryPath, header, sizeof(header))) {
+        return false;
+    }
+
+    // Index, a chunk of entries per append. Each button is encoded here for
+    // its length and again below for the data, so only one blob is ever
+    // held in RAM.
+    uint8_t chunk[IR_LIBRARY_INDEX_CHUNK * IR_LIBRARY_ENTRY_SIZE];
+    uint32_t offset = IR_LIBRARY_HEADER_SIZE + buttonCount * IR_LIBRARY_ENTRY_SIZE;
+    int filled = 0;
+    for (int i = 0; i < buttonCount; i++) {
+        size_t length = encodeButton(&buttons[i], libraryBuffer, sizeof(libraryBuffer));
+        if (length == 0) {
+            Serial.println("IR button too large for a remote library: " + String(buttons[i].name));
+            return false;
+        }
+
+        uint8_t* entry = chunk + filled * IR_LIBRARY_ENTRY_SIZE;
+        memset(entry, 0, IR_LIBRARY_ENTRY_SIZE);
+        strncpy((char*)entry, buttons[i].name, IR_LIBRARY_NAME_SIZE - 1);
+        putLE(entry + IR_LIBRARY_NAME_SIZE, offset, 4);
+        putLE(entry + IR_LIBRARY_NAME_SIZE + 4, length, 2);
+        entry[IR_LIBRARY_NAME_SIZE + 6] = (uint8_t)buttons[i].protocol;
+        offset += length;
+
+        if (++filled == IR_LIBRARY_INDEX_CHUNK || i == buttonCount - 1) {
+            if (!storageManager.appendBinaryFile(libraryPath, chunk, filled * IR_LIBRARY_ENTRY_SIZE)) {
+                return false;
+            }
+            filled = 0;
+        }
+    }
+
+    for (int i = 0; i < buttonCount; i++) {
+        size_t length = encodeButton(&buttons[i], libraryBuffer, sizeof(libraryBuffer));
+        if (!storageManager.appendBinaryFile(libraryPath, libraryBuffer, length)) {
+            return false;
+        }
+    }
+    return true;
+}
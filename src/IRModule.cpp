@@ -1,5 +1,15 @@
 #include "IRModule.h"
+#include "IRFormat.h"
+#include "IRLibrary.h"
+#include "IRFingerprint.h"
 #include "StorageManager.h"
+#include "TaskManager.h"
+#include "MemoryMonitor.h"
+#include "PowerManager.h"
+#include "menu.h"
+#ifdef NATIVE_HAL
+#include <NativeHAL.h>
+#endif
 
 IRModule irModule;
 
@@ -7,16 +17,29 @@ IRModule irModule;
 IRModule* IRModule_instance = nullptr;
 
 IRModule::IRModule() 
-    : irInitialized(false), signalReceived(false), isReceivingSignal(false),
-      isTransmittingSignal(false), lastReceiveTime(0), rawIndex(0),
-      lastEdgeTime(0), historyCount(0), historyIndex(0) {
+    : Module(MODULE_IR, "ir"), irInitialized(false), signalReceived(false), isReceivingSignal(false),
+      lastReceiveTime(0), txToggle(false), batchRunning(false), batchNext(0), batchTotal(0), batchFailed(0),
+      batchGapUs(IR_BATCH_GAP_US), batchSentUs(0), batchInFlight(false), batchScheduler(nullptr),
+      batchJob(-1), analyzing(false), analyzerScheduler(nullptr), analyzerJob(-1), lastLevel(HIGH),
+      edgeScheduler(nullptr), edgeJob(-1), rawIndex(0),
+      frameOpen(false), frameDecoded(false), lastEdgeTime(0), lastEdgeLevel(HIGH),
+      frameGapUs(IR_FRAME_GAP_US), frameCount(0), decodeNanos(0), historyCount(0), historyIndex(0),
+      carrierSensor(false) {
     IRModule_instance = this;
 }
 
 bool IRModule::init() {
     pinMode(IR_RECEIVER_PIN, INPUT);
-    pinMode(IR_LED_PIN, OUTPUT);
-    digitalWrite(IR_LED_PIN, LOW);
+    
+    // The RMT drives the LED, carrier included
+    if (!irTransmitter.begin(IR_LED_PIN)) {
+        return false;
+    }
+    
+    // Optional: signals keep their protocol's nominal carrier without it
+    if (carrierSensor && !carrierMeter.begin(IR_CARRIER_PIN)) {
+        Serial.println("IR carrier capture unavailable");
+    }
     
     // Initialize raw buffer
     memset(rawBuffer, 0, sizeof(rawBuffer));
@@ -28,79 +51,337 @@ bool IRModule::init() {
 }
 
 void IRModule::update() {
-    if (!irInitialized) return;
+    if (!irInitialized || !isReceivingSignal) return;
+    
+    Edge edge, filtered;
+    while (edgeRing.pop(&edge)) {
+        if (glitchFilter.push(edge, &filtered)) {
+            addEdge(filtered);
+        }
+    }
     
-    unsigned long currentTime = millis();
+    // The last edge stands once no spike can follow it
+    if (edgeRing.isEmpty() && glitchFilter.release(micros(), &filtered)) {
+        addEdge(filtered);
+    }
     
-    // Check for received signals
-    if (isReceivingSignal && (currentTime - lastEdgeTime > 100)) {
-        // Signal reception timeout, process received data
-        if (rawIndex > 10) { // Minimum signal length
-            signalReceived = true;
-            if (decodeSignal(&currentSignal)) {
-                addToHistory(&currentSignal);
-            }
+    if (frameOpen && edgeRing.isEmpty() && !glitchFilter.isHolding()) {
+        uint32_t quiet = (uint32_t)micros() - lastEdgeTime;
+        
+        // A frame whose end is only known from the silence after it (Sony)
+        // is reported once the space is too long to be part of any frame
+        if (lastEdgeLevel == HIGH && decoder.settle(quiet)) {
+            deliverFrame(decoder.getResult());
         }
-        stopReceiving();
+        
+        // Quiet for a whole gap: the open frame is complete
+        if (quiet >= frameGapUs) {
+            finishFrame(frameGapUs);
+        }
+    }
+    
+    if (!frameOpen && edgeRing.isEmpty() && !glitchFilter.isHolding()) {
+        powerManager.releaseAwake(MODULE_IR);
     }
 }
 
-bool IRModule::receiveSignal() {
-    if (!irInitialized) return false;
+void IRModule::addEdge(const Edge& edge) {
+    if (frameOpen) {
+        uint32_t interval = edge.timestamp - lastEdgeTime;
+        if (interval < frameGapUs) {
+            if (rawIndex < MAX_RAW_LENGTH) {
+                rawBuffer[rawIndex++] = interval;
+            }
+            lastEdgeTime = edge.timestamp;
+            lastEdgeLevel = edge.level;
+            if (analyzing) {
+                analyzer.addDuration(interval, edge.level == HIGH);
+            }
+            
+            // Going idle (HIGH) ends a mark. The decoder reports a frame on
+            // the edge that completes it, not when the gap after it ends.
+            if (feedDecoder(interval, edge.level == HIGH)) {
+                deliverFrame(decoder.getResult());
+            }
+            return;
+        }
+        finishFrame(interval);
+    }
     
-    startReceiving();
-    return true;
+    // A frame starts with a mark (the demodulator pulls its output low)
+    if (edge.level == LOW) {
+        frameOpen = true;
+        frameDecoded = false;
+        rawIndex = 0;
+        lastEdgeTime = edge.timestamp;
+        lastEdgeLevel = LOW;
+        decodeNanos = 0;
+        decoder.reset();
+        if (analyzing) {
+            analyzer.beginFrame();
+        }
+    }
 }
 
-bool IRModule::decodeSignal(IRSignal* signal) {
-    if (!signal || rawIndex < 10) return false;
+bool IRModule::feedDecoder(uint32_t duration, bool mark) {
+#ifdef NATIVE_HAL
+    uint64_t start = nativeHAL.hostNanos();
+    bool decoded = decoder.feed(duration, mark);
+    decodeNanos += nativeHAL.hostNanos() - start;
+    return decoded;
+#else
+    return decoder.feed(duration, mark);
+#endif
+}
+
+void IRModule::finishFrame(uint32_t gapUs) {
+    frameOpen = false;
     
-    // Try different protocol decoders
-    if (decodeNEC(signal)) {
-        signal->protocol = IR_NEC;
-        return true;
+    // The gap that ended the frame is its last space
+    if (rawIndex < MAX_RAW_LENGTH) {
+        rawBuffer[rawIndex++] = min(gapUs, (uint32_t)IR_MAX_FRAME_GAP_US);
     }
     
-    if (decodeSony(signal)) {
-        signal->protocol = IR_SONY;
-        return true;
+    // The gap also settles a frame the decoder was still holding back
+    if (feedDecoder(gapUs, false)) {
+        deliverFrame(decoder.getResult());
+    } else if (!frameDecoded && rawIndex > 10) { // Minimum signal length
+        // Nothing in it decoded: keep the durations as a raw signal, unless
+        // it is the newest entry again
+        signalReceived = true;
+        frameCount++;
+#ifdef NATIVE_HAL
+        nativeHAL.notifyDecode("ir", rawIndex, false, decodeNanos);
+#endif
+        if (analyzing) {
+            analyzer.frameRaw(rawBuffer, rawIndex);
+        }
+        if (!coalesce(IR_RAW, 0, 0, false)) {
+            storeRaw(&currentSignal);
+            addToHistory(&currentSignal);
+        }
     }
     
-    if (decodeRC5(signal)) {
-        signal->protocol = IR_RC5;
-        return true;
+    IRCarrierEstimate carrier;
+    if (analyzing && carrierMeter.measure(&carrier)) {
+        analyzer.setCarrier(carrier.frequency, carrier.dutyPercent);
+    }
+    decoder.reset();
+    rawIndex = 0;
+    carrierMeter.arm();
+}
+
+void IRModule::deliverFrame(const IRDecodeResult& result) {
+    if (result.repeat) {
+        // A repeat code carries no data: the button of the last frame is
+        // still held. NEC and its variants share theirs, so the code is
+        // matched by its timing rather than by the row that decoded it.
+        const IRProtocolTiming* held = signalReceived ? irFindTiming(currentSignal.protocol) : nullptr;
+        if (!held || held->headerMark != result.timing->headerMark ||
+            held->repeatSpace != result.timing->repeatSpace) {
+            return;
+        }
     }
     
-    if (decodeRC6(signal)) {
-        signal->protocol = IR_RC6;
-        return true;
+    signalReceived = true;
+    frameDecoded = true;
+    frameCount++;
+    if (analyzing) {
+        analyzer.frameDecoded(result, rawIndex);
+    }
+#ifdef NATIVE_HAL
+    nativeHAL.notifyDecode("ir", rawIndex, true, decodeNanos);
+    decodeNanos = 0;
+#endif
+    
+    // A held button only updates the newest entry's counts: no new name,
+    // no copy
+    IRProtocol protocol = result.repeat ? currentSignal.protocol : result.protocol;
+    if (coalesce(protocol, result.address, result.command, result.repeat)) {
+        currentSignal.timestamp = millis();
+        return;
     }
     
-    if (decodeSamsung(signal)) {
-        signal->protocol = IR_SAMSUNG;
-        return true;
+    // Nothing to fold into (history cleared, or the last frame is past
+    // the window): a repeat is not a new press
+    if (result.repeat) return;
+    
+    fillSignal(result, &currentSignal);
+    addToHistory(&currentSignal);
+}
+
+bool IRModule::coalesce(IRProtocol protocol, uint32_t address, uint32_t command, bool repeat) {
+    if (historyCount == 0) return false;
+    
+    int newest = historySlot(historyCount - 1);
+    const IRSignal& last = history[newest];
+    IRHistoryStats& stats = historyStats[newest];
+    
+    uint32_t now = micros();
+    uint32_t interval = now - stats.lastSeenUs;
+    if (interval > IR_COALESCE_WINDOW_US || last.protocol != protocol) return false;
+    if (!repeat) {
+        if (protocol == IR_RAW ? !matchesRaw(last) : last.address != address || last.command != command) {
+            return false;
+        }
+    }
+    
+    if (repeat) {
+        stats.repeats++;
+    } else {
+        stats.frames++;
     }
+    stats.lastSeen = millis();
+    stats.lastSeenUs = now;
+    if (interval < stats.minIntervalUs) stats.minIntervalUs = interval;
+    if (interval > stats.maxIntervalUs) stats.maxIntervalUs = interval;
+    stats.totalIntervalUs += interval;
+    return true;
+}
+
+// The frame in rawBuffer against a stored raw signal; the last entry is
+// the gap and may be anything
+bool IRModule::matchesRaw(const IRSignal& signal) {
+    const uint16_t* rawData = signal.getRaw();
+    if (!rawData || signal.getRawLength() != rawIndex) return false;
     
-    if (decodeLG(signal)) {
-        signal->protocol = IR_LG;
+    for (uint16_t i = 0; i + 1 < rawIndex; i++) {
+        uint32_t expected = rawData[i];
+        uint32_t slack = expected * IR_RAW_MATCH_PERCENT / 100;
+        if (rawBuffer[i] + slack < expected || rawBuffer[i] > expected + slack) return false;
+    }
+    return true;
+}
+
+void IRModule::setEdgeNotify(Scheduler* scheduler, int job) {
+    edgeScheduler = scheduler;
+    edgeJob = job;
+}
+
+void IRModule::setFrameGap(uint32_t gapUs) {
+    frameGapUs = constrain(gapUs, (uint32_t)1000, (uint32_t)IR_MAX_FRAME_GAP_US);
+}
+
+void IRModule::onEvent(const ModuleEvent& event) {
+    bool start = event.type == MODULE_EVENT_ACTION_START;
+    
+    switch (event.actionId) {
+        case IR_SCAN:
+            // Capture runs on the other core; hand it the learn request
+            taskManager.sendCommand(start ? CAPTURE_CMD_IR_LEARN_START : CAPTURE_CMD_IR_LEARN_STOP);
+            break;
+        case IR_ANALYZE:
+            // A fresh analysis, then the same capture as learning
+            if (start) {
+                analyzer.reset();
+                analyzing = true;
+                if (analyzerScheduler) {
+                    analyzerScheduler->notify(analyzerJob);
+                }
+            } else {
+                analyzing = false;
+            }
+            taskManager.sendCommand(start ? CAPTURE_CMD_IR_LEARN_START : CAPTURE_CMD_IR_LEARN_STOP);
+            break;
+        case IR_UNIVERSAL:
+            // Closing the screen (SELECT) cancels the rest of the code set
+            if (start) {
+                startBatch(IR_UNIVERSAL_REMOTE);
+            } else {
+                cancelBatch();
+            }
+            break;
+    }
+}
+
+int IRModule::getProgress(int actionId) {
+    if (actionId != IR_UNIVERSAL || batchTotal == 0) return -1;
+    return batchNext * 100 / batchTotal;
+}
+
+bool IRModule::receiveSignal() {
+    if (!irInitialized) return false;
+    
+    startReceiving();
+    return true;
+}
+
+bool IRModule::decodeSignal(IRSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_IR_DECODE);
+    if (!signal || rawIndex < 10) return false;
+    
+    IRDecodeResult result;
+    if (decoder.decode(rawBuffer, rawIndex, &result)) {
+        fillSignal(result, signal);
         return true;
     }
     
     // If no protocol matched, store as raw
+    storeRaw(signal);
+    return true;
+}
+
+void IRModule::fillSignal(const IRDecodeResult& result, IRSignal* signal) {
+    signal->protocol = result.protocol;
+    signal->address = result.address;
+    signal->command = result.command;
+    signal->frequency = result.timing->carrierHz;
+    signal->dutyCycle = 0;
+    // Only a length other than the protocol's first row is stored
+    signal->bits = result.timing->bits != irFindTiming(result.protocol)->bits ? result.timing->bits : 0;
+    applyCarrier(signal);
+    signal->clearRaw();
+    generateSignalName(result.protocol, result.command, signal);
+    signal->timestamp = millis();
+}
+
+void IRModule::storeRaw(IRSignal* signal) {
     signal->protocol = IR_RAW;
-    signal->rawLength = rawIndex;
-    signal->rawData = new uint16_t[rawIndex];
-    memcpy(signal->rawData, rawBuffer, rawIndex * sizeof(uint16_t));
-    signal->frequency = 38000; // Default frequency
-    signal->name = generateSignalName(IR_RAW, 0);
+    if (!signal->setRaw(rawBuffer, rawIndex)) {
+        Serial.println("IR raw pool full, capture kept without durations");
+    }
+    signal->frequency = IR_DEFAULT_CARRIER_HZ; // Most remotes; replaced by a measurement
+    signal->dutyCycle = 0;
+    signal->bits = 0;
+    applyCarrier(signal);
     signal->timestamp = millis();
     
-    return true;
+    // Named after the saved signal it matches, if any
+    IRFingerprint fingerprint;
+    IRFingerprintIndex::compute(rawBuffer, rawIndex, &fingerprint);
+    char label[IR_FINGERPRINT_LABEL_SIZE];
+    if (irFingerprints.find(fingerprint, label) >= 0) {
+        signal->setName(label);
+    } else {
+        generateSignalName(IR_RAW, 0, signal);
+    }
+}
+
+void IRModule::applyCarrier(IRSignal* signal) {
+    IRCarrierEstimate estimate;
+    if (!carrierMeter.measure(&estimate)) return;
+    
+    signal->frequency = estimate.frequency;
+    signal->dutyCycle = estimate.dutyPercent;
+}
+
+void IRModule::indexSignal(const IRSignal* signal, const String& label, bool persist) {
+    if (signal->protocol != IR_RAW || !signal->getRaw()) return;
+    
+    IRFingerprint fingerprint;
+    IRFingerprintIndex::compute(signal->getRaw(), signal->getRawLength(), &fingerprint);
+    irFingerprints.add(fingerprint, label, persist);
 }
 
 String IRModule::getProtocolString(IRProtocol protocol) {
+    return protocolName(protocol);
+}
+
+const char* IRModule::protocolName(IRProtocol protocol) {
     switch (protocol) {
         case IR_NEC: return "NEC";
+        case IR_NEC_EXT: return "NECext";
+        case IR_NEC_RAW: return "NECraw";
         case IR_SONY: return "Sony";
         case IR_RC5: return "RC5";
         case IR_RC6: return "RC6";
@@ -111,178 +392,231 @@ String IRModule::getProtocolString(IRProtocol protocol) {
     }
 }
 
-bool IRModule::transmitSignal(const IRSignal* signal) {
-    if (!irInitialized || !signal) return false;
+bool IRModule::transmitSignal(const IRSignal* signal, IRTransmitCallback done, void* arg) {
+    if (!irInitialized || !signal || irTransmitter.isBusy()) return false;
     
-    isTransmittingSignal = true;
-    
-    bool success = false;
+    bool encoded;
+    if (signal->protocol == IR_RAW) {
+        encoded = signal->getRaw() &&
+                  txWaveform.encodeRaw(signal->getRaw(), signal->getRawLength(), signal->frequency);
+    } else {
+        // Decoded signals are rebuilt from their fields with the decoder's timings
+        const IRProtocolTiming* timing = irFindTiming(signal->protocol, signal->bits);
+        if (!timing) return false;
+        encoded = txWaveform.encode(*timing, irComposeData(*timing, signal->address, signal->command, !txToggle));
+    }
+    if (!encoded) return false;
     
-    switch (signal->protocol) {
-        case IR_NEC:
-            success = transmitNEC(signal->address, signal->command);
-            break;
-        case IR_SONY:
-            success = transmitSony(signal->command, 12); // Assume 12-bit Sony
-            break;
-        case IR_RAW:
-            success = transmitRaw(signal->rawData, signal->rawLength, signal->frequency);
-            break;
-        default:
-            break;
+    // Replay on the carrier the signal was learned with
+    if (signal->frequency) {
+        txWaveform.setCarrier(signal->frequency, signal->dutyCycle ? signal->dutyCycle : IR_DEFAULT_DUTY_PERCENT);
     }
+    if (!irTransmitter.send(txWaveform, done, arg)) return false;
     
-    isTransmittingSignal = false;
-    return success;
+    // A new press only once a frame is on the air, so a refused one does not
+    // leave the next press looking like a held repeat (RC5/RC6)
+    if (signal->protocol != IR_RAW) txToggle = !txToggle;
+    return true;
 }
 
-bool IRModule::transmitNEC(uint32_t address, uint32_t command) {
-    if (!irInitialized) return false;
+bool IRModule::transmitNEC(uint32_t address, uint32_t command, IRTransmitCallback done, void* arg) {
+    if (!irInitialized || irTransmitter.isBusy()) return false;
     
-    // NEC protocol implementation
-    const int carrierFreq = 38000;
-    const int pulseWidth = 1000000 / carrierFreq / 2; // 13µs for 38kHz
-    
-    // Lead pulse
-    for (int i = 0; i < 9000 * carrierFreq / 1000000; i++) {
-        digitalWrite(IR_LED_PIN, HIGH);
-        delayMicroseconds(pulseWidth);
-        digitalWrite(IR_LED_PIN, LOW);
-        delayMicroseconds(pulseWidth);
-    }
-    
-    // Lead space
-    delayMicroseconds(4500);
-    
-    // Send address (16 bits)
-    for (int i = 0; i < 16; i++) {
-        // Pulse
-        for (int j = 0; j < 560 * carrierFreq / 1000000; j++) {
-            digitalWrite(IR_LED_PIN, HIGH);
-            delayMicroseconds(pulseWidth);
-            digitalWrite(IR_LED_PIN, LOW);
-            delayMicroseconds(pulseWidth);
-        }
-        
-        // Space (560µs for 0, 1690µs for 1)
-        if (address & (1 << i)) {
-            delayMicroseconds(1690);
-        } else {
-            delayMicroseconds(560);
-        }
+    txWaveform.encodeNEC(address, command);
+    return irTransmitter.send(txWaveform, done, arg);
+}
+
+bool IRModule::transmitSony(uint32_t data, int nbits, IRTransmitCallback done, void* arg) {
+    if (!irInitialized || irTransmitter.isBusy()) return false;
+    
+    if (!txWaveform.encodeSony(data, nbits)) return false;
+    return irTransmitter.send(txWaveform, done, arg);
+}
+
+bool IRModule::transmitRaw(const uint16_t* data, uint16_t length, uint16_t frequency,
+                           IRTransmitCallback done, void* arg) {
+    if (!irInitialized || !data || irTransmitter.isBusy()) return false;
+    
+    if (!txWaveform.encodeRaw(data, length, frequency)) return false;
+    return irTransmitter.send(txWaveform, done, arg);
+}
+
+// Remote being sent as a batch, and the button on the air; UI task only
+static IRLibrary batchLibrary;
+static IRSignal batchSignal;
+
+bool IRModule::startBatch(const String& remote, uint32_t gapUs) {
+    cancelBatch();
+    if (!irInitialized || !batchLibrary.open(IRLibrary::remotePath(remote))) return false;
+    
+    batchTotal = batchLibrary.getButtonCount();
+    batchNext = 0;
+    batchFailed = 0;
+    batchGapUs = gapUs;
+    batchRunning = batchTotal > 0;
+    Serial.printf("IR batch: %d codes from %s\n", batchTotal, remote.c_str());
+    
+    if (batchScheduler) {
+        batchScheduler->notify(batchJob);
+    }
+    return batchRunning;
+}
+
+void IRModule::cancelBatch() {
+    if (batchRunning) {
+        Serial.printf("IR batch cancelled after %d of %d codes\n", batchNext, batchTotal);
     }
     
-    // Send command (16 bits)
-    for (int i = 0; i < 16; i++) {
-        // Pulse
-        for (int j = 0; j < 560 * carrierFreq / 1000000; j++) {
-            digitalWrite(IR_LED_PIN, HIGH);
-            delayMicroseconds(pulseWidth);
-            digitalWrite(IR_LED_PIN, LOW);
-            delayMicroseconds(pulseWidth);
-        }
+    // A frame already on the air finishes on its own
+    batchRunning = false;
+    batchLibrary.close();
+}
+
+void IRModule::updateBatch() {
+    if (!batchRunning || batchInFlight) return;
+    if (batchNext > 0 && (int32_t)(micros() - (batchSentUs + batchGapUs)) < 0) return;
+    
+    // Load and send the next button; skip the ones that fail
+    while (batchNext < batchTotal) {
+        int index = batchNext++;
+        bool loaded = batchLibrary.loadButton(index, &batchSignal);
         
-        // Space
-        if (command & (1 << i)) {
-            delayMicroseconds(1690);
-        } else {
-            delayMicroseconds(560);
-        }
+        batchInFlight = true;
+        if (loaded && transmitSignal(&batchSignal, batchFrameSent, this)) return;
+        
+        batchInFlight = false;
+        batchFailed++;
     }
     
-    // Final pulse
-    for (int i = 0; i < 560 * carrierFreq / 1000000; i++) {
-        digitalWrite(IR_LED_PIN, HIGH);
-        delayMicroseconds(pulseWidth);
-        digitalWrite(IR_LED_PIN, LOW);
-        delayMicroseconds(pulseWidth);
+    Serial.printf("IR batch done: %d codes sent, %d skipped\n", batchTotal - batchFailed, batchFailed);
+    batchRunning = false;
+    batchLibrary.close();
+}
+
+unsigned long IRModule::getBatchDeadline() {
+    // While a frame is on the air its TX-end interrupt notifies the job;
+    // the deadline is then only a re-check
+    unsigned long now = micros();
+    if (batchInFlight || batchNext == 0) return now + SCHEDULER_MAX_SLEEP_US;
+    
+    uint32_t elapsed = (uint32_t)now - batchSentUs;
+    return elapsed >= batchGapUs ? now : now + (batchGapUs - elapsed);
+}
+
+void IRModule::setBatchNotify(Scheduler* scheduler, int job) {
+    batchScheduler = scheduler;
+    batchJob = job;
+}
+
+void IRModule::setAnalyzerNotify(Scheduler* scheduler, int job) {
+    analyzerScheduler = scheduler;
+    analyzerJob = job;
+}
+
+void IRAM_ATTR IRModule::batchFrameSent(void* arg) {
+    IRModule* module = (IRModule*)arg;
+    module->batchSentUs = micros();
+    module->batchInFlight = false;
+    if (module->batchScheduler) {
+        module->batchScheduler->notifyFromISR(module->batchJob);
     }
+}
+
+// Encoding buffer for the SD files; used from the UI task only
+static uint8_t irFileBuffer[IR_FORMAT_BUFFER_SIZE];
+
+bool IRModule::saveSignal(const IRSignal* signal) {
+    if (!signal) return false;
     
-    return true;
+    return saveSignals(IR_DIR + String("/") + signal->name + IR_EXT, signal, 1);
 }
 
-bool IRModule::transmitSony(uint32_t data, int nbits) {
-    if (!irInitialized) return false;
+bool IRModule::loadSignal(const String& filename, IRSignal* signal) {
+    return loadSignals(filename, signal, 1) == 1;
+}
+
+bool IRModule::saveSignals(const String& filename, const IRSignal* signals, int count) {
+    MEMORY_SITE(MEMORY_SITE_IR_SAVE);
+    if (!signals || count <= 0) return false;
     
-    // Sony protocol implementation (simplified)
-    const int carrierFreq = 40000;
-    const int pulseWidth = 1000000 / carrierFreq / 2;
-    
-    // Start pulse
-    for (int i = 0; i < 2400 * carrierFreq / 1000000; i++) {
-        digitalWrite(IR_LED_PIN, HIGH);
-        delayMicroseconds(pulseWidth);
-        digitalWrite(IR_LED_PIN, LOW);
-        delayMicroseconds(pulseWidth);
-    }
-    
-    delayMicroseconds(600);
-    
-    // Send data bits
-    for (int i = 0; i < nbits; i++) {
-        // Pulse
-        int pulseTime = (data & (1 << i)) ? 1200 : 600;
-        for (int j = 0; j < pulseTime * carrierFreq / 1000000; j++) {
-            digitalWrite(IR_LED_PIN, HIGH);
-            delayMicroseconds(pulseWidth);
-            digitalWrite(IR_LED_PIN, LOW);
-            delayMicroseconds(pulseWidth);
+    IRFormatWriter writer(irFileBuffer, sizeof(irFileBuffer));
+    for (int i = 0; i < count; i++) {
+        if (!writer.add(&signals[i])) {
+            Serial.println("IR signals do not fit in one file: " + filename);
+            return false;
         }
-        
-        delayMicroseconds(600);
     }
     
+    size_t size = writer.finish();
+    if (size == 0 || !storageManager.writeBinaryFile(filename, irFileBuffer, size)) {
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        indexSignal(&signals[i], signals[i].name);
+    }
     return true;
 }
 
-bool IRModule::transmitRaw(uint16_t* data, uint16_t length, uint16_t frequency) {
-    if (!irInitialized || !data) return false;
+int IRModule::loadSignals(const String& filename, IRSignal* signals, int maxCount) {
+    MEMORY_SITE(MEMORY_SITE_IR_LOAD);
+    if (!signals || maxCount <= 0) return 0;
     
-    const int pulseWidth = 1000000 / frequency / 2;
+    size_t size = sizeof(irFileBuffer);
+    if (!storageManager.readBinaryFile(filename, irFileBuffer, size) ||
+        !IRFormatReader::isBinary(irFileBuffer, size)) {
+        // Saved before the binary format (or too big for it): JSON
+        return importSignalJson(filename, &signals[0]) ? 1 : 0;
+    }
     
-    for (uint16_t i = 0; i < length; i++) {
-        if (i % 2 == 0) {
-            // Pulse (on)
-            for (int j = 0; j < data[i] * frequency / 1000000; j++) {
-                digitalWrite(IR_LED_PIN, HIGH);
-                delayMicroseconds(pulseWidth);
-                digitalWrite(IR_LED_PIN, LOW);
-                delayMicroseconds(pulseWidth);
-            }
-        } else {
-            // Space (off)
-            delayMicroseconds(data[i]);
-        }
+    IRFormatReader reader(irFileBuffer, size);
+    if (!reader.isValid()) {
+        Serial.println("Unsupported IR file version: " + filename);
+        return 0;
     }
     
-    return true;
+    int loaded = 0;
+    while (loaded < maxCount && reader.next(&signals[loaded])) {
+        loaded++;
+    }
+    return loaded;
 }
 
-bool IRModule::saveSignal(const IRSignal* signal) {
+bool IRModule::exportSignalJson(const IRSignal* signal, const String& filename) {
+    MEMORY_SITE(MEMORY_SITE_IR_SAVE);
     if (!signal) return false;
     
-    String filename = IR_DIR + String("/") + signal->name + IR_EXT;
-    
     JsonDocument doc;
     doc["protocol"] = (int)signal->protocol;
     doc["name"] = signal->name;
     doc["command"] = signal->command;
     doc["address"] = signal->address;
     doc["frequency"] = signal->frequency;
+    if (signal->dutyCycle) {
+        doc["dutyCycle"] = signal->dutyCycle;
+    }
+    if (signal->bits) {
+        doc["bits"] = signal->bits;
+    }
+    if (signal->protocol == IR_NEC) {
+        doc["nec8"] = true;
+    }
     doc["timestamp"] = signal->timestamp;
     
-    if (signal->protocol == IR_RAW && signal->rawData) {
-        doc["rawLength"] = signal->rawLength;
+    if (signal->protocol == IR_RAW && signal->getRaw()) {
+        const uint16_t* rawData = signal->getRaw();
+        doc["rawLength"] = signal->getRawLength();
         JsonArray rawArray = doc.createNestedArray("rawData");
-        for (uint16_t i = 0; i < signal->rawLength; i++) {
-            rawArray.add(signal->rawData[i]);
+        for (uint16_t i = 0; i < signal->getRawLength(); i++) {
+            rawArray.add(rawData[i]);
         }
     }
     
     return storageManager.writeJsonFile(filename, doc);
 }
 
-bool IRModule::loadSignal(const String& filename, IRSignal* signal) {
+bool IRModule::importSignalJson(const String& filename, IRSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_IR_LOAD);
     if (!signal) return false;
     
     JsonDocument doc;
@@ -291,26 +625,105 @@ bool IRModule::loadSignal(const String& filename, IRSignal* signal) {
     }
     
     signal->protocol = (IRProtocol)doc["protocol"].as<int>();
-    signal->name = doc["name"].as<String>();
+    if (signal->protocol == IR_NEC && !doc["nec8"].as<bool>()) {
+        // Exported when NEC kept its 16-bit fields as sent
+        signal->protocol = IR_NEC_RAW;
+    }
+    signal->setName(doc["name"].as<const char*>());
     signal->command = doc["command"].as<uint32_t>();
     signal->address = doc["address"].as<uint32_t>();
     signal->frequency = doc["frequency"].as<uint16_t>();
+    signal->dutyCycle = doc["dutyCycle"] | 0;
+    signal->bits = doc["bits"] | 0;
     signal->timestamp = doc["timestamp"].as<unsigned long>();
     
+    signal->clearRaw();
     if (signal->protocol == IR_RAW && doc.containsKey("rawData")) {
-        signal->rawLength = doc["rawLength"].as<uint16_t>();
-        signal->rawData = new uint16_t[signal->rawLength];
+        uint16_t rawLength = doc["rawLength"].as<uint16_t>();
+        uint16_t* rawData = signal->resizeRaw(rawLength);
+        if (!rawData) return false;
         JsonArray rawArray = doc["rawData"];
-        for (uint16_t i = 0; i < signal->rawLength; i++) {
-            signal->rawData[i] = rawArray[i];
+        for (uint16_t i = 0; i < rawLength; i++) {
+            rawData[i] = rawArray[i];
         }
     }
     
     return true;
 }
 
+bool IRModule::saveRemote(const String& remote, const IRSignal* buttons, int count) {
+    MEMORY_SITE(MEMORY_SITE_IR_SAVE);
+    if (!IRLibrary::write(IRLibrary::remotePath(remote), buttons, count)) {
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        indexSignal(&buttons[i], remote + " " + buttons[i].name);
+    }
+    return true;
+}
+
+int IRModule::getRemoteCount() {
+    return storageManager.getFileCount(IR_REMOTE_DIR);
+}
+
+String IRModule::getRemoteFilename(int index) {
+    return storageManager.getFileName(IR_REMOTE_DIR, index);
+}
+
 void IRModule::deleteSignal(const String& filename) {
     storageManager.deleteFile(filename);
+    rebuildFingerprints();
+}
+
+void IRModule::rebuildFingerprints() {
+    MEMORY_SITE(MEMORY_SITE_IR_LOAD);
+    irFingerprints.clear();
+    
+    // Signal files, one signal or a bundle each
+    IRSignal signal;
+    int files = storageManager.getFileCount(IR_DIR);
+    for (int i = 0; i < files; i++) {
+        String name = storageManager.getFileName(IR_DIR, i);
+        if (!name.endsWith(IR_EXT)) continue;
+        
+        String filename = IR_DIR + String("/") + name;
+        size_t size = sizeof(irFileBuffer);
+        if (!storageManager.readBinaryFile(filename, irFileBuffer, size) ||
+            !IRFormatReader::isBinary(irFileBuffer, size)) {
+            if (importSignalJson(filename, &signal)) {
+                indexSignal(&signal, signal.name, false);
+            }
+            continue;
+        }
+        
+        IRFormatReader reader(irFileBuffer, size);
+        while (reader.isValid() && reader.next(&signal)) {
+            indexSignal(&signal, signal.name, false);
+        }
+    }
+    
+    // Remote libraries, each button labelled with its remote
+    int remotes = storageManager.getFileCount(IR_REMOTE_DIR);
+    for (int i = 0; i < remotes; i++) {
+        String name = storageManager.getFileName(IR_REMOTE_DIR, i);
+        if (!name.endsWith(IR_REMOTE_EXT)) continue;
+        
+        IRLibrary library;
+        if (!library.open(IR_REMOTE_DIR + String("/") + name)) continue;
+        
+        String remote = name.substring(0, name.length() - strlen(IR_REMOTE_EXT));
+        for (int button = 0; button < library.getButtonCount(); button++) {
+            if (library.loadButton(button, &signal)) {
+                indexSignal(&signal, remote + " " + signal.name, false);
+            }
+        }
+        library.close();
+    }
+    
+    if (!irFingerprints.save()) {
+        Serial.println("Failed to write the IR fingerprint index");
+    }
 }
 
 int IRModule::getSignalCount() {
@@ -324,7 +737,27 @@ String IRModule::getSignalFilename(int index) {
 void IRModule::addToHistory(const IRSignal* signal) {
     if (!signal) return;
     
-    history[historyIndex] = *signal;
+    IRSignal& entry = history[historyIndex];
+    entry = *signal;
+    
+    // Raw pool out of blocks: the oldest long captures give up their durations
+    for (int i = 0; i < historyCount && entry.getRawLength() != signal->getRawLength(); i++) {
+        IRSignal& oldest = history[historySlot(i)];
+        if (&oldest != &entry && oldest.usesPool()) {
+            oldest.clearRaw();
+            entry.setRaw(signal->getRaw(), signal->getRawLength());
+        }
+    }
+    
+    IRHistoryStats& stats = historyStats[historyIndex];
+    stats.frames = 1;
+    stats.repeats = 0;
+    stats.lastSeen = millis();
+    stats.lastSeenUs = micros();
+    stats.minIntervalUs = UINT32_MAX;
+    stats.maxIntervalUs = 0;
+    stats.totalIntervalUs = 0;
+    
     historyIndex = (historyIndex + 1) % MAX_HISTORY;
     if (historyCount < MAX_HISTORY) {
         historyCount++;
@@ -340,29 +773,85 @@ int IRModule::getHistoryCount() {
     return historyCount;
 }
 
+int IRModule::historySlot(int index) {
+    return (historyIndex - historyCount + index + MAX_HISTORY) % MAX_HISTORY;
+}
+
 IRSignal IRModule::getHistoryItem(int index) {
     if (index >= 0 && index < historyCount) {
-        int realIndex = (historyIndex - historyCount + index + MAX_HISTORY) % MAX_HISTORY;
-        return history[realIndex];
+        return history[historySlot(index)];
     }
     return IRSignal();
 }
 
+IRHistoryStats IRModule::getHistoryStats(int index) {
+    if (index >= 0 && index < historyCount) {
+        return historyStats[historySlot(index)];
+    }
+    return IRHistoryStats();
+}
+
+void IRModule::dumpHistory(Print& out) {
+    out.printf("IR history: %d entries, %lu frames received, %lu glitches filtered\n", historyCount,
+               (unsigned long)frameCount, (unsigned long)glitchFilter.getGlitches());
+    for (int i = 0; i < historyCount; i++) {
+        int slot = historySlot(i);
+        const IRSignal& signal = history[slot];
+        const IRHistoryStats& stats = historyStats[slot];
+        out.printf("  %-16s %lu frames, %lu repeats", signal.name,
+                   (unsigned long)stats.frames, (unsigned long)stats.repeats);
+        uint32_t intervals = stats.frames + stats.repeats - 1;
+        if (intervals > 0) {
+            out.printf(", every %lu/%lu/%lu ms (min/mean/max)",
+                       (unsigned long)(stats.minIntervalUs / 1000),
+                       (unsigned long)(stats.totalIntervalUs / intervals / 1000),
+                       (unsigned long)(stats.maxIntervalUs / 1000));
+        }
+        out.printf(", last %lu ms ago\n", (unsigned long)(millis() - stats.lastSeen));
+    }
+}
+
 bool IRModule::isReceiving() {
     return isReceivingSignal;
 }
 
 bool IRModule::isTransmitting() {
-    return isTransmittingSignal;
+    return irTransmitter.isBusy();
+}
+
+unsigned long IRModule::getNextDeadline() {
+    // When update() next has work: the point where an edge held by the
+    // glitch filter stands, where a complete frame can be settled or else
+    // the end of the open frame (edges queued since only push it back),
+    // otherwise the next routine drain. New edges notify.
+    unsigned long now = micros();
+    if (glitchFilter.isHolding()) {
+        int32_t hold = (int32_t)(glitchFilter.getReleaseTime() - (uint32_t)now);
+        return hold <= 0 ? now : now + hold;
+    }
+    if (!frameOpen) return now + IR_DRAIN_INTERVAL_US;
+    
+    uint32_t quiet = (uint32_t)now - lastEdgeTime;
+    uint32_t wait = frameGapUs;
+    uint32_t settle = decoder.getSettleTime();
+    if (lastEdgeLevel == HIGH && settle > 0 && settle < wait) {
+        wait = settle;
+    }
+    return quiet >= wait ? now : now + (wait - quiet);
 }
 
 void IRModule::startReceiving() {
     if (!irInitialized) return;
     
+    edgeRing.clear();
+    glitchFilter.reset();
+    decoder.reset();
     rawIndex = 0;
+    frameOpen = false;
     signalReceived = false;
     isReceivingSignal = true;
-    lastEdgeTime = millis();
+    carrierMeter.start();
+    lastLevel = digitalRead(IR_RECEIVER_PIN);
     
     // Attach interrupt
     attachInterrupt(digitalPinToInterrupt(IR_RECEIVER_PIN), irInterruptHandler, CHANGE);
@@ -371,107 +860,41 @@ void IRModule::startReceiving() {
 void IRModule::stopReceiving() {
     isReceivingSignal = false;
     detachInterrupt(digitalPinToInterrupt(IR_RECEIVER_PIN));
+    carrierMeter.stop();
+    frameOpen = false;
+    powerManager.releaseAwake(MODULE_IR);
 }
 
-void IRModule::captureRawData() {
-    // This would be called from interrupt handler
-    if (rawIndex < MAX_RAW_LENGTH - 1) {
-        unsigned long currentTime = micros();
-        uint16_t duration = currentTime - lastEdgeTime;
-        rawBuffer[rawIndex++] = duration;
-        lastEdgeTime = currentTime;
+void IRAM_ATTR IRModule::captureEdge() {
+    // Waking from light sleep leaves a level interrupt behind that can fire
+    // more than once; only a level change is an edge
+    uint8_t level = digitalRead(IR_RECEIVER_PIN);
+    if (level == lastLevel) return;
+    lastLevel = level;
+    
+    // No light sleep until update() has drained and processed the frame
+    powerManager.holdAwake(MODULE_IR);
+    edgeRing.push(micros(), level);
+    
+    // Have update() decode the edge now rather than at the next drain
+    if (edgeScheduler) {
+        edgeScheduler->notifyFromISR(edgeJob);
     }
 }
 
-String IRModule::generateSignalName(IRProtocol protocol, uint32_t command) {
-    String protocolName = getProtocolString(protocol);
+void IRModule::generateSignalName(IRProtocol protocol, uint32_t command, IRSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_SIGNAL_NAME);
     if (protocol == IR_RAW) {
-        return protocolName + "_" + String(millis() % 10000);
+        snprintf(signal->name, sizeof(signal->name), "%s_%lu", protocolName(protocol),
+                 (unsigned long)(millis() % 10000));
     } else {
-        return protocolName + "_0x" + String(command, HEX);
+        snprintf(signal->name, sizeof(signal->name), "%s_0x%lx", protocolName(protocol),
+                 (unsigned long)command);
     }
 }
 
-// Protocol decoders (simplified implementations)
-bool IRModule::decodeNEC(IRSignal* signal) {
-    // NEC protocol decoder implementation
-    // This is a simplified version
-    if (rawIndex < 68) return false; // NEC should have 68 edges minimum
-    
-    // Check for NEC start sequence (9ms pulse + 4.5ms space)
-    if (rawBuffer[0] < 8000 || rawBuffer[0] > 10000) return false;
-    if (rawBuffer[1] < 4000 || rawBuffer[1] > 5000) return false;
-    
-    uint32_t address = 0;
-    uint32_t command = 0;
-    
-    // Decode address (16 bits)
-    for (int i = 0; i < 16; i++) {
-        int pulseIndex = 2 + i * 2;
-        int spaceIndex = pulseIndex + 1;
-        
-        if (spaceIndex >= rawIndex) return false;
-        
-        // Check pulse duration (should be ~560µs)
-        if (rawBuffer[pulseIndex] < 400 || rawBuffer[pulseIndex] > 700) return false;
-        
-        // Check space duration (560µs for 0, 1690µs for 1)
-        if (rawBuffer[spaceIndex] > 1200) {
-            address |= (1 << i);
-        }
-    }
-    
-    // Decode command (16 bits)
-    for (int i = 0; i < 16; i++) {
-        int pulseIndex = 34 + i * 2;
-        int spaceIndex = pulseIndex + 1;
-        
-        if (spaceIndex >= rawIndex) return false;
-        
-        if (rawBuffer[pulseIndex] < 400 || rawBuffer[pulseIndex] > 700) return false;
-        
-        if (rawBuffer[spaceIndex] > 1200) {
-            command |= (1 << i);
-        }
-    }
-    
-    signal->address = address;
-    signal->command = command;
-    signal->frequency = 38000;
-    signal->name = generateSignalName(IR_NEC, command);
-    signal->timestamp = millis();
-    
-    return true;
-}
-
-bool IRModule::decodeSony(IRSignal* signal) {
-    // Sony protocol decoder (simplified)
-    // Implementation would be similar to NEC but with different timing
-    return false; // Placeholder
-}
-
-bool IRModule::decodeRC5(IRSignal* signal) {
-    // RC5 protocol decoder (simplified)
-    return false; // Placeholder
-}
-
-bool IRModule::decodeRC6(IRSignal* signal) {
-    // RC6 protocol decoder (simplified)
-    return false; // Placeholder
-}
-
-bool IRModule::decodeSamsung(IRSignal* signal) {
-    // Samsung protocol decoder (simplified)
-    return false; // Placeholder
-}
-
-bool IRModule::decodeLG(IRSignal* signal) {
-    // LG protocol decoder (simplified)
-    return false; // Placeholder
-}
-
 void IRAM_ATTR IRModule::irInterruptHandler() {
     if (IRModule_instance && IRModule_instance->isReceivingSignal) {
-        IRModule_instance->captureRawData();
+        IRModule_instance->captureEdge();
     }
 }
@@ -0,0 +1,92 @@
+#include "IRProtocols.h"
+
+// Every protocol variant the decoder and the encoders know. Timings are
+// the nominal ones from the protocol descriptions; the receiver's marks
+// run long and its spaces short, which the decoder takes out using the
+// leader (IRDecoder.h) before the tolerance applies.
+constexpr IRProtocolTiming irProtocols[IR_PROTOCOL_TABLE_SIZE] = {
+    //                                          carrier  header      one         zero        stop repeat gap    bits double-bit        flags                                           tol  address  command  check               toggle
+    {IR_NEC_RAW, "NECraw",  IR_PULSE_DISTANCE, 38000,  9000, 4500, 560, 1690,  560, 560,   560, 2250, 40000, 32, IR_NO_DOUBLE_BIT, 0,                                              25,  0, 16,  16, 16,  0, 0,               IR_NO_TOGGLE},
+    {IR_NEC,     "NEC",     IR_PULSE_DISTANCE, 38000,  9000, 4500, 560, 1690,  560, 560,   560, 2250, 40000, 32, IR_NO_DOUBLE_BIT, IR_ADDRESS_INVERTED | IR_COMMAND_INVERTED | IR_TIMING_VARIANT, 25, 0, 8, 16, 8, 0, 0, IR_NO_TOGGLE},
+    {IR_NEC_EXT, "NECext",  IR_PULSE_DISTANCE, 38000,  9000, 4500, 560, 1690,  560, 560,   560, 2250, 40000, 32, IR_NO_DOUBLE_BIT, IR_COMMAND_INVERTED | IR_TIMING_VARIANT,        25,  0, 16,  16, 8,   0, 0,               IR_NO_TOGGLE},
+    {IR_SAMSUNG, "Samsung", IR_PULSE_DISTANCE, 38000,  4500, 4500, 560, 1690,  560, 560,   560, 0,    47000, 32, IR_NO_DOUBLE_BIT, 0,                                              25,  0, 16,  16, 16,  0, 0,               IR_NO_TOGGLE},
+    {IR_LG,      "LG",      IR_PULSE_DISTANCE, 38000,  8500, 4250, 550, 1600,  550, 550,   550, 2250, 50000, 28, IR_NO_DOUBLE_BIT, IR_MSB_FIRST | IR_NIBBLE_CHECKSUM,              25,  20, 8,  4, 16,   0, 0,               IR_NO_TOGGLE},
+    {IR_SONY,    "Sony12",  IR_PULSE_WIDTH,    40000,  2400, 600,  1200, 600,  600, 600,   0,   0,    6000,  12, IR_NO_DOUBLE_BIT, 0,                                              25,  7, 5,   0, 7,    0, 0,               IR_NO_TOGGLE},
+    {IR_SONY,    "Sony15",  IR_PULSE_WIDTH,    40000,  2400, 600,  1200, 600,  600, 600,   0,   0,    6000,  15, IR_NO_DOUBLE_BIT, 0,                                              25,  7, 8,   0, 7,    0, 0,               IR_NO_TOGGLE},
+    {IR_SONY,    "Sony20",  IR_PULSE_WIDTH,    40000,  2400, 600,  1200, 600,  600, 600,   0,   0,    6000,  20, IR_NO_DOUBLE_BIT, 0,                                              25,  7, 13,  0, 7,    0, 0,               IR_NO_TOGGLE},
+    {IR_RC5,     "RC5",     IR_BIPHASE,        36000,  0,    0,    889,  0,    0,   0,     0,   0,    89000, 14, IR_NO_DOUBLE_BIT, IR_MSB_FIRST | IR_ONE_SPACE_FIRST | IR_LEADING_HALF_IDLE | IR_FIELD_BIT, 25, 6, 5, 0, 6, 0x2000, 0x2000, 11},
+    {IR_RC6,     "RC6",     IR_BIPHASE,        36000,  2666, 889,  444,  0,    0,   0,     0,   0,    2666,  21, 4,                IR_MSB_FIRST,                                   25,  8, 8,   0, 8,    0x1E0000, 0x100000, 16},
+};
+
+static constexpr uint32_t decodedRowsFrom(int row) {
+    return row == IR_PROTOCOL_TABLE_SIZE ? 0 :
+           ((irProtocols[row].flags & IR_TIMING_VARIANT) ? 0 : 1UL << row) | decodedRowsFrom(row + 1);
+}
+
+constexpr uint32_t irDecodedRows = decodedRowsFrom(0);
+
+const IRProtocolTiming* irFindTiming(IRProtocol protocol, uint8_t bits) {
+    for (int i = 0; i < IR_PROTOCOL_TABLE_SIZE; i++) {
+        if (irProtocols[i].protocol == protocol && (bits == 0 || irProtocols[i].bits == bits)) {
+            return &irProtocols[i];
+        }
+    }
+    return nullptr;
+}
+
+static uint32_t nibbleSum(uint32_t value) {
+    uint32_t sum = 0;
+    for (; value; value >>= 4) {
+        sum += value & 0xF;
+    }
+    return sum & 0xF;
+}
+
+uint32_t irComposeData(const IRProtocolTiming& timing, uint32_t address, uint32_t command, bool toggle) {
+    uint32_t commandMask = irBitMask(timing.commandBits);
+    uint32_t data = timing.checkValue |
+                    (address & irBitMask(timing.addressBits)) << timing.addressShift |
+                    (command & commandMask) << timing.commandShift;
+
+    if (timing.flags & IR_ADDRESS_INVERTED) {
+        uint32_t addressMask = irBitMask(timing.addressBits);
+        data |= (~address & addressMask) << (timing.addressShift + timing.addressBits);
+    }
+    if (timing.flags & IR_COMMAND_INVERTED) {
+        data |= (~command & commandMask) << (timing.commandShift + timing.commandBits);
+    }
+    if (timing.flags & IR_NIBBLE_CHECKSUM) {
+        data |= nibbleSum(command & commandMask) & irBitMask(timing.commandShift);
+    }
+    if ((timing.flags & IR_FIELD_BIT) && !((command >> timing.commandBits) & 1)) {
+        data |= 1UL << (timing.bits - 2);
+    }
+    if (toggle && timing.toggleBit != IR_NO_TOGGLE) {
+        data |= 1UL << timing.toggleBit;
+    }
+    return data;
+}
+
+bool irCheckData(const IRProtocolTiming& timing, uint32_t data) {
+    if ((data & timing.checkMask) != timing.checkValue) return false;
+
+    if (timing.flags & IR_ADDRESS_INVERTED) {
+        uint32_t addressMask = irBitMask(timing.addressBits);
+        uint32_t address = (data >> timing.addressShift) & addressMask;
+        if (((data >> (timing.addressShift + timing.addressBits)) & addressMask) != (~address & addressMask)) {
+            return false;
+        }
+    }
+
+    uint32_t commandMask = irBitMask(timing.commandBits);
+    uint32_t command = (data >> timing.commandShift) & commandMask;
+    if ((timing.flags & IR_COMMAND_INVERTED) &&
+        ((data >> (timing.commandShift + timing.commandBits)) & commandMask) != (~command & commandMask)) {
+        return false;
+    }
+    if ((timing.flags & IR_NIBBLE_CHECKSUM) &&
+        (data & irBitMask(timing.commandShift)) != (nibbleSum(command) & irBitMask(timing.commandShift))) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,136 @@
+#include "IRSignal.h"
+#include <utility>
+
+static_assert(IR_RAW_POOL_BLOCKS <= 32, "IR raw pool is tracked in one word");
+
+#define IR_RAW_POOL_MASK (IR_RAW_POOL_BLOCKS >= 32 ? 0xFFFFFFFFUL : (1UL << IR_RAW_POOL_BLOCKS) - 1)
+
+// Blocks for long captures; bit i of rawPoolUsed is set while block i is
+// held by a signal
+static uint16_t rawPool[IR_RAW_POOL_BLOCKS][IR_SIGNAL_MAX_RAW];
+static uint32_t rawPoolUsed = 0;
+
+static uint16_t* claimBlock() {
+    uint32_t used = __atomic_load_n(&rawPoolUsed, __ATOMIC_RELAXED);
+    while (true) {
+        uint32_t available = ~used & IR_RAW_POOL_MASK;
+        if (!available) return nullptr;
+
+        int block = __builtin_ctz(available);
+        if (__atomic_compare_exchange_n(&rawPoolUsed, &used, used | (1UL << block), true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return rawPool[block];
+        }
+    }
+}
+
+static void returnBlock(uint16_t* block) {
+    int index = (block - rawPool[0]) / IR_SIGNAL_MAX_RAW;
+    __atomic_fetch_and(&rawPoolUsed, ~(1UL << index), __ATOMIC_RELEASE);
+}
+
+int IRSignal::getPoolFree() {
+    return __builtin_popcount(~__atomic_load_n(&rawPoolUsed, __ATOMIC_RELAXED) & IR_RAW_POOL_MASK);
+}
+
+IRSignal::IRSignal()
+    : protocol(IR_UNKNOWN), command(0), address(0), frequency(0), dutyCycle(0), bits(0), timestamp(0),
+      rawData(inlineRaw), rawLength(0) {
+    name[0] = '\0';
+}
+
+IRSignal::IRSignal(const IRSignal& other) : IRSignal() {
+    *this = other;
+}
+
+IRSignal::IRSignal(IRSignal&& other) : IRSignal() {
+    *this = std::move(other);
+}
+
+IRSignal::~IRSignal() {
+    releaseBlock();
+}
+
+IRSignal& IRSignal::operator=(const IRSignal& other) {
+    if (this != &other) {
+        copyFields(other);
+        setRaw(other.getRaw(), other.rawLength);
+    }
+    return *this;
+}
+
+IRSignal& IRSignal::operator=(IRSignal&& other) {
+    if (this == &other) return *this;
+
+    copyFields(other);
+    if (other.usesPool()) {
+        releaseBlock();
+        rawData = other.rawData;
+        rawLength = other.rawLength;
+        other.rawData = other.inlineRaw;
+    } else {
+        setRaw(other.getRaw(), other.rawLength);
+    }
+    other.rawLength = 0;
+    return *this;
+}
+
+void IRSignal::copyFields(const IRSignal& other) {
+    protocol = other.protocol;
+    memcpy(name, other.name, sizeof(name));
+    command = other.command;
+    address = other.address;
+    frequency = other.frequency;
+    dutyCycle = other.dutyCycle;
+    bits = other.bits;
+    timestamp = other.timestamp;
+}
+
+void IRSignal::setName(const char* text) {
+    strncpy(name, text ? text : "", IR_SIGNAL_NAME_SIZE - 1);
+    name[IR_SIGNAL_NAME_SIZE - 1] = '\0';
+}
+
+bool IRSignal::setRaw(const uint16_t* data, uint16_t length) {
+    if (!data || length == 0) {
+        clearRaw();
+        return length == 0;
+    }
+
+    uint16_t* target = resizeRaw(length);
+    if (!target) return false;
+    memcpy(target, data, length * sizeof(uint16_t));
+    return true;
+}
+
+uint16_t* IRSignal::resizeRaw(uint16_t length) {
+    if (length > IR_SIGNAL_MAX_RAW) {
+        clearRaw();
+        return nullptr;
+    }
+
+    if (length <= IR_SIGNAL_INLINE_RAW) {
+        releaseBlock();
+    } else if (!usesPool()) {
+        uint16_t* block = claimBlock();
+        if (!block) {
+            rawLength = 0;
+            return nullptr;
+        }
+        rawData = block;
+    }
+    rawLength = length;
+    return rawData;
+}
+
+void IRSignal::clearRaw() {
+    releaseBlock();
+    rawLength = 0;
+}
+
+void IRSignal::releaseBlock() {
+    if (usesPool()) {
+        returnBlock(rawData);
+        rawData = inlineRaw;
+    }
+}
@@ -0,0 +1,150 @@
+#include "IRTransmitter.h"
+#include "PowerManager.h"
+#ifdef NATIVE_HAL
+#include <NativeHAL.h>
+#endif
+
+IRTransmitter irTransmitter;
+
+IRTransmitter::IRTransmitter()
+    : txPin(0), started(false), busy(false), doneCallback(nullptr), doneArg(nullptr),
+      currentCarrier(0), currentDuty(0), itemCount(0), framesSent(0), rejected(0)
+#ifdef NATIVE_HAL
+      , playIndex(0), playHalf(0)
+#endif
+{
+}
+
+bool IRTransmitter::begin(uint8_t pin) {
+    if (started) return true;
+    txPin = pin;
+
+#ifdef NATIVE_HAL
+    pinMode(txPin, OUTPUT);
+    digitalWrite(txPin, LOW);
+#else
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, (rmt_channel_t)IR_TX_RMT_CHANNEL);
+    config.clk_div = 80;    // 1 us ticks from the 80 MHz APB clock
+    config.tx_config.carrier_en = true;
+    config.tx_config.carrier_freq_hz = 38000;
+    config.tx_config.carrier_duty_percent = IR_DEFAULT_DUTY_PERCENT;
+    config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+
+    if (rmt_config(&config) != ESP_OK ||
+        rmt_driver_install(config.channel, 0, 0) != ESP_OK) {
+        Serial.println("IR: RMT transmitter init failed");
+        return false;
+    }
+    rmt_register_tx_end_callback(txEnd, this);
+    currentCarrier = 38000;
+    currentDuty = IR_DEFAULT_DUTY_PERCENT;
+#endif
+
+    started = true;
+    return true;
+}
+
+bool IRTransmitter::send(const IRWaveform& waveform, IRTransmitCallback done, void* arg) {
+    if (!started || busy) {
+        rejected++;
+        return false;
+    }
+
+    itemCount = waveform.toRMTItems(items, IR_TX_MAX_ITEMS);
+    if (itemCount == 0) {
+        rejected++;
+        return false;
+    }
+
+    doneCallback = done;
+    doneArg = arg;
+    busy = true;
+
+    // Light sleep would stop the APB clock under the frame; finish() lets go
+    powerManager.holdAwake(POWER_HOLD_IR_TX);
+
+#ifdef NATIVE_HAL
+    currentCarrier = waveform.getCarrier();
+    currentDuty = waveform.getDutyPercent();
+    playIndex = 0;
+    playHalf = 0;
+    playNext(this);
+#else
+    if ((waveform.getCarrier() != currentCarrier || waveform.getDutyPercent() != currentDuty) &&
+        !setCarrier(waveform.getCarrier(), waveform.getDutyPercent())) {
+        busy = false;
+        powerManager.releaseAwake(POWER_HOLD_IR_TX);
+        rejected++;
+        return false;
+    }
+
+    if (rmt_write_items((rmt_channel_t)IR_TX_RMT_CHANNEL, (const rmt_item32_t*)items,
+                        itemCount, false) != ESP_OK) {
+        busy = false;
+        powerManager.releaseAwake(POWER_HOLD_IR_TX);
+        rejected++;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void IRTransmitter::finish() {
+    framesSent++;
+    IRTransmitCallback callback = doneCallback;
+    void* callbackArg = doneArg;
+    busy = false;
+    powerManager.releaseAwake(POWER_HOLD_IR_TX);
+
+    if (callback) callback(callbackArg);
+}
+
+#ifdef NATIVE_HAL
+
+// Walks the RMT items half by half, one virtual-time event per level change
+void IRTransmitter::playNext(void* arg) {
+    IRTransmitter* tx = (IRTransmitter*)arg;
+
+    uint32_t half = (tx->items[tx->playIndex] >> (tx->playHalf * 16)) & 0xFFFF;
+    uint32_t duration = half & 0x7FFF;
+    if (duration == 0) {
+        digitalWrite(tx->txPin, LOW);
+        tx->finish();
+        return;
+    }
+
+    digitalWrite(tx->txPin, half >> 15 ? HIGH : LOW);
+    if (++tx->playHalf == 2) {
+        tx->playHalf = 0;
+        tx->playIndex++;
+    }
+    nativeHAL.scheduleCallback(nativeHAL.nowMicros() + duration, playNext, tx);
+}
+
+#else
+
+bool IRTransmitter::setCarrier(uint32_t carrierHz, uint8_t dutyPercent) {
+    if (carrierHz == 0 || dutyPercent == 0 || dutyPercent >= 100) return false;
+
+    // Carrier high/low times count RMT source clock (APB) cycles
+    uint32_t period = APB_CLK_FREQ / carrierHz;
+    uint32_t high = period * dutyPercent / 100;
+    if (rmt_set_tx_carrier((rmt_channel_t)IR_TX_RMT_CHANNEL, true, high, period - high,
+                           RMT_CARRIER_LEVEL_HIGH) != ESP_OK) {
+        return false;
+    }
+
+    currentCarrier = carrierHz;
+    currentDuty = dutyPercent;
+    return true;
+}
+
+void IRAM_ATTR IRTransmitter::txEnd(rmt_channel_t channel, void* arg) {
+    if (channel != IR_TX_RMT_CHANNEL) return;
+    ((IRTransmitter*)arg)->finish();
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "IRWaveform.h"
+
+IRWaveform::IRWaveform()
+    : carrierHz(IR_DEFAULT_CARRIER_HZ), dutyPercent(IR_DEFAULT_DUTY_PERCENT), length(0) {
+}
+
+void IRWaveform::begin(uint32_t carrier, uint8_t duty) {
+    carrierHz = carrier;
+    dutyPercent = duty;
+    length = 0;
+}
+
+void IRWaveform::setCarrier(uint32_t carrier, uint8_t duty) {
+    carrierHz = carrier;
+    dutyPercent = duty;
+}
+
+bool IRWaveform::mark(uint32_t us) {
+    return append(us, true);
+}
+
+bool IRWaveform::space(uint32_t us) {
+    return append(us, false);
+}
+
+bool IRWaveform::append(uint32_t us, bool isMark) {
+    if (us == 0) return true;
+
+    // Marks sit at even indexes; a frame never starts with a space
+    bool lastIsMark = length % 2 == 1;
+    if (length > 0 && lastIsMark == isMark) {
+        durations[length - 1] += us;
+        return true;
+    }
+    if (length == 0 && !isMark) return true;
+
+    if (length >= IR_WAVEFORM_MAX_LENGTH) return false;
+    durations[length++] = us;
+    return true;
+}
+
+bool IRWaveform::encode(const IRProtocolTiming& timing, uint32_t data) {
+    begin(timing.carrierHz);
+    mark(timing.headerMark);
+    space(timing.headerSpace);
+
+    bool fits = true;
+    for (uint8_t i = 0; i < timing.bits && fits; i++) {
+        uint8_t position = timing.flags & IR_MSB_FIRST ? timing.bits - 1 - i : i;
+        bool one = (data >> position) & 1;
+
+        switch (timing.encoding) {
+            case IR_PULSE_DISTANCE:
+                mark(timing.oneMark);
+                fits = space(one ? timing.oneSpace : timing.zeroSpace);
+                break;
+            case IR_PULSE_WIDTH:
+                mark(one ? timing.oneMark : timing.zeroMark);
+                fits = space(timing.oneSpace);
+                break;
+            case IR_BIPHASE: {
+                // Half-bits; a leading space is lost in the idle line by append()
+                uint32_t half = i == timing.doubleBit ? timing.oneMark * 2 : timing.oneMark;
+                bool markFirst = timing.flags & IR_ONE_SPACE_FIRST ? !one : one;
+                if (markFirst) {
+                    mark(half);
+                    fits = space(half);
+                } else {
+                    space(half);
+                    fits = mark(half);
+                }
+                break;
+            }
+        }
+    }
+    if (fits && timing.stopMark) {
+        fits = mark(timing.stopMark);
+    }
+    return fits;
+}
+
+bool IRWaveform::encodeNEC(uint32_t address, uint32_t command) {
+    const IRProtocolTiming* timing = irFindTiming(IR_NEC_RAW);
+    return encode(*timing, irComposeData(*timing, address, command));
+}
+
+bool IRWaveform::encodeSony(uint32_t data, int nbits) {
+    const IRProtocolTiming* timing = nbits > 0 && nbits <= 32 ? irFindTiming(IR_SONY, nbits) : nullptr;
+    return timing && encode(*timing, data);
+}
+
+bool IRWaveform::encodeRaw(const uint16_t* data, uint16_t count, uint16_t frequency) {
+    if (!data || frequency == 0) return false;
+
+    begin(frequency);
+    for (uint16_t i = 0; i < count; i++) {
+        if (!(i % 2 == 0 ? mark(data[i]) : space(data[i]))) return false;
+    }
+    return true;
+}
+
+uint32_t IRWaveform::getTotalMicros() const {
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        total += durations[i];
+    }
+    return total;
+}
+
+size_t IRWaveform::toRMTItems(uint32_t* items, size_t maxItems) const {
+    if (!items || maxItems == 0) return 0;
+
+    // Each item holds two {duration:15, level:1} halves
+    size_t count = 0;
+    uint32_t item = 0;
+    bool secondHalf = false;
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint32_t level = i % 2 == 0 ? 1 : 0;
+        uint32_t remaining = durations[i];
+        while (remaining > 0) {
+            uint32_t chunk = remaining > IR_RMT_MAX_DURATION ? IR_RMT_MAX_DURATION : remaining;
+            remaining -= chunk;
+
+            uint32_t half = chunk | (level << 15);
+            if (!secondHalf) {
+                item = half;
+            } else {
+                if (count >= maxItems) return 0;
+                items[count++] = item | (half << 16);
+            }
+            secondHalf = !secondHalf;
+        }
+    }
+
+    // A zero duration ends the transmission: either the second half of a
+    // pending item or a full item of its own
+    if (count >= maxItems) return 0;
+    items[count++] = secondHalf ? item : 0;
+    return count;
+}
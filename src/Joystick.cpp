@@ -3,7 +3,7 @@
 Joystick joystick;
 
 Joystick::Joystick() 
-    : lastReadTime(0), debounceDelay(50), lastDirection(JOYSTICK_NONE) {
+    : lastReadTime(0), debounceDelay(JOYSTICK_DEBOUNCE_MS), lastDirection(JOYSTICK_NONE) {
     for (int i = 0; i < 3; i++) {
         buttonStates[i] = false;
         lastButtonStates[i] = false;
@@ -0,0 +1,144 @@
+#include "MemoryMonitor.h"
+#include "TaskManager.h"
+#include <new>
+
+MemoryMonitor memoryMonitor;
+
+static const char* const siteNames[MEMORY_SITE_COUNT] = {
+    "other", "ir_decode", "rf_decode", "ir_load", "rf_load",
+    "ir_save", "rf_save", "signal_name"
+};
+
+uint8_t MemoryMonitor::coreIndex() {
+#ifdef NATIVE_HAL
+    return 0;
+#else
+    return xPortGetCoreID() & 1;
+#endif
+}
+
+void MemoryMonitor::recordNew(size_t size) {
+    __atomic_fetch_add(&totalNews, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&totalNewBytes, (uint32_t)size, __ATOMIC_RELAXED);
+    
+    // Each site is only active on one core at a time
+    MemorySiteStats& stats = sites[currentSite[coreIndex()]];
+    stats.news++;
+    stats.newBytes += size;
+}
+
+void MemoryMonitor::recordDelete() {
+    __atomic_fetch_add(&totalDeletes, 1, __ATOMIC_RELAXED);
+    sites[currentSite[coreIndex()]].deletes++;
+}
+
+MemorySite MemoryMonitor::enterSite(MemorySite site) {
+    uint8_t core = coreIndex();
+    MemorySite previous = (MemorySite)currentSite[core];
+    currentSite[core] = site;
+    sites[site].calls++;
+    return previous;
+}
+
+void MemoryMonitor::exitSite(MemorySite previous, MemorySite site, int32_t heapLost) {
+    sites[site].netHeapBytes += heapLost;
+    currentSite[coreIndex()] = previous;
+}
+
+void MemoryMonitor::update() {
+    uint32_t largestBlock = ESP.getMaxAllocHeap();
+    if (minLargestBlock == 0 || largestBlock < minLargestBlock) {
+        minLargestBlock = largestBlock;
+    }
+    
+    if (largestBlock < MEMORY_LOW_HEAP_BYTES && !lowHeapWarned) {
+        Serial.printf("Low memory: largest free block %u bytes, %u allocations live\n",
+                      (unsigned)largestBlock, (unsigned)getLiveAllocations());
+        lowHeapWarned = true;
+    }
+}
+
+const char* MemoryMonitor::getSiteName(MemorySite site) {
+    if (site < 0 || site >= MEMORY_SITE_COUNT) return "";
+    return siteNames[site];
+}
+
+void MemoryMonitor::dump(Print& out) {
+    update();
+    
+    out.printf("heap: %u free, %u min free, %u largest block (%u lowest seen)\n",
+               (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+               (unsigned)ESP.getMaxAllocHeap(), (unsigned)minLargestBlock);
+    
+    uint32_t captureStack = taskManager.getCaptureStackHighWater();
+    uint32_t uiStack = taskManager.getUIStackHighWater();
+    if (captureStack || uiStack) {
+        out.printf("stack unused: capture %u of %u, ui %u of %u bytes\n",
+                   (unsigned)captureStack, CAPTURE_TASK_STACK, (unsigned)uiStack, UI_TASK_STACK);
+    }
+    
+    out.printf("new: %u (%u bytes), delete: %u, live: %u\n",
+               (unsigned)totalNews, (unsigned)totalNewBytes,
+               (unsigned)totalDeletes, (unsigned)getLiveAllocations());
+    
+    out.println("site            calls      new   delete    new_bytes  net_heap");
+    for (int i = 0; i < MEMORY_SITE_COUNT; i++) {
+        const MemorySiteStats& stats = sites[i];
+        if (stats.calls == 0 && stats.news == 0) continue;
+        out.printf("%-12s %8u %8u %8u %12u %9d\n", siteNames[i],
+                   (unsigned)stats.calls, (unsigned)stats.news, (unsigned)stats.deletes,
+                   (unsigned)stats.newBytes, (int)stats.netHeapBytes);
+    }
+}
+
+MemorySiteScope::MemorySiteScope(MemorySite site)
+    : site(site), freeHeapAtEntry(ESP.getFreeHeap()) {
+    previous = memoryMonitor.enterSite(site);
+}
+
+MemorySiteScope::~MemorySiteScope() {
+    int32_t heapLost = (int32_t)(freeHeapAtEntry - ESP.getFreeHeap());
+    memoryMonitor.exitSite(previous, site, heapLost);
+}
+
+// Global allocation hooks. These replace the toolchain's operator new and
+// delete for the whole image and must not allocate themselves.
+
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) abort();
+    memoryMonitor.recordNew(size);
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    void* ptr = malloc(size ? size : 1);
+    if (ptr) memoryMonitor.recordNew(size);
+    return ptr;
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    memoryMonitor.recordDelete();
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
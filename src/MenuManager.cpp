@@ -1,11 +1,8 @@
 #include "MenuManager.h"
 #include "DisplayManager.h"
 #include "menu.h"
-#include "NFCModule.h"
+#include "ModuleRegistry.h"
 #include "IRModule.h"
-#include "iButtonModule.h"
-#include "RFModule.h"
-#include "GPIOModule.h"
 
 MenuManager menuManager;
 
@@ -31,6 +28,8 @@ const MenuItem irSubMenu[IR_SUBMENU_COUNT] = {
     {"Learn Remote", "📖", IR_SCAN},
     {"Send Signal", "📶", IR_EMULATE},
     {"Saved Signals", "💾", IR_HISTORY},
+    {"Universal Remote", "📡", IR_UNIVERSAL},
+    {"Signal Analyzer", "📊", IR_ANALYZE},
     {"< Back", "←", IR_BACK}
 };
 
@@ -63,10 +62,49 @@ const MenuItem settingsSubMenu[SETTINGS_SUBMENU_COUNT] = {
     {"< Back", "←", SETTINGS_BACK}
 };
 
+// Action screens, indexed by module id and submenu item
+struct ModuleScreen {
+    const char* title;
+    const char* body;
+};
+
+#define MODULE_ACTION_COUNT 5
+
+static const ModuleScreen moduleScreens[MODULE_COUNT][MODULE_ACTION_COUNT] = {
+    {   // MODULE_NFC
+        {"NFC Scan", "Scanning for NFC cards...\n\nHold card near device\nPress SELECT to stop"},
+        {"NFC Emulate", "Select card to emulate\n\nNo saved cards found\nPress SELECT to return"},
+        {"NFC History", "Recent NFC cards:\n\nNo history available\nPress SELECT to return"}
+    },
+    {   // MODULE_IR
+        {"IR Learn", "Learning IR signal...\n\nPoint remote at device\nPress SELECT to stop"},
+        {"IR Send", "Select signal to send\n\nNo saved signals\nPress SELECT to return"},
+        {"IR History", "Recent IR signals:\n\nNo history available\nPress SELECT to return"},
+        {"Universal Remote", "No code set found:\nremotes/universal.irl\n\nPress SELECT to return"},
+        {"IR Analyzer", "Point remote at device\n\n\nPress SELECT to stop"}
+    },
+    {   // MODULE_IBUTTON
+        {"iButton Read", "Reading iButton key...\n\nTouch key to device\nPress SELECT to stop"},
+        {"iButton Emulate", "Select key to emulate\n\nNo saved keys found\nPress SELECT to return"},
+        {"iButton History", "Recent iButton keys:\n\nNo history available\nPress SELECT to return"}
+    },
+    {   // MODULE_RF
+        {"RF Scan", "Scanning frequencies...\n\n433.92 MHz\nPress SELECT to stop"},
+        {"RF Transmit", "Select signal to send\n\nNo saved signals\nPress SELECT to return"},
+        {"RF History", "Recent RF signals:\n\nNo history available\nPress SELECT to return"}
+    },
+    {   // MODULE_GPIO
+        {"GPIO Read", "Pin states:\n\nSelect pins to monitor\nPress SELECT to return"},
+        {"GPIO Write", "Pin control:\n\nSelect pins to control\nPress SELECT to return"},
+        {"Logic Analyzer", "Analyzing signals...\n\nNo activity detected\nPress SELECT to stop"}
+    }
+};
+
 MenuManager::MenuManager() 
     : currentState(MENU_MAIN), previousState(MENU_MAIN), 
       currentSelection(0), maxItems(MENU_COUNT), 
-      needsRedraw(true), lastInputTime(0) {
+      needsRedraw(true), lastInputTime(0), screenTitle(""), screenBody(""),
+      screenModule(-1), screenAction(0), previousSelection(0) {
 }
 
 void MenuManager::init() {
@@ -89,6 +127,15 @@ void MenuManager::update() {
 void MenuManager::handleInput(JoystickDirection input) {
     lastInputTime = millis();
     
+    // A full-screen page only listens for SELECT
+    if (currentState == MENU_MODULE_RUNNING) {
+        if (input == JOYSTICK_SELECT) {
+            closeScreen();
+            needsRedraw = true;
+        }
+        return;
+    }
+    
     switch (input) {
         case JOYSTICK_UP:
             moveUp();
@@ -147,12 +194,7 @@ void MenuManager::selectCurrentItem() {
                     goToSubmenu(MENU_SETTINGS_SUB);
                     break;
                 case MENU_ABOUT:
-                    // Show about screen
-                    displayManager.clear();
-                    displayManager.drawModuleScreen("About", "FlipperS3 v1.0\nESP32-S3 Multi-tool\n\nPress SELECT to return");
-                    displayManager.display();
-                    delay(3000);
-                    needsRedraw = true;
+                    openScreen("About", "FlipperS3 v1.0\nESP32-S3 Multi-tool\n\nPress SELECT to return");
                     break;
             }
             break;
@@ -202,11 +244,7 @@ void MenuManager::selectCurrentItem() {
                 goBack();
             } else {
                 // Handle settings options
-                displayManager.clear();
-                displayManager.drawModuleScreen("Settings", "Feature not implemented\n\nPress SELECT to return");
-                displayManager.display();
-                delay(2000);
-                needsRedraw = true;
+                openScreen("Settings", "Feature not implemented\n\nPress SELECT to return");
             }
             break;
             
@@ -227,8 +265,16 @@ void MenuManager::goToSubmenu(MenuState submenu) {
     currentState = submenu;
     currentSelection = 0;
     
-    // Update max items based on submenu
-    switch (submenu) {
+    // Modules are brought up the first time their menu is entered
+    if (submenu >= MENU_NFC_SUB && submenu <= MENU_GPIO_SUB) {
+        moduleRegistry.activate((ModuleId)(submenu - MENU_NFC_SUB));
+    }
+    
+    updateMaxItems();
+}
+
+void MenuManager::updateMaxItems() {
+    switch (currentState) {
         case MENU_NFC_SUB:
             maxItems = NFC_SUBMENU_COUNT;
             break;
@@ -268,6 +314,9 @@ void MenuManager::draw() {
         case MENU_MAIN:
             drawMainMenu();
             break;
+        case MENU_MODULE_RUNNING:
+            drawActionScreen();
+            break;
         default:
             drawCurrentSubmenu();
             break;
@@ -325,6 +374,51 @@ void MenuManager::drawCurrentSubmenu() {
     displayManager.drawSubmenu(title, menuItems, maxItems, currentSelection);
 }
 
+// An action that reports progress gets a bar in place of its body text
+void MenuManager::drawActionScreen() {
+    if (screenModule == MODULE_IR && screenAction == IR_ANALYZE && irModule.isAnalyzing()) {
+        drawIRAnalyzer();
+        return;
+    }
+    
+    int progress = screenModule >= 0 ? moduleRegistry.getProgress((ModuleId)screenModule, screenAction) : -1;
+    if (progress < 0) {
+        displayManager.drawModuleScreen(screenTitle, screenBody);
+        return;
+    }
+    
+    displayManager.drawModuleScreen(screenTitle, "\n\n\nPress SELECT to stop");
+    displayManager.drawProgressBar(progress);
+}
+
+// Last frame on one line, then marks above and spaces below the axis
+void MenuManager::drawIRAnalyzer() {
+    IRAnalysis analysis;
+    irModule.readAnalysis(&analysis);
+    if (analysis.frames == 0) {
+        displayManager.drawModuleScreen(screenTitle, screenBody);
+        return;
+    }
+    
+    char line[32];
+    int length = snprintf(line, sizeof(line), "%s", analysis.protocol);
+    if (analysis.repeat) {
+        length += snprintf(line + length, sizeof(line) - length, " rpt");
+    } else if (analysis.bits) {
+        length += snprintf(line + length, sizeof(line) - length, " %ub", analysis.bits);
+    } else {
+        length += snprintf(line + length, sizeof(line) - length, " %ud", analysis.durations);
+    }
+    if (analysis.carrierHz && length < (int)sizeof(line)) {
+        snprintf(line + length, sizeof(line) - length, " %lu.%luk",
+                 (unsigned long)(analysis.carrierHz / 1000), (unsigned long)(analysis.carrierHz % 1000 / 100));
+    }
+    
+    displayManager.drawModuleScreen(screenTitle, line);
+    displayManager.drawHistogram(0, MENU_AREA_Y + 30, SCREEN_WIDTH, SCREEN_HEIGHT - MENU_AREA_Y - 30,
+                                 analysis.marks, analysis.spaces, IR_ANALYZER_BINS);
+}
+
 const MenuItem* MenuManager::getCurrentMenuItems() {
     switch (currentState) {
         case MENU_NFC_SUB:
@@ -345,93 +439,42 @@ const MenuItem* MenuManager::getCurrentMenuItems() {
 }
 
 void MenuManager::runModule(int moduleId, int actionId) {
-    displayManager.clear();
-    
-    switch (moduleId) {
-        case MENU_NFC:
-            switch (actionId) {
-                case NFC_SCAN:
-                    displayManager.drawModuleScreen("NFC Scan", "Scanning for NFC cards...\n\nHold card near device\nPress SELECT to stop");
-                    break;
-                case NFC_EMULATE:
-                    displayManager.drawModuleScreen("NFC Emulate", "Select card to emulate\n\nNo saved cards found\nPress SELECT to return");
-                    break;
-                case NFC_HISTORY:
-                    displayManager.drawModuleScreen("NFC History", "Recent NFC cards:\n\nNo history available\nPress SELECT to return");
-                    break;
-            }
-            break;
-            
-        case MENU_IR:
-            switch (actionId) {
-                case IR_SCAN:
-                    displayManager.drawModuleScreen("IR Learn", "Learning IR signal...\n\nPoint remote at device\nPress SELECT to stop");
-                    break;
-                case IR_EMULATE:
-                    displayManager.drawModuleScreen("IR Send", "Select signal to send\n\nNo saved signals\nPress SELECT to return");
-                    break;
-                case IR_HISTORY:
-                    displayManager.drawModuleScreen("IR History", "Recent IR signals:\n\nNo history available\nPress SELECT to return");
-                    break;
-            }
-            break;
-            
-        case MENU_IBUTTON:
-            switch (actionId) {
-                case IBUTTON_SCAN:
-                    displayManager.drawModuleScreen("iButton Read", "Reading iButton key...\n\nTouch key to device\nPress SELECT to stop");
-                    break;
-                case IBUTTON_EMULATE:
-                    displayManager.drawModuleScreen("iButton Emulate", "Select key to emulate\n\nNo saved keys found\nPress SELECT to return");
-                    break;
-                case IBUTTON_HISTORY:
-                    displayManager.drawModuleScreen("iButton History", "Recent iButton keys:\n\nNo history available\nPress SELECT to return");
-                    break;
-            }
-            break;
-            
-        case MENU_RF:
-            switch (actionId) {
-                case RF_SCAN:
-                    displayManager.drawModuleScreen("RF Scan", "Scanning frequencies...\n\n433.92 MHz\nPress SELECT to stop");
-                    break;
-                case RF_EMULATE:
-                    displayManager.drawModuleScreen("RF Transmit", "Select signal to send\n\nNo saved signals\nPress SELECT to return");
-                    break;
-                case RF_HISTORY:
-                    displayManager.drawModuleScreen("RF History", "Recent RF signals:\n\nNo history available\nPress SELECT to return");
-                    break;
-            }
-            break;
-            
-        case MENU_GPIO:
-            switch (actionId) {
-                case GPIO_READ:
-                    displayManager.drawModuleScreen("GPIO Read", "Pin states:\n\nSelect pins to monitor\nPress SELECT to return");
-                    break;
-                case GPIO_WRITE:
-                    displayManager.drawModuleScreen("GPIO Write", "Pin control:\n\nSelect pins to control\nPress SELECT to return");
-                    break;
-                case GPIO_ANALYZE:
-                    displayManager.drawModuleScreen("Logic Analyzer", "Analyzing signals...\n\nNo activity detected\nPress SELECT to stop");
-                    break;
-            }
-            break;
-    }
+    if (moduleId < 0 || moduleId >= MODULE_COUNT ||
+        actionId < 0 || actionId >= MODULE_ACTION_COUNT) return;
     
-    displayManager.display();
+    ModuleId id = (ModuleId)moduleId;
+    const ModuleScreen& screen = moduleScreens[id][actionId];
     
-    // Wait for user input to return
-    while (true) {
-        joystick.update();
-        JoystickDirection input = joystick.read();
-        
-        if (input == JOYSTICK_SELECT) {
-            break;
-        }
-        
-        delay(50);
+    if (moduleRegistry.isActive(id)) {
+        openScreen(screen.title, screen.body, moduleId, actionId);
+    } else {
+        openScreen(screen.title, "Module not available\n\nCheck settings and wiring\nPress SELECT to return",
+                   moduleId, actionId);
     }
+    moduleRegistry.dispatch(id, {MODULE_EVENT_ACTION_START, actionId});
+}
+
+// The page is drawn by draw(); input keeps flowing to handleInput() while
+// it is up, so nothing here waits for SELECT
+void MenuManager::openScreen(const char* title, const char* body, int moduleId, int actionId) {
+    screenTitle = title;
+    screenBody = body;
+    screenModule = moduleId;
+    screenAction = actionId;
     
+    previousState = currentState;
+    previousSelection = currentSelection;
+    currentState = MENU_MODULE_RUNNING;
     needsRedraw = true;
 }
+
+void MenuManager::closeScreen() {
+    if (screenModule >= 0) {
+        moduleRegistry.dispatch((ModuleId)screenModule, {MODULE_EVENT_ACTION_STOP, screenAction});
+        screenModule = -1;
+    }
+    
+    currentState = previousState;
+    currentSelection = previousSelection;
+    updateMaxItems();
+}
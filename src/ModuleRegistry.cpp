@@ -0,0 +1,88 @@
+#include "ModuleRegistry.h"
+#include "Profiler.h"
+#include "NFCModule.h"
+#include "IRModule.h"
+#include "iButtonModule.h"
+#include "RFModule.h"
+#include "GPIOModule.h"
+
+ModuleRegistry moduleRegistry;
+
+ModuleRegistry::ModuleRegistry() : enabledMask(0), initializedMask(0), activeMask(0) {
+    modules[MODULE_NFC] = &nfcModule;
+    modules[MODULE_IR] = &irModule;
+    modules[MODULE_IBUTTON] = &iButtonModule;
+    modules[MODULE_RF] = &rfModule;
+    modules[MODULE_GPIO] = &gpioModule;
+    
+    for (int i = 0; i < MODULE_COUNT; i++) {
+        schedulers[i] = nullptr;
+        jobs[i] = -1;
+    }
+}
+
+void ModuleRegistry::setEnabled(uint32_t mask) {
+    enabledMask = mask;
+}
+
+void ModuleRegistry::setJob(ModuleId id, Scheduler* scheduler, int job) {
+    if (id < 0 || id >= MODULE_COUNT) return;
+    schedulers[id] = scheduler;
+    jobs[id] = job;
+}
+
+bool ModuleRegistry::activate(ModuleId id) {
+    if (id < 0 || id >= MODULE_COUNT) return false;
+    if (initializedMask & MODULE_BIT(id)) return isActive(id);
+    if (!(enabledMask & MODULE_BIT(id))) return false;
+    
+    Module* module = modules[id];
+    if (module->getStats().initFailed) return false;
+    
+    if (!module->init()) {
+        module->getStats().initFailed = true;
+        Serial.printf("Failed to initialize %s module\n", module->getModuleName());
+        return false;
+    }
+    
+    initializedMask |= MODULE_BIT(id);
+    activeMask |= MODULE_BIT(id);
+    if (schedulers[id]) schedulers[id]->notify(jobs[id]);
+    return true;
+}
+
+void ModuleRegistry::update(ModuleId id) {
+    if (!isActive(id)) return;
+    PROFILE_SCOPE((ProfileProbe)id);
+    modules[id]->getStats().updates++;
+    modules[id]->update();
+}
+
+void ModuleRegistry::dispatch(ModuleId id, const ModuleEvent& event) {
+    if (!isActive(id)) return;
+    modules[id]->getStats().events++;
+    modules[id]->onEvent(event);
+}
+
+int ModuleRegistry::getProgress(ModuleId id, int actionId) {
+    if (!isActive(id)) return -1;
+    return modules[id]->getProgress(actionId);
+}
+
+Module* ModuleRegistry::get(ModuleId id) {
+    if (id < 0 || id >= MODULE_COUNT) return nullptr;
+    return modules[id];
+}
+
+void ModuleRegistry::printStats() {
+    Serial.println("module    state      updates  events");
+    for (int i = 0; i < MODULE_COUNT; i++) {
+        Module* module = modules[i];
+        ModuleStats& stats = module->getStats();
+        const char* state = isActive((ModuleId)i) ? "active" :
+                            stats.initFailed ? "failed" :
+                            (enabledMask & MODULE_BIT(i)) ? "idle" : "disabled";
+        Serial.printf("%-9s %-9s %8u %7u\n", module->getModuleName(), state,
+                      (unsigned)stats.updates, (unsigned)stats.events);
+    }
+}
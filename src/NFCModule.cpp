@@ -4,7 +4,7 @@
 NFCModule nfcModule;
 
 NFCModule::NFCModule() 
-    : mfrc522(NFC_SS_PIN, NFC_RST_PIN), nfcInitialized(false), 
+    : Module(MODULE_NFC, "nfc"), mfrc522(NFC_SS_PIN, NFC_RST_PIN), nfcInitialized(false), 
       cardPresent(false), lastScanTime(0), historyCount(0), historyIndex(0) {
 }
 
@@ -31,8 +31,8 @@ void NFCModule::update() {
     
     unsigned long currentTime = millis();
     
-    // Check for cards every 100ms
-    if (currentTime - lastScanTime > 100) {
+    // Check for cards every NFC_POLL_INTERVAL_MS
+    if (currentTime - lastScanTime >= NFC_POLL_INTERVAL_MS) {
         cardPresent = mfrc522.PICC_IsNewCardPresent();
         lastScanTime = currentTime;
     }
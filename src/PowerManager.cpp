@@ -0,0 +1,159 @@
+#include "PowerManager.h"
+#include "DisplayManager.h"
+
+#ifndef NATIVE_HAL
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
+
+PowerManager powerManager;
+
+PowerManager::PowerManager()
+    : lightSleepEnabled(false), screenTimeoutMs(0), awakeMask(0), wakePinCount(0),
+      sleepCount(0), sleptUs(0), heldSkips(0), pinSkips(0), screenOffCount(0) {
+}
+
+void PowerManager::configure(bool autoSleep, uint32_t sleepTimeoutMs) {
+    lightSleepEnabled = autoSleep;
+    screenTimeoutMs = autoSleep ? sleepTimeoutMs : 0;
+    if (!autoSleep) displayManager.setPower(true);
+}
+
+bool PowerManager::addWakePin(uint8_t pin, int level, Scheduler* scheduler, int job) {
+    if (wakePinCount >= POWER_MAX_WAKE_PINS) return false;
+
+    WakePin& wake = wakePins[wakePinCount++];
+    wake.pin = pin;
+    wake.level = level;
+    wake.scheduler = scheduler;
+    wake.job = job;
+    wake.enabled = true;
+    return true;
+}
+
+void PowerManager::setWakePinEnabled(uint8_t pin, bool enabled) {
+    for (int i = 0; i < wakePinCount; i++) {
+        if (wakePins[i].pin == pin) wakePins[i].enabled = enabled;
+    }
+}
+
+void IRAM_ATTR PowerManager::holdAwake(ModuleId id) {
+    __atomic_fetch_or(&awakeMask, MODULE_BIT(id), __ATOMIC_RELEASE);
+}
+
+void PowerManager::releaseAwake(ModuleId id) {
+    __atomic_fetch_and(&awakeMask, ~MODULE_BIT(id), __ATOMIC_RELEASE);
+}
+
+void IRAM_ATTR PowerManager::holdAwake(PowerHold hold) {
+    __atomic_fetch_or(&awakeMask, 1UL << hold, __ATOMIC_RELEASE);
+}
+
+void IRAM_ATTR PowerManager::releaseAwake(PowerHold hold) {
+    __atomic_fetch_and(&awakeMask, ~(1UL << hold), __ATOMIC_RELEASE);
+}
+
+bool PowerManager::sleep(unsigned long timeoutUs) {
+    if (!lightSleepEnabled || timeoutUs < POWER_MIN_SLEEP_US) return false;
+
+    // Light sleep stops both cores, so the capture side has to be idle too
+    unsigned long sleepUs = min(timeoutUs, captureScheduler.getIdleUs());
+    if (sleepUs < POWER_MIN_SLEEP_US || uiScheduler.hasPending()) return false;
+
+    if (__atomic_load_n(&awakeMask, __ATOMIC_ACQUIRE)) {
+        heldSkips++;
+        return false;
+    }
+
+    // A held button or a busy receiver would end the sleep at once
+    if (wakePinActive()) {
+        pinSkips++;
+        return false;
+    }
+
+    unsigned long start = micros();
+#ifdef NATIVE_HAL
+    uiScheduler.wait(sleepUs);
+#else
+    enterLightSleep(sleepUs);
+#endif
+    sleptUs += micros() - start;
+    sleepCount++;
+    return true;
+}
+
+bool PowerManager::wakePinActive() {
+    for (int i = 0; i < wakePinCount; i++) {
+        if (wakePins[i].enabled && digitalRead(wakePins[i].pin) == wakePins[i].level) return true;
+    }
+    return false;
+}
+
+#ifndef NATIVE_HAL
+
+void PowerManager::enterLightSleep(unsigned long sleepUs) {
+    esp_sleep_enable_timer_wakeup(sleepUs - POWER_WAKE_LATENCY_US);
+
+    for (int i = 0; i < wakePinCount; i++) {
+        if (!wakePins[i].enabled) continue;
+        gpio_wakeup_enable((gpio_num_t)wakePins[i].pin,
+                           wakePins[i].level == HIGH ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+
+    esp_light_sleep_start();
+
+    // Wake-up reprograms the pins for level interrupts; put the edge
+    // interrupts the scheduler and the receivers use back
+    for (int i = 0; i < wakePinCount; i++) {
+        if (!wakePins[i].enabled) continue;
+        gpio_wakeup_disable((gpio_num_t)wakePins[i].pin);
+        gpio_set_intr_type((gpio_num_t)wakePins[i].pin, GPIO_INTR_ANYEDGE);
+    }
+
+    // The edge that woke us never reached the pin interrupt
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        for (int i = 0; i < wakePinCount; i++) {
+            WakePin& wake = wakePins[i];
+            if (wake.enabled && wake.scheduler && digitalRead(wake.pin) == wake.level) {
+                wake.scheduler->notify(wake.job);
+            }
+        }
+    }
+
+    // The RTOS tick stood still while asleep; let the capture task re-read
+    // micros() instead of finishing its old timeout
+    captureScheduler.wake();
+}
+
+#endif
+
+bool PowerManager::onActivity() {
+    if (displayManager.isPoweredOn()) return false;
+    displayManager.setPower(true);
+    return true;
+}
+
+void PowerManager::screenOff() {
+    if (!displayManager.isPoweredOn()) return;
+    displayManager.setPower(false);
+    screenOffCount++;
+}
+
+void PowerManager::dump(Print& out) {
+    unsigned long uptimeMs = millis();
+    out.printf("Light sleep: %s, %lu sleeps, %llu ms asleep (%lu.%lu%% of uptime)\n",
+               lightSleepEnabled ? "on" : "off", (unsigned long)sleepCount,
+               (unsigned long long)(sleptUs / 1000),
+               uptimeMs ? (unsigned long)(sleptUs / 10 / uptimeMs) : 0UL,
+               uptimeMs ? (unsigned long)(sleptUs / uptimeMs % 10) : 0UL);
+    out.printf("  skipped: %lu module held awake, %lu wake pin active\n",
+               (unsigned long)heldSkips, (unsigned long)pinSkips);
+    if (screenTimeoutMs) {
+        out.printf("Screen: %s, off after %lu ms idle, turned off %lu times\n",
+                   displayManager.isPoweredOn() ? "on" : "off",
+                   (unsigned long)screenTimeoutMs, (unsigned long)screenOffCount);
+    } else {
+        out.println("Screen: always on");
+    }
+}
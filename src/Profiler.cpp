@@ -0,0 +1,109 @@
+#include "Profiler.h"
+
+Profiler profiler;
+
+static const char* const probeNames[PROBE_COUNT] = {
+    "nfc", "ir", "ibutton", "rf", "gpio",
+    "display", "storage", "sd_read", "sd_write", "sd_scan"
+};
+
+Profiler::Profiler() {
+    reset();
+}
+
+uint8_t Profiler::bucketFor(uint32_t cycles) {
+    if (cycles < 4) return cycles;
+    
+    // Top bit picks the power of two, the two bits below it the quarter
+    int msb = 31 - __builtin_clz(cycles);
+    return (msb - 1) * 4 + ((cycles >> (msb - 2)) & 3);
+}
+
+uint32_t Profiler::bucketLowerBound(uint8_t bucket) {
+    if (bucket < 4) return bucket;
+    int msb = bucket / 4 + 1;
+    return (uint32_t)(4 + bucket % 4) << (msb - 2);
+}
+
+void Profiler::record(ProfileProbe probe, uint32_t cycles) {
+    if (probe < 0 || probe >= PROBE_COUNT) return;
+    
+    ProfileHistogram& histogram = histograms[probe];
+    histogram.count++;
+    histogram.totalCycles += cycles;
+    if (cycles < histogram.minCycles) histogram.minCycles = cycles;
+    if (cycles > histogram.maxCycles) histogram.maxCycles = cycles;
+    histogram.buckets[bucketFor(cycles)]++;
+}
+
+void Profiler::reset() {
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        memset(&histograms[i], 0, sizeof(ProfileHistogram));
+        histograms[i].minCycles = UINT32_MAX;
+    }
+}
+
+uint32_t Profiler::getPercentile(ProfileProbe probe, uint8_t percent) {
+    if (probe < 0 || probe >= PROBE_COUNT) return 0;
+    
+    const ProfileHistogram& histogram = histograms[probe];
+    if (histogram.count == 0) return 0;
+    
+    // Upper edge of the bucket holding the requested rank, clamped to
+    // what was actually seen
+    uint32_t rank = ((uint64_t)histogram.count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < PROFILER_BUCKETS; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = i + 1 < PROFILER_BUCKETS ? bucketLowerBound(i + 1) - 1 : UINT32_MAX;
+            return min(upper, histogram.maxCycles);
+        }
+    }
+    return histogram.maxCycles;
+}
+
+const char* Profiler::getProbeName(ProfileProbe probe) {
+    if (probe < 0 || probe >= PROBE_COUNT) return "";
+    return probeNames[probe];
+}
+
+void Profiler::dump(Print& out) {
+    float cyclesPerUs = ESP.getCpuFreqMHz();
+    
+    out.println("probe        count     mean_us      min_us      p50_us      p99_us      max_us");
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        ProfileProbe probe = (ProfileProbe)i;
+        const ProfileHistogram& histogram = histograms[i];
+        if (histogram.count == 0) {
+            out.printf("%-9s %8u\n", probeNames[i], 0u);
+            continue;
+        }
+        
+        out.printf("%-9s %8u %11.1f %11.1f %11.1f %11.1f %11.1f\n", probeNames[i],
+                   (unsigned)histogram.count,
+                   histogram.totalCycles / cyclesPerUs / histogram.count,
+                   histogram.minCycles / cyclesPerUs,
+                   getPercentile(probe, 50) / cyclesPerUs,
+                   getPercentile(probe, 99) / cyclesPerUs,
+                   histogram.maxCycles / cyclesPerUs);
+    }
+}
+
+void Profiler::dumpHistogram(Print& out, ProfileProbe probe) {
+    if (probe < 0 || probe >= PROBE_COUNT) return;
+    
+    float cyclesPerUs = ESP.getCpuFreqMHz();
+    const ProfileHistogram& histogram = histograms[probe];
+    
+    out.printf("%s: %u samples\n", probeNames[probe], (unsigned)histogram.count);
+    for (int i = 0; i < PROFILER_BUCKETS; i++) {
+        if (histogram.buckets[i] == 0) continue;
+        out.printf("  >= %11.2f us %8u\n", bucketLowerBound(i) / cyclesPerUs,
+                   (unsigned)histogram.buckets[i]);
+    }
+}
+
+ProfileScope::~ProfileScope() {
+    profiler.record(probe, ESP.getCycleCount() - start);
+}
@@ -1,38 +1,140 @@
 #include "RFModule.h"
 #include "StorageManager.h"
+#include "TaskManager.h"
+#include "MemoryMonitor.h"
+#include "PowerManager.h"
+#include "menu.h"
+#include <utility>
+#ifdef NATIVE_HAL
+#include <NativeHAL.h>
+#endif
 
 RFModule rfModule;
 
-// Static instance pointer for interrupt handler
-RFModule* RFModule_instance = nullptr;
+static_assert(RF_RAW_POOL_BLOCKS <= 32, "RF raw pool is tracked in one word");
 
-RFModule::RFModule() 
-    : rfInitialized(false), signalReceived(false), isReceivingSignal(false),
-      isTransmittingSignal(false), frequencyScanning(false), currentFrequency(433920000),
-      scanStartFreq(0), scanEndFreq(0), lastReceiveTime(0), rawIndex(0),
-      lastEdgeTime(0), historyCount(0), historyIndex(0) {
-    RFModule_instance = this;
+#define RF_RAW_POOL_MASK (RF_RAW_POOL_BLOCKS >= 32 ? 0xFFFFFFFFUL : (1UL << RF_RAW_POOL_BLOCKS) - 1)
+
+// Blocks for raw bursts; bit i of rawPoolUsed is set while block i is held
+// by a signal
+static uint32_t rawPool[RF_RAW_POOL_BLOCKS][RF_MAX_RAW_LENGTH];
+static uint32_t rawPoolUsed = 0;
+
+static uint32_t* claimBlock() {
+    uint32_t used = __atomic_load_n(&rawPoolUsed, __ATOMIC_RELAXED);
+    while (true) {
+        uint32_t available = ~used & RF_RAW_POOL_MASK;
+        if (!available) return nullptr;
+
+        int block = __builtin_ctz(available);
+        if (__atomic_compare_exchange_n(&rawPoolUsed, &used, used | (1UL << block), true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return rawPool[block];
+        }
+    }
 }
 
-bool RFModule::init() {
-    pinMode(RF_RECEIVER_PIN, INPUT);
-    pinMode(RF_TRANSMITTER_PIN, OUTPUT);
-    digitalWrite(RF_TRANSMITTER_PIN, LOW);
+static void returnBlock(uint32_t* block) {
+    int index = (block - rawPool[0]) / RF_MAX_RAW_LENGTH;
+    __atomic_fetch_and(&rawPoolUsed, ~(1UL << index), __ATOMIC_RELEASE);
+}
+
+int RFSignal::getPoolFree() {
+    return __builtin_popcount(~__atomic_load_n(&rawPoolUsed, __ATOMIC_RELAXED) & RF_RAW_POOL_MASK);
+}
+
+RFSignal::RFSignal()
+    : protocol(RF_UNKNOWN), frequency(0), bitrate(0), data(0), modulation(0), timestamp(0),
+      rawData(nullptr), rawLength(0) {}
+
+RFSignal::RFSignal(const RFSignal& other) : RFSignal() {
+    *this = other;
+}
+
+RFSignal::RFSignal(RFSignal&& other) : RFSignal() {
+    *this = std::move(other);
+}
+
+RFSignal::~RFSignal() {
+    clearRaw();
+}
+
+RFSignal& RFSignal::operator=(const RFSignal& other) {
+    if (this != &other) {
+        copyFields(other);
+        setRaw(other.getRaw(), other.rawLength);
+    }
+    return *this;
+}
+
+RFSignal& RFSignal::operator=(RFSignal&& other) {
+    if (this == &other) return *this;
     
-    // Initialize raw buffer
-    memset(raw#include "RFModule.h"
-#include "StorageManager.h"
+    copyFields(other);
+    clearRaw();
+    rawData = other.rawData;
+    rawLength = other.rawLength;
+    other.rawData = nullptr;
+    other.rawLength = 0;
+    return *this;
+}
 
-RFModule rfModule;
+void RFSignal::copyFields(const RFSignal& other) {
+    protocol = other.protocol;
+    name = other.name;
+    frequency = other.frequency;
+    bitrate = other.bitrate;
+    data = other.data;
+    modulation = other.modulation;
+    timestamp = other.timestamp;
+}
+
+bool RFSignal::setRaw(const uint32_t* durations, size_t length) {
+    if (!durations || length == 0) {
+        clearRaw();
+        return length == 0;
+    }
+    
+    uint32_t* raw = resizeRaw(length);
+    if (!raw) return false;
+    memcpy(raw, durations, length * sizeof(uint32_t));
+    return true;
+}
+
+uint32_t* RFSignal::resizeRaw(size_t length) {
+    if (length == 0 || length > RF_MAX_RAW_LENGTH) {
+        clearRaw();
+        return nullptr;
+    }
+    
+    if (!rawData) {
+        rawData = claimBlock();
+        if (!rawData) {
+            rawLength = 0;
+            return nullptr;
+        }
+    }
+    rawLength = length;
+    return rawData;
+}
+
+void RFSignal::clearRaw() {
+    if (rawData) {
+        returnBlock(rawData);
+        rawData = nullptr;
+    }
+    rawLength = 0;
+}
 
 // Static instance pointer for interrupt handler
 RFModule* RFModule_instance = nullptr;
 
 RFModule::RFModule() 
-    : rfInitialized(false), signalReceived(false), isReceivingSignal(false),
+    : Module(MODULE_RF, "rf"), rfInitialized(false), signalReceived(false), isReceivingSignal(false),
       isTransmittingSignal(false), frequencyScanning(false), currentFrequency(433920000),
-      scanStartFreq(300000000), scanEndFreq(928000000), lastReceiveTime(0),
-      rawIndex(0), lastEdgeTime(0), historyCount(0), historyIndex(0) {
+      scanStartFreq(300000000), scanEndFreq(928000000), lastReceiveTime(0), lastScanStepTime(0),
+      lastLevel(LOW), rawIndex(0), burstOpen(false), lastEdgeTime(0), lastEdgeLevel(LOW),
+      burstOverflows(0), truncatedEdges(0), burstLost(0), historyCount(0), historyIndex(0) {
     RFModule_instance = this;
 }
 
@@ -56,10 +158,12 @@ bool RFModule::init() {
 void RFModule::update() {
     if (!rfInitialized) return;
     
-    unsigned long currentTime = millis();
+    unsigned long currentTime = micros();
     
     // Handle frequency scanning
-    if (frequencyScanning) {
+    if (frequencyScanning && (currentTime - lastScanStepTime >= RF_SCAN_DWELL_US)) {
+        lastScanStepTime = currentTime;
+        
         // Step through frequencies
         currentFrequency += 100000; // 100kHz steps
         if (currentFrequency > scanEndFreq) {
@@ -68,19 +172,85 @@ void RFModule::update() {
         setFrequency(currentFrequency);
     }
     
-    // Check for received signals
-    if (isReceivingSignal && (currentTime - lastEdgeTime > 200)) {
-        // Signal reception timeout, process received data
-        if (rawIndex > 10) { // Minimum signal length
-            signalReceived = true;
-            if (decodeSignal(&currentSignal)) {
-                addToHistory(&currentSignal);
-            }
-        }
+    if (!isReceivingSignal) return;
+    
+    Edge edge;
+    while (edgeRing.pop(&edge)) {
+        addEdge(edge);
+    }
+    
+    // Quiet for the whole timeout: the burst is complete
+    if (edgeRing.isEmpty() && (uint32_t)micros() - lastEdgeTime >= RF_RECEIVE_TIMEOUT_US) {
+        finishBurst();
         stopReceiving();
     }
 }
 
+void RFModule::addEdge(const Edge& edge) {
+    if (!burstOpen) {
+        // A falling edge first ends a high of unknown length: wait for the
+        // line to rise
+        lastEdgeTime = edge.timestamp;
+        lastEdgeLevel = edge.level;
+        if (edge.level != HIGH) return;
+        
+        burstOpen = true;
+        rawIndex = 0;
+        burstLost = 0;
+        burstOverflows = edgeRing.getOverflows();
+        return;
+    }
+    
+    // Edges between these two were dropped from a full ring: the level
+    // runs on (the loss is counted from the ring at the end of the burst)
+    if (edge.level == lastEdgeLevel) return;
+    
+    if (rawIndex < MAX_RAW_LENGTH) {
+        rawBuffer[rawIndex++] = edge.timestamp - lastEdgeTime;
+    } else {
+        truncatedEdges++;
+        burstLost++;
+    }
+    lastEdgeTime = edge.timestamp;
+    lastEdgeLevel = edge.level;
+}
+
+void RFModule::finishBurst() {
+    if (!burstOpen) return;
+    burstOpen = false;
+    
+    burstLost += edgeRing.getOverflows() - burstOverflows;
+    if (burstLost > 0) {
+        Serial.printf("RF burst incomplete: %lu edges lost\n", (unsigned long)burstLost);
+    }
+    
+    if (rawIndex > 10) { // Minimum signal length
+        signalReceived = true;
+#ifdef NATIVE_HAL
+        uint64_t decodeStart = nativeHAL.hostNanos();
+#endif
+        bool decoded = decodeSignal(&currentSignal);
+#ifdef NATIVE_HAL
+        nativeHAL.notifyDecode("rf", rawIndex, decoded && currentSignal.protocol != RF_RAW,
+                               nativeHAL.hostNanos() - decodeStart);
+#endif
+        if (decoded) {
+            addToHistory(&currentSignal);
+        }
+    }
+}
+
+void RFModule::onEvent(const ModuleEvent& event) {
+    if (event.actionId != RF_SCAN) return;
+    
+    // Capture runs on the other core; hand it the scan request
+    if (event.type == MODULE_EVENT_ACTION_START) {
+        taskManager.sendCommand(CAPTURE_CMD_RF_LEARN_START);
+    } else {
+        taskManager.sendCommand(CAPTURE_CMD_RF_LEARN_STOP);
+    }
+}
+
 bool RFModule::receiveSignal() {
     if (!rfInitialized) return false;
     
@@ -89,7 +259,9 @@ bool RFModule::receiveSignal() {
 }
 
 bool RFModule::decodeSignal(RFSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_RF_DECODE);
     if (!signal || rawIndex < 10) return false;
+    signal->clearRaw();
     
     // Try different protocol decoders
     if (decodeASK(signal)) {
@@ -114,9 +286,9 @@ bool RFModule::decodeSignal(RFSignal* signal) {
     
     // If no protocol matched, store as raw
     signal->protocol = RF_RAW;
-    signal->rawLength = rawIndex;
-    signal->rawData = new uint8_t[rawIndex];
-    memcpy(signal->rawData, rawBuffer, rawIndex);
+    if (!signal->setRaw(rawBuffer, rawIndex)) {
+        Serial.println("RF raw capture kept without durations: raw pool is out of blocks");
+    }
     signal->frequency = currentFrequency;
     signal->bitrate = 4800; // Default bitrate
     signal->name = generateSignalName(RF_RAW, currentFrequency);
@@ -154,7 +326,7 @@ bool RFModule::transmitSignal(const RFSignal* signal) {
             success = transmitFSK(signal->data, 32, signal->frequency);
             break;
         case RF_RAW:
-            success = transmitRaw(signal->rawData, signal->rawLength, signal->frequency);
+            success = transmitRaw(signal->getRaw(), signal->getRawLength(), signal->frequency);
             break;
         default:
             break;
@@ -225,20 +397,13 @@ bool RFModule::transmitFSK(uint32_t data, uint8_t bits, uint32_t frequency) {
     return true;
 }
 
-bool RFModule::transmitRaw(uint8_t* data, size_t length, uint32_t frequency) {
-    if (!rfInitialized || !data) return false;
+bool RFModule::transmitRaw(const uint32_t* durations, size_t length, uint32_t frequency) {
+    if (!rfInitialized || !durations) return false;
     
-    // Raw data transmission
+    // The captured pulses as they came in, high first
     for (size_t i = 0; i < length; i++) {
-        uint8_t byte = data[i];
-        for (int bit = 7; bit >= 0; bit--) {
-            if (byte & (1 << bit)) {
-                digitalWrite(RF_TRANSMITTER_PIN, HIGH);
-            } else {
-                digitalWrite(RF_TRANSMITTER_PIN, LOW);
-            }
-            delayMicroseconds(208); // ~4800 bps
-        }
+        digitalWrite(RF_TRANSMITTER_PIN, i % 2 == 0 ? HIGH : LOW);
+        delayMicroseconds(durations[i]);
     }
     
     digitalWrite(RF_TRANSMITTER_PIN, LOW);
@@ -251,6 +416,7 @@ void RFModule::startFrequencyScan(uint32_t startFreq, uint32_t endFreq) {
     scanStartFreq = startFreq;
     scanEndFreq = endFreq;
     currentFrequency = startFreq;
+    lastScanStepTime = micros();
     frequencyScanning = true;
     
     startReceiving();
@@ -270,6 +436,7 @@ uint32_t RFModule::getCurrentScanFrequency() {
 }
 
 bool RFModule::saveSignal(const RFSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_RF_SAVE);
     if (!signal) return false;
     
     String filename = RF_DIR + String("/") + signal->name + RF_EXT;
@@ -283,11 +450,13 @@ bool RFModule::saveSignal(const RFSignal* signal) {
     doc["modulation"] = signal->modulation;
     doc["timestamp"] = signal->timestamp;
     
-    if (signal->protocol == RF_RAW && signal->rawData) {
-        doc["rawLength"] = signal->rawLength;
-        JsonArray rawArray = doc.createNestedArray("rawData");
-        for (size_t i = 0; i < signal->rawLength; i++) {
-            rawArray.add(signal->rawData[i]);
+    // Durations in us; older files have "rawData" in clipped 10 us steps
+    if (signal->protocol == RF_RAW && signal->getRaw()) {
+        const uint32_t* rawData = signal->getRaw();
+        doc["rawLength"] = signal->getRawLength();
+        JsonArray rawArray = doc.createNestedArray("rawDurations");
+        for (size_t i = 0; i < signal->getRawLength(); i++) {
+            rawArray.add(rawData[i]);
         }
     }
     
@@ -295,6 +464,7 @@ bool RFModule::saveSignal(const RFSignal* signal) {
 }
 
 bool RFModule::loadSignal(const String& filename, RFSignal* signal) {
+    MEMORY_SITE(MEMORY_SITE_RF_LOAD);
     if (!signal) return false;
     
     JsonDocument doc;
@@ -310,12 +480,16 @@ bool RFModule::loadSignal(const String& filename, RFSignal* signal) {
     signal->modulation = doc["modulation"].as<uint8_t>();
     signal->timestamp = doc["timestamp"].as<unsigned long>();
     
-    if (signal->protocol == RF_RAW && doc.containsKey("rawData")) {
-        signal->rawLength = doc["rawLength"].as<size_t>();
-        signal->rawData = new uint8_t[signal->rawLength];
-        JsonArray rawArray = doc["rawData"];
-        for (size_t i = 0; i < signal->rawLength; i++) {
-            signal->rawData[i] = rawArray[i];
+    signal->clearRaw();
+    bool durations = doc.containsKey("rawDurations");
+    if (signal->protocol == RF_RAW && (durations || doc.containsKey("rawData"))) {
+        uint32_t scale = durations ? 1 : 10;
+        JsonArray rawArray = doc[durations ? "rawDurations" : "rawData"];
+        size_t rawLength = min(doc["rawLength"].as<size_t>(), rawArray.size());
+        uint32_t* rawData = signal->resizeRaw(rawLength);
+        if (rawLength && !rawData) return false;
+        for (size_t i = 0; i < rawLength; i++) {
+            rawData[i] = rawArray[i].as<uint32_t>() * scale;
         }
     }
     
@@ -337,7 +511,22 @@ String RFModule::getSignalFilename(int index) {
 void RFModule::addToHistory(const RFSignal* signal) {
     if (!signal) return;
     
-    history[historyIndex] = *signal;
+    RFSignal& entry = history[historyIndex];
+    entry = *signal;
+    
+    // The oldest raw bursts give up their durations until this one has its
+    // own and the pool still has blocks for loading and sending signals
+    for (int i = 0; i < historyCount && (entry.getRawLength() != signal->getRawLength() ||
+                                         RFSignal::getPoolFree() < RF_RAW_POOL_RESERVE); i++) {
+        RFSignal& oldest = history[(historyIndex - historyCount + i + MAX_HISTORY) % MAX_HISTORY];
+        if (&oldest != &entry && oldest.hasBlock()) {
+            oldest.clearRaw();
+            if (entry.getRawLength() != signal->getRawLength()) {
+                entry.setRaw(signal->getRaw(), signal->getRawLength());
+            }
+        }
+    }
+    
     historyIndex = (historyIndex + 1) % MAX_HISTORY;
     if (historyCount < MAX_HISTORY) {
         historyCount++;
@@ -345,6 +534,10 @@ void RFModule::addToHistory(const RFSignal* signal) {
 }
 
 void RFModule::clearHistory() {
+    // Hand the raw blocks back to the pool
+    for (int i = 0; i < MAX_HISTORY; i++) {
+        history[i].clearRaw();
+    }
     historyCount = 0;
     historyIndex = 0;
 }
@@ -369,13 +562,29 @@ bool RFModule::isTransmitting() {
     return isTransmittingSignal;
 }
 
+unsigned long RFModule::getNextDeadline() {
+    // Whichever comes first: the next drain of the ring, the next scan step
+    // or the reception timeout (from the last edge drained)
+    unsigned long deadline = micros() + RF_DRAIN_INTERVAL_US;
+    unsigned long timeout = lastEdgeTime + RF_RECEIVE_TIMEOUT_US;
+    if ((long)(timeout - deadline) < 0) deadline = timeout;
+    if (!frequencyScanning) return deadline;
+    
+    unsigned long nextStep = lastScanStepTime + RF_SCAN_DWELL_US;
+    return (long)(nextStep - deadline) < 0 ? nextStep : deadline;
+}
+
 void RFModule::startReceiving() {
     if (!rfInitialized) return;
     
+    edgeRing.clear();
     rawIndex = 0;
+    burstOpen = false;
     signalReceived = false;
     isReceivingSignal = true;
-    lastEdgeTime = millis();
+    lastEdgeTime = micros();
+    lastLevel = digitalRead(RF_RECEIVER_PIN);
+    lastEdgeLevel = lastLevel;
     
     // Attach interrupt
     attachInterrupt(digitalPinToInterrupt(RF_RECEIVER_PIN), rfInterruptHandler, CHANGE);
@@ -383,19 +592,25 @@ void RFModule::startReceiving() {
 
 void RFModule::stopReceiving() {
     isReceivingSignal = false;
+    burstOpen = false;
     detachInterrupt(digitalPinToInterrupt(RF_RECEIVER_PIN));
+    powerManager.releaseAwake(MODULE_RF);
 }
 
-void RFModule::captureRawData() {
-    if (rawIndex < MAX_RAW_LENGTH - 1) {
-        unsigned long currentTime = micros();
-        uint8_t duration = min(255, (currentTime - lastEdgeTime) / 10); // Scale to fit uint8_t
-        rawBuffer[rawIndex++] = duration;
-        lastEdgeTime = currentTime;
-    }
+void IRAM_ATTR RFModule::captureEdge() {
+    // Waking from light sleep leaves a level interrupt behind that can fire
+    // more than once; only a level change is an edge
+    uint8_t level = digitalRead(RF_RECEIVER_PIN);
+    if (level == lastLevel) return;
+    lastLevel = level;
+    
+    // No light sleep until update() has drained and processed the burst
+    powerManager.holdAwake(MODULE_RF);
+    edgeRing.push(micros(), level);
 }
 
 String RFModule::generateSignalName(RFProtocol protocol, uint32_t frequency) {
+    MEMORY_SITE(MEMORY_SITE_SIGNAL_NAME);
     String protocolName = getProtocolString(protocol);
     String freqStr = String(frequency / 1000000.0, 2) + "MHz";
     return protocolName + "_" + freqStr + "_" + String(millis() % 10000);
@@ -416,13 +631,13 @@ bool RFModule::decodeASK(RFSignal* signal) {
     int validBits = 0;
     
     // Simple threshold-based decoding
-    uint8_t threshold = 50; // Adjust based on signal characteristics
+    uint32_t threshold = 500; // us; adjust based on signal characteristics
     
     for (size_t i = 0; i < rawIndex && validBits < 32; i++) {
         if (rawBuffer[i] > threshold) {
             data = (data << 1) | 1;
             validBits++;
-        } else if (rawBuffer[i] > 10) { // Ignore very short pulses (noise)
+        } else if (rawBuffer[i] > 100) { // Ignore very short pulses (noise)
             data = (data << 1) | 0;
             validBits++;
         }
@@ -457,8 +672,8 @@ bool RFModule::decodeManchester(RFSignal* signal) {
     // Manchester decoding: transition in middle of bit period
     // Rising edge = 0, falling edge = 1 (or vice versa)
     for (size_t i = 0; i < rawIndex - 1 && validBits < 32; i += 2) {
-        uint8_t firstHalf = rawBuffer[i];
-        uint8_t secondHalf = rawBuffer[i + 1];
+        uint32_t firstHalf = rawBuffer[i];
+        uint32_t secondHalf = rawBuffer[i + 1];
         
         // Look for transitions
         if (firstHalf < secondHalf) {
@@ -493,6 +708,6 @@ bool RFModule::decodePWM(RFSignal* signal) {
 
 void IRAM_ATTR RFModule::rfInterruptHandler() {
     if (RFModule_instance && RFModule_instance->isReceivingSignal) {
-        RFModule_instance->captureRawData();
+        RFModule_instance->captureEdge();
     }
 }
@@ -0,0 +1,217 @@
+#include "Scheduler.h"
+#ifdef NATIVE_HAL
+#include <NativeHAL.h>
+#endif
+
+Scheduler captureScheduler("capture");
+Scheduler uiScheduler("ui");
+
+static inline bool isDue(unsigned long deadline, unsigned long now) {
+    return (long)(deadline - now) <= 0;
+}
+
+Scheduler::Scheduler(const char* name)
+    : schedulerName(name), jobCount(0), pendingMask(0), pinWakeCount(0), wakeups(0),
+      running(false), idleUntil(0)
+#ifdef NATIVE_HAL
+      , timerDriven(false), timerId(0)
+#else
+      , taskHandle(nullptr)
+#endif
+{
+}
+
+int Scheduler::addJob(const char* name, SchedulerJob job, unsigned long periodUs) {
+    if (!job || jobCount >= SCHEDULER_MAX_JOBS) return -1;
+
+    Job& entry = jobs[jobCount];
+    entry.name = name;
+    entry.run = job;
+    entry.periodUs = periodUs;
+    entry.deadline = micros() + periodUs;
+    entry.armed = periodUs > 0;
+    entry.runs = 0;
+
+    return jobCount++;
+}
+
+bool Scheduler::wakeOnPin(uint8_t pin, int id, int mode) {
+    if (id < 0 || id >= jobCount || pinWakeCount >= SCHEDULER_MAX_PINS) return false;
+
+    PinWake& wake = pinWakes[pinWakeCount++];
+    wake.scheduler = this;
+    wake.id = id;
+    attachInterruptArg(digitalPinToInterrupt(pin), pinWakeISR, &wake, mode);
+    return true;
+}
+
+void Scheduler::scheduleAt(int id, unsigned long atMicros) {
+    if (id < 0 || id >= jobCount) return;
+    jobs[id].deadline = atMicros;
+    jobs[id].armed = true;
+    wakeTask();
+}
+
+void Scheduler::scheduleIn(int id, unsigned long delayUs) {
+    scheduleAt(id, micros() + delayUs);
+}
+
+void Scheduler::cancel(int id) {
+    if (id < 0 || id >= jobCount) return;
+    jobs[id].armed = false;
+}
+
+void Scheduler::notify(int id) {
+    if (id < 0 || id >= jobCount) return;
+    __atomic_fetch_or(&pendingMask, 1UL << id, __ATOMIC_RELEASE);
+    wakeTask();
+}
+
+void IRAM_ATTR Scheduler::notifyFromISR(int id) {
+    if (id < 0 || id >= jobCount) return;
+    __atomic_fetch_or(&pendingMask, 1UL << id, __ATOMIC_RELEASE);
+
+#ifdef NATIVE_HAL
+    wakeTask();
+#else
+    if (taskHandle) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(taskHandle, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    }
+#endif
+}
+
+void Scheduler::begin() {
+#ifndef NATIVE_HAL
+    taskHandle = xTaskGetCurrentTaskHandle();
+#endif
+}
+
+unsigned long Scheduler::runDue() {
+    __atomic_store_n(&running, true, __ATOMIC_RELEASE);
+    uint32_t pending = __atomic_exchange_n(&pendingMask, 0, __ATOMIC_ACQUIRE);
+    unsigned long now = micros();
+
+    for (int i = 0; i < jobCount; i++) {
+        Job& job = jobs[i];
+        bool notified = pending & (1UL << i);
+        bool expired = job.armed && isDue(job.deadline, now);
+        if (!notified && !expired) continue;
+
+        if (notified && !job.armed && job.periodUs > 0) {
+            job.deadline = now + job.periodUs;
+            job.armed = true;
+        }
+        
+        if (expired) {
+            if (job.periodUs > 0) {
+                // Keep the phase, but never try to catch up on missed periods
+                job.deadline += job.periodUs;
+                if (isDue(job.deadline, now)) job.deadline = now + job.periodUs;
+            } else {
+                job.armed = false;
+            }
+        }
+
+        job.runs++;
+        job.run();
+    }
+
+    // Anything notified or re-armed in the past while we were running
+    unsigned long sleepUs = pendingMask ? 0 : nextSleepUs();
+    idleUntil = micros() + sleepUs;
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    return sleepUs;
+}
+
+unsigned long Scheduler::nextSleepUs() {
+    unsigned long now = micros();
+    unsigned long sleepUs = SCHEDULER_MAX_SLEEP_US;
+    for (int i = 0; i < jobCount; i++) {
+        if (!jobs[i].armed) continue;
+        if (isDue(jobs[i].deadline, now)) return 0;
+        unsigned long remaining = jobs[i].deadline - now;
+        if (remaining < sleepUs) sleepUs = remaining;
+    }
+    return sleepUs;
+}
+
+void Scheduler::wait(unsigned long timeoutUs) {
+    if (timeoutUs == 0) return;
+    wakeups++;
+
+#ifdef NATIVE_HAL
+    // Step through virtual time one event at a time so that an interrupt
+    // that notifies a job ends the wait at its exact timestamp
+    uint64_t deadline = nativeHAL.nowMicros() + timeoutUs;
+    while (!pendingMask && nativeHAL.nowMicros() < deadline) {
+        nativeHAL.advanceTo(min(deadline, nativeHAL.nextEventMicros()));
+        nativeHAL.checkRunLimit();
+    }
+#else
+    // Round up so a deadline is never reported early
+    const unsigned long tickUs = portTICK_PERIOD_MS * 1000UL;
+    TickType_t ticks = (timeoutUs + tickUs - 1) / tickUs;
+    ulTaskNotifyTake(pdTRUE, ticks);
+#endif
+}
+
+unsigned long Scheduler::getIdleUs() {
+    if (__atomic_load_n(&running, __ATOMIC_ACQUIRE) || pendingMask) return 0;
+    long remaining = (long)(idleUntil - micros());
+    return remaining > 0 ? remaining : 0;
+}
+
+const char* Scheduler::getJobName(int id) {
+    if (id < 0 || id >= jobCount) return "";
+    return jobs[id].name;
+}
+
+uint32_t Scheduler::getJobRuns(int id) {
+    if (id < 0 || id >= jobCount) return 0;
+    return jobs[id].runs;
+}
+
+void Scheduler::wakeTask() {
+#ifdef NATIVE_HAL
+    if (timerDriven) armTimer(0);
+#else
+    if (taskHandle && taskHandle != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(taskHandle);
+    }
+#endif
+}
+
+void IRAM_ATTR Scheduler::pinWakeISR(void* arg) {
+    PinWake* wake = (PinWake*)arg;
+    wake->scheduler->notifyFromISR(wake->id);
+}
+
+#ifdef NATIVE_HAL
+
+void Scheduler::startTimer() {
+    timerDriven = true;
+    armTimer(0);
+}
+
+void Scheduler::armTimer(unsigned long delayUs) {
+    // Only one pending wake-up at a time
+    if (timerId) nativeHAL.cancelCallback(timerId);
+    timerId = nativeHAL.scheduleCallback(nativeHAL.nowMicros() + delayUs, timerCallback, this);
+}
+
+void Scheduler::timerCallback(void* arg) {
+    Scheduler* scheduler = (Scheduler*)arg;
+    scheduler->timerId = 0;
+    scheduler->wakeups++;
+
+    // Jobs that re-arm themselves would re-enter here through wakeTask()
+    scheduler->timerDriven = false;
+    unsigned long sleepUs = scheduler->runDue();
+    scheduler->timerDriven = true;
+
+    scheduler->armTimer(sleepUs);
+}
+
+#endif
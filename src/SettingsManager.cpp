@@ -1,5 +1,6 @@
 #include "SettingsManager.h"
 #include "StorageManager.h"
+#include "Module.h"
 
 SettingsManager settingsManager;
 
@@ -95,7 +96,7 @@ void SettingsManager::setAutoSleep(bool enabled) {
     if (isInitialized()) saveSettings();
 }
 
-void SettingsManager::setSleepTimeout(uint16_t timeout) {
+void SettingsManager::setSleepTimeout(uint32_t timeout) {
     settings.sleepTimeout = timeout;
     if (isInitialized()) saveSettings();
 }
@@ -168,6 +169,20 @@ bool SettingsManager::isModuleEnabled(const String& module) {
     return false;
 }
 
+void SettingsManager::setIRCarrierSensor(bool fitted) {
+    settings.irCarrierSensor = fitted;
+}
+
+uint32_t SettingsManager::getEnabledModules() {
+    uint32_t mask = 0;
+    if (settings.nfcEnabled) mask |= MODULE_BIT(MODULE_NFC);
+    if (settings.irEnabled) mask |= MODULE_BIT(MODULE_IR);
+    if (settings.iButtonEnabled) mask |= MODULE_BIT(MODULE_IBUTTON);
+    if (settings.rfEnabled) mask |= MODULE_BIT(MODULE_RF);
+    if (settings.gpioEnabled) mask |= MODULE_BIT(MODULE_GPIO);
+    return mask;
+}
+
 void SettingsManager::setDefaultSettings() {
     // Display settings
     settings.brightness = 128;
@@ -201,6 +216,7 @@ void SettingsManager::setDefaultSettings() {
     settings.iButtonEnabled = true;
     settings.rfEnabled = true;
     settings.gpioEnabled = true;
+    settings.irCarrierSensor = false;
 }
 
 bool SettingsManager::validateSettings() {
@@ -270,6 +286,7 @@ JsonDocument SettingsManager::settingsToJson() {
     modules["ibutton"] = settings.iButtonEnabled;
     modules["rf"] = settings.rfEnabled;
     modules["gpio"] = settings.gpioEnabled;
+    modules["irCarrierSensor"] = settings.irCarrierSensor;
     
     return doc;
 }
@@ -278,7 +295,7 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
     try {
         // Display settings
         if (doc.containsKey("display")) {
-            JsonObject display = doc["display"];
+            JsonObjectConst display = doc["display"];
             settings.brightness = display["brightness"] | settings.brightness;
             settings.contrast = display["contrast"] | settings.contrast;
             settings.autoSleep = display["autoSleep"] | settings.autoSleep;
@@ -288,7 +305,7 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
         
         // Sound settings
         if (doc.containsKey("sound")) {
-            JsonObject sound = doc["sound"];
+            JsonObjectConst sound = doc["sound"];
             settings.soundEnabled = sound["enabled"] | settings.soundEnabled;
             settings.volume = sound["volume"] | settings.volume;
             settings.beepFrequency = sound["beepFrequency"] | settings.beepFrequency;
@@ -297,7 +314,7 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
         
         // Storage settings
         if (doc.containsKey("storage")) {
-            JsonObject storage = doc["storage"];
+            JsonObjectConst storage = doc["storage"];
             settings.autoSave = storage["autoSave"] | settings.autoSave;
             settings.maxHistoryItems = storage["maxHistoryItems"] | settings.maxHistoryItems;
             settings.compressData = storage["compressData"] | settings.compressData;
@@ -305,7 +322,7 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
         
         // System settings
         if (doc.containsKey("system")) {
-            JsonObject system = doc["system"];
+            JsonObjectConst system = doc["system"];
             settings.deviceName = system["deviceName"] | settings.deviceName;
             settings.debugMode = system["debugMode"] | settings.debugMode;
             settings.baudRate = system["baudRate"] | settings.baudRate;
@@ -313,7 +330,7 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
         
         // WiFi settings
         if (doc.containsKey("wifi")) {
-            JsonObject wifi = doc["wifi"];
+            JsonObjectConst wifi = doc["wifi"];
             settings.wifiEnabled = wifi["enabled"] | settings.wifiEnabled;
             settings.wifiSSID = wifi["ssid"] | settings.wifiSSID;
             settings.wifiPassword = wifi["password"] | settings.wifiPassword;
@@ -321,12 +338,13 @@ bool SettingsManager::jsonToSettings(const JsonDocument& doc) {
         
         // Module settings
         if (doc.containsKey("modules")) {
-            JsonObject modules = doc["modules"];
+            JsonObjectConst modules = doc["modules"];
             settings.nfcEnabled = modules["nfc"] | settings.nfcEnabled;
             settings.irEnabled = modules["ir"] | settings.irEnabled;
             settings.iButtonEnabled = modules["ibutton"] | settings.iButtonEnabled;
             settings.rfEnabled = modules["rf"] | settings.rfEnabled;
             settings.gpioEnabled = modules["gpio"] | settings.gpioEnabled;
+            settings.irCarrierSensor = modules["irCarrierSensor"] | settings.irCarrierSensor;
         }
         
         // Validate loaded settings
@@ -1,4 +1,5 @@
 #include "StorageManager.h"
+#include "Profiler.h"
 
 StorageManager storageManager;
 
@@ -29,10 +30,11 @@ bool StorageManager::init() {
 }
 
 void StorageManager::update() {
+    PROFILE_SCOPE(PROBE_STORAGE_UPDATE);
     unsigned long currentTime = millis();
     
-    // Check SD card status periodically (every 5 seconds)
-    if (currentTime - lastUpdate > 5000) {
+    // Check SD card status periodically
+    if (currentTime - lastUpdate >= STORAGE_CHECK_INTERVAL_MS) {
         bool wasMonted = sdMounted;
         
         // Check if SD card is still present
@@ -139,6 +141,7 @@ bool StorageManager::directoryExists(const String& path) {
 }
 
 int StorageManager::getFileCount(const String& directory) {
+    PROFILE_SCOPE(PROBE_SD_SCAN);
     if (!sdMounted) return 0;
     
     File dir = SD.open(directory);
@@ -161,6 +164,7 @@ int StorageManager::getFileCount(const String& directory) {
 }
 
 String StorageManager::getFileName(const String& directory, int index) {
+    PROFILE_SCOPE(PROBE_SD_SCAN);
     if (!sdMounted) return "";
     
     File dir = SD.open(directory);
@@ -189,6 +193,7 @@ String StorageManager::getFileName(const String& directory, int index) {
 }
 
 bool StorageManager::writeFile(const String& path, const String& data) {
+    PROFILE_SCOPE(PROBE_SD_WRITE);
     if (!sdMounted) {
         setError("SD Card not available");
         return false;
@@ -220,6 +225,7 @@ bool StorageManager::writeFile(const String& path, const String& data) {
 }
 
 bool StorageManager::readFile(const String& path, String& data) {
+    PROFILE_SCOPE(PROBE_SD_READ);
     if (!sdMounted) {
         setError("SD Card not available");
         return false;
@@ -243,6 +249,7 @@ bool StorageManager::readFile(const String& path, String& data) {
 }
 
 bool StorageManager::appendFile(const String& path, const String& data) {
+    PROFILE_SCOPE(PROBE_SD_WRITE);
     if (!sdMounted) {
         setError("SD Card not available");
         return false;
@@ -321,6 +328,7 @@ bool StorageManager::readJsonFile(const String& path, JsonDocument& doc) {
 }
 
 bool StorageManager::writeBinaryFile(const String& path, const uint8_t* data, size_t size) {
+    PROFILE_SCOPE(PROBE_SD_WRITE);
     if (!sdMounted || !data) {
         setError("SD Card not available or invalid data");
         return false;
@@ -347,6 +355,7 @@ bool StorageManager::writeBinaryFile(const String& path, const uint8_t* data, si
 }
 
 bool StorageManager::readBinaryFile(const String& path, uint8_t* data, size_t& size) {
+    PROFILE_SCOPE(PROBE_SD_READ);
     if (!sdMounted || !data) {
         setError("SD Card not available or invalid buffer");
         return false;
@@ -377,6 +386,50 @@ bool StorageManager::readBinaryFile(const String& path, uint8_t* data, size_t& s
     return (bytesRead == fileSize);
 }
 
+bool StorageManager::appendBinaryFile(const String& path, const uint8_t* data, size_t size) {
+    PROFILE_SCOPE(PROBE_SD_WRITE);
+    if (!sdMounted || !data) {
+        setError("SD Card not available or invalid data");
+        return false;
+    }
+    
+    File file = SD.open(path, FILE_APPEND);
+    if (!file) {
+        setError("Failed to open file for appending: " + path);
+        return false;
+    }
+    
+    size_t bytesWritten = file.write(data, size);
+    file.close();
+    
+    return (bytesWritten == size);
+}
+
+bool StorageManager::readBinaryAt(const String& path, size_t offset, uint8_t* data, size_t size) {
+    PROFILE_SCOPE(PROBE_SD_READ);
+    if (!sdMounted || !data) {
+        setError("SD Card not available or invalid buffer");
+        return false;
+    }
+    
+    File file = SD.open(path, FILE_READ);
+    if (!file) {
+        setError("Failed to open file for binary reading: " + path);
+        return false;
+    }
+    
+    if (offset + size > file.size() || !file.seek(offset)) {
+        file.close();
+        setError("Read past the end of file: " + path);
+        return false;
+    }
+    
+    size_t bytesRead = file.read(data, size);
+    file.close();
+    
+    return (bytesRead == size);
+}
+
 bool StorageManager::backupSettings() {
     if (!sdMounted) return false;
     
@@ -536,6 +589,7 @@ void StorageManager::createDefaultDirectories() {
     ensureDirectoryExists(SETTINGS_DIR);
     ensureDirectoryExists(NFC_DIR);
     ensureDirectoryExists(IR_DIR);
+    ensureDirectoryExists(IR_REMOTE_DIR);
     ensureDirectoryExists(IBUTTON_DIR);
     ensureDirectoryExists(RF_DIR);
     ensureDirectoryExists(GPIO_DIR);
@@ -0,0 +1,170 @@
+#include "TaskManager.h"
+#include "PowerManager.h"
+
+TaskManager taskManager;
+
+TaskManager::TaskManager()
+    : commandJob(-1), eventJob(-1), running(false),
+      droppedEvents(0), droppedCommands(0)
+#ifdef NATIVE_HAL
+      , eventHead(0), eventCount(0), commandHead(0), commandCount(0)
+#else
+      , eventQueue(nullptr), commandQueue(nullptr), captureHandle(nullptr), uiHandle(nullptr)
+#endif
+{
+}
+
+bool TaskManager::begin(int captureCommandJob, int uiEventJob) {
+    commandJob = captureCommandJob;
+    eventJob = uiEventJob;
+
+#ifdef NATIVE_HAL
+    captureScheduler.startTimer();
+#else
+    eventQueue = xQueueCreate(CAPTURE_EVENT_QUEUE_LENGTH, sizeof(CaptureEvent));
+    commandQueue = xQueueCreate(CAPTURE_COMMAND_QUEUE_LENGTH, sizeof(CaptureCommand));
+    if (!eventQueue || !commandQueue) {
+        Serial.println("Failed to create task queues");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(captureTask, "capture", CAPTURE_TASK_STACK, this,
+                                CAPTURE_TASK_PRIORITY, &captureHandle, CAPTURE_TASK_CORE) != pdPASS) {
+        Serial.println("Failed to start capture task");
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(uiTask, "ui", UI_TASK_STACK, this,
+                                UI_TASK_PRIORITY, &uiHandle, UI_TASK_CORE) != pdPASS) {
+        Serial.println("Failed to start UI task");
+        return false;
+    }
+#endif
+
+    running = true;
+    Serial.printf("Tasks started: capture on core %d, UI on core %d\n", CAPTURE_TASK_CORE, UI_TASK_CORE);
+    return true;
+}
+
+void TaskManager::loop() {
+#ifdef NATIVE_HAL
+    runUI();
+#else
+    // Both halves run in their own tasks (setup() does not return when they
+    // fail to start); the Arduino loop task is not needed
+    vTaskDelete(NULL);
+#endif
+}
+
+void TaskManager::runUI() {
+    unsigned long sleepUs = uiScheduler.runDue();
+    if (!powerManager.sleep(sleepUs)) {
+        uiScheduler.wait(sleepUs);
+    }
+}
+
+uint32_t TaskManager::getCaptureStackHighWater() {
+#ifdef NATIVE_HAL
+    return 0;
+#else
+    // ESP-IDF reports the watermark in bytes
+    return captureHandle ? uxTaskGetStackHighWaterMark(captureHandle) : 0;
+#endif
+}
+
+uint32_t TaskManager::getUIStackHighWater() {
+#ifdef NATIVE_HAL
+    return 0;
+#else
+    return uiHandle ? uxTaskGetStackHighWaterMark(uiHandle) : 0;
+#endif
+}
+
+#ifdef NATIVE_HAL
+
+bool TaskManager::postEvent(const CaptureEvent& event) {
+    if (eventCount >= CAPTURE_EVENT_QUEUE_LENGTH) {
+        droppedEvents++;
+        return false;
+    }
+    eventBuffer[(eventHead + eventCount) % CAPTURE_EVENT_QUEUE_LENGTH] = event;
+    eventCount++;
+    uiScheduler.notify(eventJob);
+    return true;
+}
+
+bool TaskManager::receiveEvent(CaptureEvent* event) {
+    if (!event || eventCount == 0) return false;
+    *event = eventBuffer[eventHead];
+    eventHead = (eventHead + 1) % CAPTURE_EVENT_QUEUE_LENGTH;
+    eventCount--;
+    return true;
+}
+
+bool TaskManager::sendCommand(CaptureCommandType type, uint32_t value) {
+    if (commandCount >= CAPTURE_COMMAND_QUEUE_LENGTH) {
+        droppedCommands++;
+        return false;
+    }
+    CaptureCommand& command = commandBuffer[(commandHead + commandCount) % CAPTURE_COMMAND_QUEUE_LENGTH];
+    command.type = type;
+    command.value = value;
+    commandCount++;
+    captureScheduler.notify(commandJob);
+    return true;
+}
+
+bool TaskManager::receiveCommand(CaptureCommand* command) {
+    if (!command || commandCount == 0) return false;
+    *command = commandBuffer[commandHead];
+    commandHead = (commandHead + 1) % CAPTURE_COMMAND_QUEUE_LENGTH;
+    commandCount--;
+    return true;
+}
+
+#else
+
+void TaskManager::captureTask(void* arg) {
+    captureScheduler.begin();
+    for (;;) {
+        captureScheduler.wait(captureScheduler.runDue());
+    }
+}
+
+void TaskManager::uiTask(void* arg) {
+    uiScheduler.begin();
+    for (;;) {
+        runUI();
+    }
+}
+
+bool TaskManager::postEvent(const CaptureEvent& event) {
+    if (!eventQueue || xQueueSend(eventQueue, &event, 0) != pdTRUE) {
+        droppedEvents++;
+        return false;
+    }
+    uiScheduler.notify(eventJob);
+    return true;
+}
+
+bool TaskManager::receiveEvent(CaptureEvent* event) {
+    if (!eventQueue || !event) return false;
+    return xQueueReceive(eventQueue, event, 0) == pdTRUE;
+}
+
+bool TaskManager::sendCommand(CaptureCommandType type, uint32_t value) {
+    CaptureCommand command = {type, value};
+    if (!commandQueue || xQueueSend(commandQueue, &command, 0) != pdTRUE) {
+        droppedCommands++;
+        return false;
+    }
+    captureScheduler.notify(commandJob);
+    return true;
+}
+
+bool TaskManager::receiveCommand(CaptureCommand* command) {
+    if (!commandQueue || !command) return false;
+    return xQueueReceive(commandQueue, command, 0) == pdTRUE;
+}
+
+#endif
@@ -1,10 +1,10 @@
 #include "iButtonModule.h"
 #include "StorageManager.h"
 
-iButtonModule iButtonModule;
+class iButtonModule iButtonModule;
 
 iButtonModule::iButtonModule() 
-    : oneWire(IBUTTON_PIN), iButtonInitialized(false), keyPresent(false),
+    : Module(MODULE_IBUTTON, "ibutton"), oneWire(IBUTTON_PIN), iButtonInitialized(false), keyPresent(false),
       lastScanTime(0), historyCount(0), historyIndex(0) {
 }
 
@@ -20,8 +20,8 @@ void iButtonModule::update() {
     
     unsigned long currentTime = millis();
     
-    // Check for keys every 500ms
-    if (currentTime - lastScanTime > 500) {
+    // Check for keys every IBUTTON_POLL_INTERVAL_MS
+    if (currentTime - lastScanTime >= IBUTTON_POLL_INTERVAL_MS) {
         keyPresent = oneWire.search(currentKey.address);
         lastScanTime = currentTime;
     }
@@ -71,8 +71,7 @@ String iButtonModule::getFamilyString(iButtonFamily family) {
         case IBUTTON_DS1991: return "DS1991 (MultiKey)";
         case IBUTTON_DS1994: return "DS1994 (4K + Clock)";
         case IBUTTON_DS1992: return "DS1992 (1K NVRAM)";
-        case IBUTTON_DS1993: return "DS1993 (4K NVRAM)";
-        case IBUTTON_DS1996: return "DS1996 (64K NVRAM)";
+        case IBUTTON_DS1993: return "DS1993/DS1996 (NVRAM)"; // DS1996 shares family 0x0C
         case IBUTTON_DS1982: return "DS1982 (1K EPROM)";
         case IBUTTON_DS1985: return "DS1985 (16K NVRAM)";
         case IBUTTON_DS1986: return "DS1986 (64K NVRAM)";
@@ -208,8 +207,7 @@ iButtonFamily iButtonModule::identifyFamily(byte familyCode) {
         case 0x02: return IBUTTON_DS1991;
         case 0x04: return IBUTTON_DS1994;
         case 0x08: return IBUTTON_DS1992;
-        case 0x0C: return IBUTTON_DS1993;
-        case 0x0C: return IBUTTON_DS1996; // Same family code as DS1993
+        case 0x0C: return IBUTTON_DS1993; // Also DS1996, same family code
         case 0x09: return IBUTTON_DS1982;
         case 0x0B: return IBUTTON_DS1985;
         case 0x0F: return IBUTTON_DS1986;
@@ -231,7 +229,6 @@ bool iButtonModule::readKeyData(byte* address, iButtonKey* key) {
         case IBUTTON_DS1992:
         case IBUTTON_DS1993:
         case IBUTTON_DS1994:
-        case IBUTTON_DS1996:
             // NVRAM devices - read memory
             // This is a simplified implementation
             oneWire.reset();
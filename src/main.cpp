@@ -6,39 +6,84 @@
 #include "SettingsManager.h"
 #include "NFCModule.h"
 #include "IRModule.h"
+#include "IRFingerprint.h"
 #include "iButtonModule.h"
 #include "RFModule.h"
 #include "GPIOModule.h"
+#include "TaskManager.h"
+#include "ModuleRegistry.h"
+#include "Profiler.h"
+#include "MemoryMonitor.h"
+#include "PowerManager.h"
 
 // Buzzer pin
 #define BUZZER_PIN 3
 
-// Global instances
-DisplayManager displayManager;
-MenuManager menuManager;
-Joystick joystick;
-StorageManager storageManager;
-SettingsManager settingsManager;
-NFCModule nfcModule;
-IRModule irModule;
-iButtonModule iButtonModule;
-RFModule rfModule;
-GPIOModule gpioModule;
+// Global instances are defined alongside each module (displayManager,
+// menuManager, joystick, storageManager, settingsManager and the modules)
+
+// Status bar refresh (the clock only shows minutes)
+#define STATUS_REFRESH_INTERVAL_MS 1000
+
+// Serial console
+#define CONSOLE_POLL_INTERVAL_MS 100
+#define CONSOLE_LINE_LENGTH      64
+
+// Boot: the animation runs as a UI job while the capture core mounts the
+// SD card and loads the settings; modules initialize on first menu entry
+#define BOOT_FRAME_INTERVAL_MS 80
+#define BOOT_NOTE_FRAMES       3     // ~250 ms between boot sound notes
+#define BOOT_ERROR_HOLD_MS     2000
+
+struct BootNote {
+    uint16_t frequency;
+    uint16_t duration;
+};
+
+const BootNote bootNotes[] = {{1000, 200}, {1200, 200}, {1500, 300}};
+#define BOOT_NOTE_COUNT (sizeof(bootNotes) / sizeof(bootNotes[0]))
 
 // System state
-bool systemInitialized = false;
-unsigned long lastUpdate = 0;
-const unsigned long UPDATE_INTERVAL = 50; // 20 FPS
+volatile bool systemReady = false;
+volatile bool bootLoaded = false;     // set by the capture core
+bool storageFailed = false;
+int bootFrame = 0;
+uint8_t bootNote = 0;
+int bootNextNoteFrame = 0;
+unsigned long bootHoldUntil = 0;
 
-void playBootSound() {
-    if (settingsManager.isSoundEnabled()) {
-        tone(BUZZER_PIN, 1000, 200);
-        delay(250);
-        tone(BUZZER_PIN, 1200, 200);
-        delay(250);
-        tone(BUZZER_PIN, 1500, 300);
-    }
-}
+// Boot phase timing (micros)
+unsigned long bootStartUs = 0;
+unsigned long bootDisplayUs = 0;
+unsigned long bootStorageUs = 0;
+unsigned long bootSettingsUs = 0;
+
+// Capture state (owned by the capture task)
+bool irLearning = false;
+bool rfLearning = false;
+
+// Scheduler jobs
+int commandJob = -1;
+int bootLoadJob = -1;
+int irJob = -1;
+int rfJob = -1;
+int iButtonJob = -1;
+int gpioJob = -1;
+int inputJob = -1;
+int eventJob = -1;
+int displayJob = -1;
+int bootJob = -1;
+int nfcJob = -1;
+int storageJob = -1;
+int consoleJob = -1;
+int memoryJob = -1;
+int screenJob = -1;
+int irBatchJob = -1;
+int irAnalyzerJob = -1;
+
+// Console input line
+char consoleLine[CONSOLE_LINE_LENGTH];
+uint8_t consoleLength = 0;
 
 void playBeep() {
     if (settingsManager.isSoundEnabled()) {
@@ -47,147 +92,424 @@ void playBeep() {
     }
 }
 
-bool initializeSystem() {
-    Serial.begin(115200);
-    Serial.println("FlipperS3 Starting...");
-    
-    // Initialize buzzer
-    pinMode(BUZZER_PIN, OUTPUT);
-    
-    // Initialize display first
-    if (!displayManager.init()) {
-        Serial.println("Failed to initialize display!");
-        return false;
+void showInitError() {
+    displayManager.clear();
+    displayManager.drawCenteredText("INIT ERROR", 20);
+    displayManager.drawCenteredText("Check connections", 35);
+    displayManager.display();
+    while (true) {
+        delay(1000);
     }
-    
-    // Show boot animation
-    displayManager.showBootAnimation();
-    playBootSound();
-    
-    // Initialize storage
+}
+
+// Capture core, once at boot: SD card and settings (SPI), while the UI
+// core keeps the animation going over I2C
+void runBootLoad() {
+    unsigned long start = micros();
     if (!storageManager.init()) {
         Serial.println("Failed to initialize storage!");
-        displayManager.drawCenteredText("SD Card Error", 32);
-        displayManager.display();
-        delay(2000);
+        storageFailed = true;
     }
+    bootStorageUs = micros() - start;
     
-    // Initialize settings
+    // Before IR capture can start; captures are matched against it
+    if (!storageFailed && !irFingerprints.load()) {
+        irModule.rebuildFingerprints();
+    }
+    
+    start = micros();
     if (!settingsManager.init()) {
         Serial.println("Failed to initialize settings, using defaults");
     }
+    moduleRegistry.setEnabled(settingsManager.getEnabledModules());
+    irModule.setCarrierSensor(settingsManager.isIRCarrierSensorFitted());
+    bootSettingsUs = micros() - start;
     
-    // Initialize joystick
-    joystick.init();
+    __atomic_store_n(&bootLoaded, true, __ATOMIC_RELEASE);
+}
+
+// Restarts the screen-off countdown; true when the screen had been off
+bool keepScreenOn() {
+    bool wasOff = powerManager.onActivity();
+    if (wasOff) {
+        uiScheduler.notify(displayJob);
+    }
+    if (powerManager.getScreenTimeoutMs()) {
+        uiScheduler.scheduleIn(screenJob, powerManager.getScreenTimeoutMs() * 1000UL);
+    }
+    return wasOff;
+}
+
+void finishBoot() {
+    menuManager.init();
+    displayManager.clear();
+    menuManager.draw();
+    displayManager.display();
     
-    // Initialize modules based on settings
-    if (settingsManager.isModuleEnabled("nfc")) {
-        if (!nfcModule.init()) {
-            Serial.println("Failed to initialize NFC module");
-        }
+    systemReady = true;
+    uiScheduler.cancel(bootJob);
+    
+    powerManager.configure(settingsManager.isAutoSleepEnabled(), settingsManager.getSleepTimeout());
+    keepScreenOn();
+    
+    Serial.printf("Boot: display %lu ms, storage %lu ms, settings %lu ms (capture core), menu at %lu ms\n",
+                  bootDisplayUs / 1000, bootStorageUs / 1000, bootSettingsUs / 1000,
+                  (micros() - bootStartUs) / 1000);
+    Serial.println("System initialized successfully!");
+}
+
+// UI core, every BOOT_FRAME_INTERVAL_MS until the menu is up
+void runBoot() {
+    bool loaded = __atomic_load_n(&bootLoaded, __ATOMIC_ACQUIRE);
+    
+    if (displayManager.drawBootFrame(bootFrame)) {
+        bootFrame++;
     }
     
-    if (settingsManager.isModuleEnabled("ir")) {
-        if (!irModule.init()) {
-            Serial.println("Failed to initialize IR module");
-        }
+    // The boot sound needs the settings, so it starts once they are loaded
+    bool soundDone = !loaded || !settingsManager.isSoundEnabled() || bootNote >= BOOT_NOTE_COUNT;
+    if (loaded && !soundDone && bootFrame >= bootNextNoteFrame) {
+        tone(BUZZER_PIN, bootNotes[bootNote].frequency, bootNotes[bootNote].duration);
+        bootNote++;
+        bootNextNoteFrame = bootFrame + BOOT_NOTE_FRAMES;
+        soundDone = bootNote >= BOOT_NOTE_COUNT;
     }
     
-    if (settingsManager.isModuleEnabled("ibutton")) {
-        if (!iButtonModule.init()) {
-            Serial.println("Failed to initialize iButton module");
+    if (!loaded || bootFrame < BOOT_ANIMATION_FRAMES || !soundDone) return;
+    
+    if (storageFailed) {
+        if (bootHoldUntil == 0) {
+            displayManager.drawCenteredText("SD Card Error", 32);
+            displayManager.display();
+            bootHoldUntil = millis() + BOOT_ERROR_HOLD_MS;
+            return;
         }
+        if ((long)(millis() - bootHoldUntil) < 0) return;
     }
     
-    if (settingsManager.isModuleEnabled("rf")) {
-        if (!rfModule.init()) {
-            Serial.println("Failed to initialize RF module");
+    finishBoot();
+}
+
+// Capture core jobs: signal capture and decode only (see TaskManager.h)
+void runCommands() {
+    CaptureCommand command;
+    while (taskManager.receiveCommand(&command)) {
+        switch (command.type) {
+            case CAPTURE_CMD_IR_LEARN_START:
+                irLearning = true;
+                powerManager.setWakePinEnabled(IR_RECEIVER_PIN, true);
+                captureScheduler.notify(irJob);
+                break;
+            case CAPTURE_CMD_IR_LEARN_STOP:
+                irLearning = false;
+                powerManager.setWakePinEnabled(IR_RECEIVER_PIN, false);
+                irModule.stopReceiving();
+                break;
+            case CAPTURE_CMD_RF_LEARN_START:
+                rfLearning = true;
+                powerManager.setWakePinEnabled(RF_RECEIVER_PIN, true);
+                captureScheduler.notify(rfJob);
+                break;
+            case CAPTURE_CMD_RF_LEARN_STOP:
+                rfLearning = false;
+                powerManager.setWakePinEnabled(RF_RECEIVER_PIN, false);
+                rfModule.stopReceiving();
+                break;
+            case CAPTURE_CMD_IR_GLITCH_FILTER:
+                irModule.setGlitchFilter(command.value);
+                Serial.printf("IR glitch filter: %u us\n", irModule.getGlitchFilter());
+                break;
+            case CAPTURE_CMD_IR_ADAPTIVE:
+                irModule.setAdaptiveTiming(command.value != 0);
+                break;
+            case CAPTURE_CMD_IR_DUMP_HISTORY:
+                irModule.dumpHistory(Serial);
+                break;
         }
     }
+}
+
+void runIR() {
+    if (!moduleRegistry.isActive(MODULE_IR)) return;
+    
+    uint32_t frames = irModule.getFrameCount();
+    moduleRegistry.update(MODULE_IR);
+    if (irModule.getFrameCount() != frames) {
+        taskManager.postEvent({CAPTURE_EVENT_IR_SIGNAL, millis()});
+    }
     
-    if (settingsManager.isModuleEnabled("gpio")) {
-        if (!gpioModule.init()) {
-            Serial.println("Failed to initialize GPIO module");
-        }
+    // Keep the receiver armed while the learn screen is up
+    if (irLearning && !irModule.isReceiving()) {
+        irModule.receiveSignal();
+    }
+    if (irModule.isReceiving()) {
+        captureScheduler.scheduleAt(irJob, irModule.getNextDeadline());
     }
+}
+
+void runRF() {
+    if (!moduleRegistry.isActive(MODULE_RF)) return;
     
-    // Initialize menu manager
-    menuManager.init();
+    bool hadSignal = rfModule.hasReceivedSignal();
+    moduleRegistry.update(MODULE_RF);
+    if (!hadSignal && rfModule.hasReceivedSignal()) {
+        taskManager.postEvent({CAPTURE_EVENT_RF_SIGNAL, millis()});
+    }
     
-    Serial.println("System initialized successfully!");
-    return true;
+    // Keep the receiver armed while the scan screen is up
+    if (rfLearning && !rfModule.isReceiving()) {
+        rfModule.receiveSignal();
+    }
+    if (rfModule.isReceiving() || rfModule.isScanning()) {
+        captureScheduler.scheduleAt(rfJob, rfModule.getNextDeadline());
+    }
 }
 
-void setup() {
-    systemInitialized = initializeSystem();
+void runIButton() {
+    bool keyWasPresent = iButtonModule.isKeyPresent();
+    moduleRegistry.update(MODULE_IBUTTON);
+    if (!keyWasPresent && iButtonModule.isKeyPresent()) {
+        taskManager.postEvent({CAPTURE_EVENT_IBUTTON_KEY, millis()});
+    }
+}
+
+void runGPIO() {
+    moduleRegistry.update(MODULE_GPIO);
+}
+
+// UI core jobs: input, menu, NFC (shares SPI with the SD card), storage, display
+void runInput() {
+    if (!systemReady) return;
     
-    if (!systemInitialized) {
-        Serial.println("System initialization failed!");
-        // Show error screen
-        displayManager.clear();
-        displayManager.drawCenteredText("INIT ERROR", 20);
-        displayManager.drawCenteredText("Check connections", 35);
-        displayManager.display();
-        while (true) {
-            delay(1000);
-        }
+    joystick.update();
+    JoystickDirection input = joystick.read();
+    
+    // The press that turns the screen back on does nothing else
+    if (input != JOYSTICK_NONE && !keepScreenOn()) {
+        playBeep();
+        menuManager.handleInput(input);
+        uiScheduler.notify(displayJob);
     }
     
-    // Clear display and show main menu
-    displayManager.clear();
-    menuManager.draw();
+    // Edges wake this job; while a button is held, come back after the
+    // debounce window so a press inside it is not lost
+    if (joystick.isPressed(JOYSTICK_UP) || joystick.isPressed(JOYSTICK_DOWN) ||
+        joystick.isPressed(JOYSTICK_SELECT)) {
+        uiScheduler.scheduleIn(inputJob, JOYSTICK_DEBOUNCE_MS * 1000UL);
+    }
+}
+
+void runEvents() {
+    if (!systemReady) return;
+    
+    CaptureEvent event;
+    while (taskManager.receiveEvent(&event)) {
+        playBeep();
+        keepScreenOn();
+    }
+}
+
+void runDisplay() {
+    if (!systemReady) return;
+    
+    menuManager.update();
+    displayManager.drawStatusBar();
     displayManager.display();
 }
 
-void loop() {
-    unsigned long currentTime = millis();
-    
-    // Update at fixed interval
-    if (currentTime - lastUpdate >= UPDATE_INTERVAL) {
-        lastUpdate = currentTime;
-        
-        // Update joystick
-        joystick.update();
-        JoystickDirection input = joystick.read();
-        
-        // Handle input
-        if (input != JOYSTICK_NONE) {
-            playBeep();
-            menuManager.handleInput(input);
-        }
-        
-        // Update menu manager
-        menuManager.update();
-        
-        // Update modules
-        if (settingsManager.isModuleEnabled("nfc")) {
-            nfcModule.update();
-        }
-        
-        if (settingsManager.isModuleEnabled("ir")) {
-            irModule.update();
+// The next frame of an IR batch: notified by the previous frame's TX-end
+// interrupt, then due once the gap after it has passed
+void runIRBatch() {
+    int progress = irModule.getProgress(IR_UNIVERSAL);
+    irModule.updateBatch();
+    if (irModule.isBatchRunning()) {
+        uiScheduler.scheduleAt(irBatchJob, irModule.getBatchDeadline());
+    }
+    
+    if (irModule.getProgress(IR_UNIVERSAL) != progress) {
+        menuManager.refresh();
+        uiScheduler.notify(displayJob);
+    }
+}
+
+// Analyzer screen: redrawn when the capture core has added to the
+// analysis, at most every IR_ANALYZER_REFRESH_MS; stops with the screen
+void runIRAnalyzer() {
+    static uint32_t drawnSequence = 0;
+    if (!irModule.isAnalyzing()) {
+        uiScheduler.cancel(irAnalyzerJob);
+        return;
+    }
+    
+    uint32_t sequence = irModule.getAnalysisSequence();
+    if (sequence != drawnSequence) {
+        drawnSequence = sequence;
+        menuManager.refresh();
+        uiScheduler.notify(displayJob);
+    }
+}
+
+void runNFC() {
+    moduleRegistry.update(MODULE_NFC);
+}
+
+void runStorage() {
+    if (!systemReady) return;
+    
+    storageManager.update();
+}
+
+void runMemory() {
+    memoryMonitor.update();
+}
+
+// One-shot, pushed back by every input
+void runScreen() {
+    powerManager.screenOff();
+    uiScheduler.cancel(displayJob);
+}
+
+void runConsoleCommand(const char* line) {
+    if (strcmp(line, "prof") == 0) {
+        profiler.dump(Serial);
+    } else if (strcmp(line, "prof reset") == 0) {
+        profiler.reset();
+        Serial.println("Profiler reset");
+    } else if (strncmp(line, "prof ", 5) == 0) {
+        for (int i = 0; i < PROBE_COUNT; i++) {
+            if (strcmp(line + 5, profiler.getProbeName((ProfileProbe)i)) == 0) {
+                profiler.dumpHistogram(Serial, (ProfileProbe)i);
+                return;
+            }
         }
-        
-        if (settingsManager.isModuleEnabled("ibutton")) {
-            iButtonModule.update();
+        Serial.println("Unknown probe");
+    } else if (strcmp(line, "modules") == 0) {
+        moduleRegistry.printStats();
+    } else if (strcmp(line, "mem") == 0) {
+        memoryMonitor.dump(Serial);
+    } else if (strcmp(line, "power") == 0) {
+        powerManager.dump(Serial);
+    } else if (strcmp(line, "ir") == 0) {
+        // The capture core folds repeats into the history entries
+        taskManager.sendCommand(CAPTURE_CMD_IR_DUMP_HISTORY);
+    } else if (strncmp(line, "ir send ", 8) == 0) {
+        if (!moduleRegistry.activate(MODULE_IR) || !irModule.startBatch(line + 8)) {
+            Serial.println("No such IR remote");
         }
-        
-        if (settingsManager.isModuleEnabled("rf")) {
-            rfModule.update();
+    } else if (strcmp(line, "ir stop") == 0) {
+        irModule.cancelBatch();
+    } else if (strncmp(line, "ir filter ", 10) == 0) {
+        char* end;
+        unsigned long minPulseUs = strtoul(line + 10, &end, 10);
+        if (!isdigit((unsigned char)line[10]) || *end != '\0' || minPulseUs > IR_GLITCH_MAX_PULSE_US) {
+            Serial.printf("IR filter takes 0..%u us\n", IR_GLITCH_MAX_PULSE_US);
+            return;
         }
-        
-        if (settingsManager.isModuleEnabled("gpio")) {
-            gpioModule.update();
+        // The filter and decoder belong to the capture core, which echoes the value
+        taskManager.sendCommand(CAPTURE_CMD_IR_GLITCH_FILTER, minPulseUs);
+    } else if (strcmp(line, "ir adaptive on") == 0 || strcmp(line, "ir adaptive off") == 0) {
+        taskManager.sendCommand(CAPTURE_CMD_IR_ADAPTIVE, strcmp(line + 12, "on") == 0);
+    } else if (line[0] != '\0') {
+        Serial.println("Commands: prof, prof reset, prof <probe>, modules, mem, power, ir, ir send <remote>, ir stop, "
+                       "ir filter <us>, ir adaptive on|off");
+    }
+}
+
+void runConsole() {
+    // Commands can reach the SD card, which the boot load owns until then
+    if (!systemReady) return;
+    
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c == '\r') continue;
+        if (c == '\n') {
+            consoleLine[consoleLength] = '\0';
+            runConsoleCommand(consoleLine);
+            consoleLength = 0;
+        } else if (consoleLength < CONSOLE_LINE_LENGTH - 1) {
+            consoleLine[consoleLength++] = c;
         }
-        
-        // Update storage manager
-        storageManager.update();
-        
-        // Update display if needed
-        displayManager.drawStatusBar();
-        displayManager.display();
     }
+}
+
+// Starts a module's job stopped; the registry notifies it on activation
+int addModuleJob(Scheduler& scheduler, ModuleId id, const char* name, SchedulerJob job,
+                 unsigned long periodUs = 0) {
+    int jobId = scheduler.addJob(name, job, periodUs);
+    scheduler.cancel(jobId);
+    moduleRegistry.setJob(id, &scheduler, jobId);
+    return jobId;
+}
+
+void registerJobs() {
+    commandJob = captureScheduler.addJob("commands", runCommands);
+    bootLoadJob = captureScheduler.addJob("boot", runBootLoad);
+    irJob = addModuleJob(captureScheduler, MODULE_IR, "ir", runIR);
+    irModule.setEdgeNotify(&captureScheduler, irJob);
+    rfJob = addModuleJob(captureScheduler, MODULE_RF, "rf", runRF);
+    iButtonJob = addModuleJob(captureScheduler, MODULE_IBUTTON, "ibutton", runIButton,
+                              IBUTTON_POLL_INTERVAL_MS * 1000UL);
+    gpioJob = addModuleJob(captureScheduler, MODULE_GPIO, "gpio", runGPIO,
+                           GPIO_POLL_INTERVAL_MS * 1000UL);
+    
+    inputJob = uiScheduler.addJob("input", runInput);
+    eventJob = uiScheduler.addJob("events", runEvents);
+    displayJob = uiScheduler.addJob("display", runDisplay, STATUS_REFRESH_INTERVAL_MS * 1000UL);
+    bootJob = uiScheduler.addJob("boot", runBoot, BOOT_FRAME_INTERVAL_MS * 1000UL);
+    nfcJob = addModuleJob(uiScheduler, MODULE_NFC, "nfc", runNFC, NFC_POLL_INTERVAL_MS * 1000UL);
+    storageJob = uiScheduler.addJob("storage", runStorage, STORAGE_CHECK_INTERVAL_MS * 1000UL);
+    consoleJob = uiScheduler.addJob("console", runConsole, CONSOLE_POLL_INTERVAL_MS * 1000UL);
+    memoryJob = uiScheduler.addJob("memory", runMemory, MEMORY_SAMPLE_INTERVAL_MS * 1000UL);
+    screenJob = uiScheduler.addJob("screen", runScreen);
+    irBatchJob = uiScheduler.addJob("irbatch", runIRBatch);
+    irModule.setBatchNotify(&uiScheduler, irBatchJob);
+    irAnalyzerJob = uiScheduler.addJob("iranalyzer", runIRAnalyzer, IR_ANALYZER_REFRESH_MS * 1000UL);
+    uiScheduler.cancel(irAnalyzerJob);
+    irModule.setAnalyzerNotify(&uiScheduler, irAnalyzerJob);
+    
+    uiScheduler.wakeOnPin(JOYSTICK_UP_PIN, inputJob, CHANGE);
+    uiScheduler.wakeOnPin(JOYSTICK_DOWN_PIN, inputJob, CHANGE);
+    uiScheduler.wakeOnPin(JOYSTICK_SELECT_PIN, inputJob, CHANGE);
+    
+    // Light sleep ends on a press, or on the first edge of a frame while a
+    // receiver is listening (the IR demodulator idles high, the RF one low)
+    powerManager.addWakePin(JOYSTICK_UP_PIN, LOW, &uiScheduler, inputJob);
+    powerManager.addWakePin(JOYSTICK_DOWN_PIN, LOW, &uiScheduler, inputJob);
+    powerManager.addWakePin(JOYSTICK_SELECT_PIN, LOW, &uiScheduler, inputJob);
+    powerManager.addWakePin(IR_RECEIVER_PIN, LOW);
+    powerManager.addWakePin(RF_RECEIVER_PIN, HIGH);
+    powerManager.setWakePinEnabled(IR_RECEIVER_PIN, false);
+    powerManager.setWakePinEnabled(RF_RECEIVER_PIN, false);
+}
+
+void setup() {
+    bootStartUs = micros();
+    Serial.begin(115200);
+    Serial.println("FlipperS3 Starting...");
+    
+    // Initialize buzzer
+    pinMode(BUZZER_PIN, OUTPUT);
+    
+    // Initialize display first
+    if (!displayManager.init()) {
+        Serial.println("Failed to initialize display!");
+        Serial.println("System initialization failed!");
+        showInitError();
+    }
+    bootDisplayUs = micros() - bootStartUs;
+    
+    // Initialize joystick
+    joystick.init();
     
-    // Small delay to prevent watchdog issues
-    delay(1);
+    // Animation on the UI core, SD and settings on the capture core
+    registerJobs();
+    if (!taskManager.begin(commandJob, eventJob)) {
+        Serial.println("Failed to start tasks!");
+        showInitError();
+    }
+    captureScheduler.notify(bootLoadJob);
+}
+
+void loop() {
+    taskManager.loop();
 }